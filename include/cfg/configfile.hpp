@@ -28,13 +28,14 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-11-23
- * \updates       2024-09-27
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This is actually an elegant little parser, and works well as long as one
  *  respects its limitations.
  */
 
+#include <cstdint>                      /* std::uint64_t                    */
 #include <fstream>                      /* std::streampos                   */
 #include <string>                       /* std::string, the ubiquitous one  */
 
@@ -170,6 +171,13 @@ private:
 
     std::string m_file_version;
 
+    /**
+     *  The hash of the contents of the file when it was last parsed or
+     *  written, or 0 if it has not been. See file_changed().
+     */
+
+    std::uint64_t m_file_fingerprint;
+
 protected:
 
     /**
@@ -268,6 +276,13 @@ public:
         return file_version().empty() ? 0 : util::string_to_int(file_version()) ;
     }
 
+    std::uint64_t file_fingerprint () const
+    {
+        return m_file_fingerprint;
+    }
+
+    bool file_changed () const;
+
     bool bad_position (int p) const
     {
         return p < 0;
@@ -311,6 +326,7 @@ public:
 protected:
 
     bool set_up_ifstream (std::ifstream & instream);
+    bool update_file_fingerprint ();
     bool section_name_valid (const std::string & s);
     std::string make_section_name (const std::string & s);
     std::string strip_section_name (const std::string & s);
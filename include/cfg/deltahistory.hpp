@@ -0,0 +1,300 @@
+#if ! defined CFG66_CFG_DELTAHISTORY_HPP
+#define CFG66_CFG_DELTAHISTORY_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          deltahistory.hpp
+ *
+ *  This module defines an undo/redo mechanism for cfg::options that stores
+ *  only the changes between steps.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#include <deque>                        /* std::deque<> template class      */
+
+#include "cpp_types.hpp"                /* string, vector, msglevel         */
+#include "cfg/options.hpp"              /* cfg::options (with source names) */
+
+/*
+ * Do not attempt to Doxygenate the documentation here; it breaks Doxygen.
+ */
+
+namespace cfg
+{
+
+/**
+ *  A memento of options that holds only the options that changed since
+ *  the previous step. Every so often, it also holds a full copy of the
+ *  options, a checkpoint, so that any step can be rebuilt quickly.
+ */
+
+class options_delta
+{
+
+public:
+
+    /**
+     *  One changed option. Besides the value, the modified flag is
+     *  recorded, so that undo restores the "dirtiness" of the option.
+     */
+
+    class change
+    {
+    public:
+
+        std::string change_name;
+        std::string change_old_value;
+        std::string change_new_value;
+        bool change_old_modified;
+        bool change_new_modified;
+    };
+
+    using changes = std::vector<change>;
+
+private:
+
+    /**
+     *  The options that changed since the previous step. Empty for the
+     *  first step.
+     */
+
+    changes m_changes;
+
+    /**
+     *  Indicates that m_changes is valid. It is false for the first step,
+     *  and for a step where options were added or removed. Such steps
+     *  cannot be undone by changes alone.
+     */
+
+    bool m_has_changes;
+
+    /**
+     *  Indicates that m_checkpoint holds the full options of this step.
+     */
+
+    bool m_is_checkpoint;
+
+    /**
+     *  The full options, used only if m_is_checkpoint is true.
+     */
+
+    options m_checkpoint;
+
+public:
+
+    options_delta ();
+    explicit options_delta (const options & full);
+    options_delta (const options & before, const options & after);
+    options_delta (const options_delta &) = default;
+    options_delta (options_delta &&) = default;
+    options_delta & operator = (const options_delta &) = default;
+    options_delta & operator = (options_delta &&) = default;
+    ~options_delta () = default;
+
+    const changes & change_list () const
+    {
+        return m_changes;
+    }
+
+    size_t count () const
+    {
+        return m_changes.size();
+    }
+
+    bool has_changes () const
+    {
+        return m_has_changes;
+    }
+
+    bool checkpoint () const
+    {
+        return m_is_checkpoint;
+    }
+
+    const options & get_checkpoint () const
+    {
+        return m_checkpoint;
+    }
+
+    void make_checkpoint (const options & full);
+    void drop_checkpoint ();
+    bool apply (options & target) const;
+    bool revert (options & target) const;
+
+    static bool same_layout (const options & a, const options & b);
+
+};          // class options_delta
+
+/**
+ *  An undo/redo history of options with the same interface as
+ *  history<options>, but storing an options_delta per step. The first step
+ *  is always a checkpoint, and so is every "checkpoint interval" step after
+ *  it. Memory thus grows with the size of the edits rather than with the
+ *  number of options times the undo depth.
+ */
+
+class delta_history
+{
+
+private:
+
+    /**
+     *  The steps. Step 0 is always a checkpoint.
+     */
+
+    std::deque<options_delta> m_delta_list;
+
+    /**
+     *  The maximum number of steps, as in history<>.
+     */
+
+    const size_t m_max_size;
+
+    /**
+     *  A full checkpoint is stored every this many steps. A value of 0
+     *  means to store no checkpoints other than the first step.
+     */
+
+    const size_t m_checkpoint_interval;
+
+    /**
+     *  Counts the steps added since the last checkpoint.
+     */
+
+    size_t m_since_checkpoint;
+
+    /**
+     *  The index of the current step.
+     */
+
+    size_t m_present;
+
+    /**
+     *  The full options of the current step, kept up to date by add(),
+     *  undo(), and redo().
+     */
+
+    options m_current;
+
+    /**
+     *  Holds the options rebuilt by get() for steps other than the current
+     *  one.
+     */
+
+    mutable options m_rebuilt;
+
+public:
+
+    delta_history ();
+    explicit delta_history (size_t maximum, size_t interval = 16);
+    delta_history
+    (
+        size_t maximum, const options & firstone, size_t interval = 16
+    );
+    delta_history (const delta_history &) = default;
+    delta_history (delta_history &&) = delete;
+    delta_history & operator = (const delta_history &) = delete;
+    delta_history & operator = (delta_history &&) = delete;
+    ~delta_history () = default;
+
+    bool active () const
+    {
+        return m_delta_list.size() > 0;
+    }
+
+    size_t max_size () const
+    {
+        return m_max_size;
+    }
+
+    size_t checkpoint_interval () const
+    {
+        return m_checkpoint_interval;
+    }
+
+    size_t size () const
+    {
+        return m_delta_list.size();
+    }
+
+    int present () const
+    {
+        return int(m_present);
+    }
+
+    bool undoable () const
+    {
+        return active() && m_present > 0;
+    }
+
+    bool redoable () const
+    {
+        return active() && m_present < (m_delta_list.size() - 1);
+    }
+
+    const options & get_present () const
+    {
+        return m_current;
+    }
+
+    const options_delta & delta (size_t index) const
+    {
+        return m_delta_list[index];
+    }
+
+    size_t change_count () const;
+    size_t checkpoint_count () const;
+    const options & get (size_t index) const;
+    bool add (const options & opts);
+    bool reset ();
+    const options & undo ();
+    const options & redo ();
+
+private:
+
+    bool pop ();
+    void recount_since_checkpoint ();
+    void rebuild (size_t index, options & target) const;
+
+};          // class delta_history
+
+/**
+ *  Free functions for testing.
+ */
+
+extern std::string options_history (const delta_history & h);
+
+}           // namespace cfg
+
+#endif      // CFG66_CFG_DELTAHISTORY_HPP
+
+/*
+ * deltahistory.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -27,13 +27,15 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2023-01-06
- * \updates       2024-06-18
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  Documented in the cpp file.
  */
 
+#include <chrono>                       /* std::chrono::steady_clock        */
 #include <deque>                        /* std::deque<> template class      */
+#include <utility>                      /* std::move(), std::forward()      */
 
 #include "cpp_types.hpp"                /* string, vector, opt, msglevel... */
 #include "cfg/memento.hpp"              /* cfg::memento template class      */
@@ -47,6 +49,175 @@ namespace cfg
 
 class options;
 
+/**
+ *  Storage policies for history<>. A policy holds the mementos in order,
+ *  oldest first, and provides:
+ *
+ *      -   A constructor taking the maximum number of items.
+ *      -   size(), clear(), operator [] (const and non-const).
+ *      -   push_back() for copied and moved items.
+ *      -   pop_front() and pop_back().
+ *
+ *  history_deque is the original std::deque<> storage. It allocates as
+ *  items are added.
+ */
+
+template <typename ITEM>
+class history_deque
+{
+
+private:
+
+    std::deque<ITEM> m_items;
+
+public:
+
+    explicit history_deque (size_t /*maximum*/) : m_items ()
+    {
+        // no other code
+    }
+
+    size_t size () const
+    {
+        return m_items.size();
+    }
+
+    void clear ()
+    {
+        m_items.clear();
+    }
+
+    ITEM & operator [] (size_t index)
+    {
+        return m_items[index];
+    }
+
+    const ITEM & operator [] (size_t index) const
+    {
+        return m_items[index];
+    }
+
+    void push_back (const ITEM & item)
+    {
+        m_items.push_back(item);
+    }
+
+    void push_back (ITEM && item)
+    {
+        m_items.push_back(std::move(item));
+    }
+
+    void pop_front ()
+    {
+        m_items.pop_front();
+    }
+
+    void pop_back ()
+    {
+        m_items.pop_back();
+    }
+
+};          // class history_deque
+
+/**
+ *  A fixed-capacity ring buffer. All slots are allocated by the
+ *  constructor. Adding an item moves (or copies) it into an existing slot,
+ *  and popping only moves the head or tail index, so a full history does
+ *  not allocate or free memory on each step. Popped states stay in their
+ *  slots until overwritten.
+ */
+
+template <typename ITEM>
+class history_ring
+{
+
+private:
+
+    std::vector<ITEM> m_slots;
+    size_t m_head;
+    size_t m_count;
+
+public:
+
+    explicit history_ring (size_t maximum) :
+        m_slots (maximum > 0 ? maximum : 1),
+        m_head  (0),
+        m_count (0)
+    {
+        // no other code
+    }
+
+    size_t capacity () const
+    {
+        return m_slots.size();
+    }
+
+    size_t size () const
+    {
+        return m_count;
+    }
+
+    void clear ()
+    {
+        m_head = m_count = 0;
+    }
+
+    ITEM & operator [] (size_t index)
+    {
+        return m_slots[slot(index)];
+    }
+
+    const ITEM & operator [] (size_t index) const
+    {
+        return m_slots[slot(index)];
+    }
+
+    /*
+     *  When the ring is full, the oldest item is overwritten.
+     */
+
+    void push_back (const ITEM & item)
+    {
+        m_slots[next_slot()] = item;
+    }
+
+    void push_back (ITEM && item)
+    {
+        m_slots[next_slot()] = std::move(item);
+    }
+
+    void pop_front ()
+    {
+        if (m_count > 0)
+        {
+            m_head = (m_head + 1) % capacity();
+            --m_count;
+        }
+    }
+
+    void pop_back ()
+    {
+        if (m_count > 0)
+            --m_count;
+    }
+
+private:
+
+    size_t slot (size_t index) const
+    {
+        return (m_head + index) % capacity();
+    }
+
+    size_t next_slot ()
+    {
+        if (m_count == capacity())
+            pop_front();
+
+        return slot(m_count++);
+    }
+
+};          // class history_ring
+
 /**
  *
  *  TYPE must have:
@@ -54,9 +225,19 @@ class options;
  *      -   Default constructor
  *      -   Copy constructor
  *      -   Principal assignment operator
+ *
+ *  If TYPE also has move construction and assignment, the add() and
+ *  emplace() overloads taking an rvalue avoid deep copies, and undo() and
+ *  redo() never copy a state.
+ *
+ *  STORAGE is history_deque (the default) or history_ring.
  */
 
-template <typename TYPE>
+template
+<
+    typename TYPE,
+    template <typename> class STORAGE = history_deque
+>
 class history
 {
     /*
@@ -69,11 +250,11 @@ private:
      *  Provides a copy of a state.  We obviously can't use references.
      */
 
-    std::deque<memento<TYPE>> m_history_list;
+    STORAGE<memento<TYPE>> m_history_list;
 
     /**
      *  To avoid unintentional bloat, we limit the number of elements in the
-     *  deque.  When a push-back would increase the size beyond this value,
+     *  storage.  When a push-back would increase the size beyond this value,
      *  then the earliest item is pop-fronted.
      */
 
@@ -87,6 +268,33 @@ private:
 
     size_t m_present;
 
+    /**
+     *  If not zero, consecutive adds with the same key that come within
+     *  this time of each other are merged into one memento. See add().
+     */
+
+    std::chrono::milliseconds m_coalesce_window;
+
+    /**
+     *  The key and time of the last add, for coalescing.
+     */
+
+    std::string m_last_key;
+    std::chrono::steady_clock::time_point m_last_time;
+
+    /**
+     *  The nesting depth of begin_group() calls. While a group is open,
+     *  all adds after the first are merged into one memento.
+     */
+
+    int m_group_depth;
+
+    /**
+     *  Indicates that the open group has pushed its memento.
+     */
+
+    bool m_group_started;
+
 public:
 
     history ();
@@ -101,7 +309,7 @@ public:
     bool active () const
     {
         return m_history_list.size() > 0;
-  }
+    }
 
     size_t max_size () const
     {
@@ -131,10 +339,28 @@ public:
         return active() && m_present < (m_history_list.size() - 1);
     }
 
-    bool add (const TYPE & s)
+    bool add (const TYPE & s, const std::string & key = "")
     {
         memento<TYPE> m{s};
-        return push(m);
+        return coalesce(std::move(m), key);
+    }
+
+    bool add (TYPE && s, const std::string & key = "")
+    {
+        memento<TYPE> m{std::move(s)};
+        return coalesce(std::move(m), key);
+    }
+
+    /**
+     *  Builds the new state from the arguments and moves it into the
+     *  history.
+     */
+
+    template <typename... ARGS>
+    bool emplace (ARGS &&... args)
+    {
+        memento<TYPE> m{TYPE(std::forward<ARGS>(args)...)};
+        return coalesce(std::move(m), std::string());
     }
 
     bool reset ();
@@ -142,16 +368,55 @@ public:
     const TYPE & undo ();
     const TYPE & redo ();
 
+    std::chrono::milliseconds coalesce_window () const
+    {
+        return m_coalesce_window;
+    }
+
+    void coalesce_window (std::chrono::milliseconds w)
+    {
+        m_coalesce_window = w;
+    }
+
+    bool grouping () const
+    {
+        return m_group_depth > 0;
+    }
+
+    void begin_group ()
+    {
+        if (m_group_depth++ == 0)
+            m_group_started = false;
+    }
+
+    void end_group ()
+    {
+        if (m_group_depth > 0)
+            --m_group_depth;
+    }
+
 protected:
 
-    bool impl_undo (memento<TYPE> & m);
-    bool impl_redo (memento<TYPE> & m);
+    bool impl_undo ();
+    bool impl_redo ();
     bool push (const memento<TYPE> & m);
+    bool push (memento<TYPE> && m);
     bool pop ();
 
     bool remove ()
     {
-        return pop;
+        return pop();
+    }
+
+private:
+
+    bool make_room ();
+    bool coalescible (const std::string & key) const;
+    bool coalesce (memento<TYPE> && m, const std::string & key);
+
+    void forget_key ()
+    {
+        m_last_key.clear();
     }
 
 };          // class history
@@ -160,11 +425,16 @@ protected:
  *  Default constructor.
  */
 
-template<typename TYPE>
-history<TYPE>::history () :
-    m_history_list  (),
-    m_max_size      (32),
-    m_present       (0)
+template <typename TYPE, template <typename> class STORAGE>
+history<TYPE, STORAGE>::history () :
+    m_history_list      (32),
+    m_max_size          (32),
+    m_present           (0),
+    m_coalesce_window   (0),
+    m_last_key          (),
+    m_last_time         (),
+    m_group_depth       (0),
+    m_group_started     (false)
 {
     // no other code
 }
@@ -173,41 +443,136 @@ history<TYPE>::history () :
  *  Sizing constructor.
  */
 
-template<typename TYPE>
-history<TYPE>::history (size_t maximum) :
-    m_history_list  (),
-    m_max_size      (maximum),
-    m_present       (0)
+template <typename TYPE, template <typename> class STORAGE>
+history<TYPE, STORAGE>::history (size_t maximum) :
+    m_history_list      (maximum),
+    m_max_size          (maximum),
+    m_present           (0),
+    m_coalesce_window   (0),
+    m_last_key          (),
+    m_last_time         (),
+    m_group_depth       (0),
+    m_group_started     (false)
 {
     // no other code
 }
 
-template<typename TYPE>
-history<TYPE>::history (size_t maximum, const TYPE & firstone) :
-    m_history_list  (),
-    m_max_size      (maximum),
-    m_present       (0)
+template <typename TYPE, template <typename> class STORAGE>
+history<TYPE, STORAGE>::history (size_t maximum, const TYPE & firstone) :
+    m_history_list      (maximum),
+    m_max_size          (maximum),
+    m_present           (0),
+    m_coalesce_window   (0),
+    m_last_key          (),
+    m_last_time         (),
+    m_group_depth       (0),
+    m_group_started     (false)
 {
     (void) add(firstone);
 }
 
 /**
- *  Adds a mememto to the back (end) of the history list. Returns true if
- *  no memento needed to be popped.
+ *  Prepares for adding a memento after the present one. Mementos that could
+ *  have been redone are dropped, as the new memento replaces them. Then, if
+ *  the list is full, the first memento is popped.
+ *
+ * \return
+ *      Returns true if no memento needed to be popped.
  */
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 bool
-history<TYPE>::push (const memento<TYPE> & m)
+history<TYPE, STORAGE>::make_room ()
 {
+    while (redoable())
+        m_history_list.pop_back();
+
     bool result = m_history_list.size() < m_max_size;
     if (! result)
         result = ! pop();               /* should never be false, though    */
 
-    if (active())                       /* tricky code;gnore first push     */
-        ++m_present;                    /* int would have been nice, but... */
+    return result;
+}
 
-    m_history_list.push_back(m);        /* copy m and add it to the deque   */
+/**
+ *  Indicates if a new memento should replace the present one instead of
+ *  being pushed. A memento is never merged into the first memento, nor
+ *  after an undo.
+ *
+ *      -   Inside a group, every add after the first is merged.
+ *      -   Otherwise, if there is a coalescing window, an add with the same
+ *          non-empty key as the last add, and within the window of it, is
+ *          merged. Dragging a slider thus yields one memento, not hundreds.
+ */
+
+template <typename TYPE, template <typename> class STORAGE>
+bool
+history<TYPE, STORAGE>::coalescible (const std::string & key) const
+{
+    bool result = false;
+    if (m_history_list.size() > 1 && ! redoable())
+    {
+        if (grouping())
+        {
+            result = m_group_started;
+        }
+        else if (m_coalesce_window.count() > 0 && ! key.empty())
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_last_time;
+            result = key == m_last_key && elapsed <= m_coalesce_window;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Pushes the memento, or merges it into the present memento if
+ *  coalescible() says so.
+ *
+ * \return
+ *      Returns true if no memento needed to be popped.
+ */
+
+template <typename TYPE, template <typename> class STORAGE>
+bool
+history<TYPE, STORAGE>::coalesce (memento<TYPE> && m, const std::string & key)
+{
+    bool result = true;
+    if (coalescible(key))
+        m_history_list[m_present] = std::move(m);
+    else
+        result = push(std::move(m));
+
+    if (grouping())
+        m_group_started = true;
+
+    m_last_key = key;
+    m_last_time = std::chrono::steady_clock::now();
+    return result;
+}
+
+/**
+ *  Adds a mememto to the back (end) of the history list. Returns true if
+ *  no memento needed to be popped.
+ */
+
+template <typename TYPE, template <typename> class STORAGE>
+bool
+history<TYPE, STORAGE>::push (const memento<TYPE> & m)
+{
+    bool result = make_room();
+    m_history_list.push_back(m);        /* copy m and add it to the list    */
+    m_present = m_history_list.size() - 1;
+    return result;
+}
+
+template <typename TYPE, template <typename> class STORAGE>
+bool
+history<TYPE, STORAGE>::push (memento<TYPE> && m)
+{
+    bool result = make_room();
+    m_history_list.push_back(std::move(m));
+    m_present = m_history_list.size() - 1;
     return result;
 }
 
@@ -216,27 +581,25 @@ history<TYPE>::push (const memento<TYPE> & m)
  *  pop.
  */
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 bool
-history<TYPE>::pop ()
+history<TYPE, STORAGE>::pop ()
 {
     bool result = active();
     if (result)
     {
         m_history_list.pop_front();
-        --m_present;
+        if (m_present > 0)
+            --m_present;
     }
     return result;
 }
 
 /**
  *  Moves the "present" pointer toward the first entry in the history
- *  list and, if this is possible, copies the memento and returns true.
- *  Notice that this function does *not* change the history list.
- *  This allows for a redo().
- *
- * \param [out] m
- *      Contains the previous value of the TYPE object.
+ *  list and returns true if this is possible. Notice that this function
+ *  does *not* change the history list, nor copy a memento. This allows for
+ *  a redo().
  *
  * \return
  *      Returns true if the item was undoable. No matter how many
@@ -244,53 +607,53 @@ history<TYPE>::pop ()
  *      remains, if the history list didn't "overflow".
  */
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 bool
-history<TYPE>::impl_undo (memento<TYPE> & m)
+history<TYPE, STORAGE>::impl_undo ()
 {
     bool result = undoable();
     if (result)
     {
         --m_present;
-        m = m_history_list[m_present];
+        forget_key();
     }
+
     return result;
 }
 
 /**
- *  Moves the "present" pointer toward the first entry in the history
- *  list and, if this is possible, copies the memento and returns true.
+ *  Moves the "present" pointer toward the last entry in the history
+ *  list and returns true if this is possible.
  */
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 bool
-history<TYPE>::impl_redo (memento<TYPE> & m)
+history<TYPE, STORAGE>::impl_redo ()
 {
     bool result = redoable();
     if (result)
     {
         ++m_present;
-        m = m_history_list[m_present];
+        forget_key();
     }
+
     return result;
 }
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 const TYPE &
-history<TYPE>::undo ()
+history<TYPE, STORAGE>::undo ()
 {
     static TYPE s_dummy;
-    memento<TYPE> m;                    /* this is a throw-away temporary   */
-    return impl_undo(m) ? m_history_list[m_present].get_state() : s_dummy ;
+    return impl_undo() ? m_history_list[m_present].get_state() : s_dummy ;
 }
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 const TYPE &
-history<TYPE>::redo ()
+history<TYPE, STORAGE>::redo ()
 {
     static TYPE s_dummy;
-    memento<TYPE> m;                    /* this is a throw-away temporary   */
-    return impl_redo(m) ? m_history_list[m_present].get_state() : s_dummy ;
+    return impl_redo() ? m_history_list[m_present].get_state() : s_dummy ;
 }
 
 /**
@@ -299,22 +662,23 @@ history<TYPE>::redo ()
  *  if there was anything to clear.
  */
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 bool
-history<TYPE>::reset ()
+history<TYPE, STORAGE>::reset ()
 {
     bool result = active();
     if (result)
     {
         m_history_list.clear();
         m_present = 0;
+        forget_key();
     }
     return result;
 }
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 const TYPE &
-history<TYPE>::get (size_t index) const
+history<TYPE, STORAGE>::get (size_t index) const
 {
     static TYPE s_dummy;
     if (active())
@@ -332,12 +696,12 @@ history<TYPE>::get (size_t index) const
         return s_dummy;
 }
 
-template<typename TYPE>
+template <typename TYPE, template <typename> class STORAGE>
 const TYPE &
-history<TYPE>::get_present () const
+history<TYPE, STORAGE>::get_present () const
 {
     static TYPE s_dummy;
-    return active() ? m_history_list[m_present] : s_dummy ;
+    return active() ? m_history_list[m_present].get_state() : s_dummy ;
 }
 
 /**
@@ -28,7 +28,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-06-19
- * \updates       2024-09-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  We want to provide a list of { filename, sectionname } pairs, and
@@ -175,6 +175,7 @@ public:
     std::string cli_help_text () const;
     std::string help_text () const;
     std::string debug_text () const;
+    std::uint64_t fingerprint () const;
     std::string file_specification
     (
         const std::string & basename = "",
@@ -0,0 +1,590 @@
+#if ! defined CFG66_CFG_JOURNAL_HPP
+#define CFG66_CFG_JOURNAL_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          journal.hpp
+ *
+ *  This module defines an on-disk undo journal and a history that uses it.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#include <cstdio>                       /* std::FILE                        */
+#include <deque>                        /* std::deque<> template class      */
+#include <utility>                      /* std::move()                      */
+
+#include "cpp_types.hpp"                /* string, vector, msglevel         */
+#include "cfg/memento.hpp"              /* cfg::memento template class      */
+#include "cfg/options.hpp"              /* cfg::options class               */
+
+/*
+ * Do not attempt to Doxygenate the documentation here; it breaks Doxygen.
+ */
+
+namespace cfg
+{
+
+/**
+ *  An append-only file of records. Each record is a block of bytes, with a
+ *  length and a checksum. The file is memory-mapped for reading, where the
+ *  platform supports it. On opening, a torn or corrupt record at the end of
+ *  the file, as left by a crash, is cut off.
+ */
+
+class journal
+{
+
+private:
+
+    /**
+     *  The name of the journal file.
+     */
+
+    std::string m_file_name;
+
+    /**
+     *  The open journal file, used for appending and truncating.
+     */
+
+    std::FILE * m_file;
+
+    /**
+     *  The offset of each record in the file.
+     */
+
+    std::vector<size_t> m_offsets;
+
+    /**
+     *  The length of the valid part of the file.
+     */
+
+    size_t m_file_size;
+
+    /**
+     *  If true, each append is flushed to the disk, not just to the
+     *  operating system. Slower, but survives a power failure.
+     */
+
+    bool m_sync;
+
+    /**
+     *  The mapping of the file. Where memory-mapping is not available, the
+     *  file is read into m_buffer instead. Remapped when the file grows.
+     */
+
+    mutable const char * m_map;
+    mutable size_t m_map_size;
+    mutable std::string m_buffer;
+
+public:
+
+    journal ();
+    ~journal ();
+    journal (const journal &) = delete;
+    journal (journal &&) = delete;
+    journal & operator = (const journal &) = delete;
+    journal & operator = (journal &&) = delete;
+
+    const std::string & file_name () const
+    {
+        return m_file_name;
+    }
+
+    bool is_open () const
+    {
+        return not_nullptr(m_file);
+    }
+
+    size_t count () const
+    {
+        return m_offsets.size();
+    }
+
+    size_t file_size () const
+    {
+        return m_file_size;
+    }
+
+    void sync (bool flag)
+    {
+        m_sync = flag;
+    }
+
+    bool open (const std::string & filename, bool restore = true);
+    void close ();
+    bool append (const std::string & data);
+    bool truncate (size_t recordcount);
+    bool record (size_t index, const char * & data, size_t & length) const;
+
+private:
+
+    bool map_file () const;
+    void unmap_file () const;
+    bool scan ();
+
+};          // class journal
+
+/**
+ *  The serializer trait used by journal_history<>. It must be specialized
+ *  for each TYPE stored in a journal, providing:
+ *
+ *      -   static bool serialize (const TYPE & s, std::string & data);
+ *      -   static bool deserialize (const char * d, size_t len, TYPE & s);
+ *
+ *  A serializer can write a delta against a known state rather than the
+ *  full state, as long as deserialize() can rebuild the full state.
+ */
+
+template <typename TYPE>
+class history_serializer;
+
+template <>
+class history_serializer<std::string>
+{
+
+public:
+
+    static bool serialize (const std::string & s, std::string & data)
+    {
+        data = s;
+        return true;
+    }
+
+    static bool deserialize (const char * d, size_t len, std::string & s)
+    {
+        s.assign(d, len);
+        return true;
+    }
+
+};          // class history_serializer<std::string>
+
+/**
+ *  Stores all of each options spec, so that the options can be rebuilt
+ *  without a copy of the original.
+ */
+
+template <>
+class history_serializer<options>
+{
+
+public:
+
+    static bool serialize (const options & s, std::string & data);
+    static bool deserialize (const char * d, size_t len, options & s);
+
+};          // class history_serializer<options>
+
+/**
+ *  An undo/redo history like history<>, which also appends every state to a
+ *  journal. Only the newest "window" states are kept in memory. Undoing
+ *  past them pages the older states back in from the journal, and redoing
+ *  pages newer ones back in. Since the journal holds every state, a history
+ *  can be restored from it after a restart or a crash.
+ *
+ *  Indexes and present() count from the first state in the journal, not
+ *  the first state in memory.
+ */
+
+template
+<
+    typename TYPE,
+    typename SERIALIZER = history_serializer<TYPE>
+>
+class journal_history
+{
+
+private:
+
+    /**
+     *  Holds every state, oldest first.
+     */
+
+    journal m_journal;
+
+    /**
+     *  The states held in memory, a run of the states in the journal.
+     */
+
+    std::deque<memento<TYPE>> m_window;
+
+    /**
+     *  The maximum number of states held in memory.
+     */
+
+    const size_t m_window_max;
+
+    /**
+     *  The journal index of m_window[0].
+     */
+
+    size_t m_first;
+
+    /**
+     *  The journal index of the current state.
+     */
+
+    size_t m_present;
+
+    /**
+     *  Scratch space for serializing a state.
+     */
+
+    std::string m_data;
+
+public:
+
+    explicit journal_history (size_t windowmax = 32);
+    journal_history (const journal_history &) = delete;
+    journal_history (journal_history &&) = delete;
+    journal_history & operator = (const journal_history &) = delete;
+    journal_history & operator = (journal_history &&) = delete;
+    ~journal_history () = default;
+
+    bool open (const std::string & filename, bool restore = true);
+
+    void close ()
+    {
+        m_journal.close();
+        m_window.clear();
+        m_first = m_present = 0;
+    }
+
+    void sync (bool flag)
+    {
+        m_journal.sync(flag);
+    }
+
+    bool active () const
+    {
+        return m_journal.count() > 0;
+    }
+
+    size_t window_max () const
+    {
+        return m_window_max;
+    }
+
+    size_t window_size () const
+    {
+        return m_window.size();
+    }
+
+    size_t size () const
+    {
+        return m_journal.count();
+    }
+
+    int present () const
+    {
+        return int(m_present);
+    }
+
+    bool undoable () const
+    {
+        return active() && m_present > 0;
+    }
+
+    bool redoable () const
+    {
+        return active() && m_present < (m_journal.count() - 1);
+    }
+
+    const TYPE & get_present ()
+    {
+        return get(m_present);
+    }
+
+    bool add (const TYPE & s)
+    {
+        memento<TYPE> m{s};
+        return push(std::move(m));
+    }
+
+    bool add (TYPE && s)
+    {
+        memento<TYPE> m{std::move(s)};
+        return push(std::move(m));
+    }
+
+    const TYPE & get (size_t index);
+    const TYPE & undo ();
+    const TYPE & redo ();
+    bool reset ();
+
+private:
+
+    bool push (memento<TYPE> && m);
+    bool load (size_t index, memento<TYPE> & m);
+    bool page_in (size_t index);
+
+};          // class journal_history
+
+template <typename TYPE, typename SERIALIZER>
+journal_history<TYPE, SERIALIZER>::journal_history (size_t windowmax) :
+    m_journal       (),
+    m_window        (),
+    m_window_max    (windowmax > 0 ? windowmax : 1),
+    m_first         (0),
+    m_present       (0),
+    m_data          ()
+{
+    // no other code
+}
+
+/**
+ *  Opens the journal file. If restoring, the newest state in the journal
+ *  becomes the current state. Otherwise the journal is emptied.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+bool
+journal_history<TYPE, SERIALIZER>::open
+(
+    const std::string & filename, bool restore
+)
+{
+    m_window.clear();
+    m_first = m_present = 0;
+    bool result = m_journal.open(filename, restore);
+    if (result && active())
+    {
+        m_present = m_first = m_journal.count() - 1;
+        memento<TYPE> m;
+        result = load(m_present, m);
+        if (result)
+            m_window.push_back(std::move(m));
+        else
+            (void) m_journal.truncate(0);   /* unreadable, start over       */
+    }
+    return result;
+}
+
+/**
+ *  Reads and deserializes one state from the journal.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+bool
+journal_history<TYPE, SERIALIZER>::load (size_t index, memento<TYPE> & m)
+{
+    const char * data = nullptr;
+    size_t length = 0;
+    bool result = m_journal.record(index, data, length);
+    if (result)
+    {
+        TYPE s;
+        result = SERIALIZER::deserialize(data, length, s);
+        if (result)
+            (void) m.set_state(std::move(s));
+    }
+    return result;
+}
+
+/**
+ *  Makes sure the state at the given journal index is in memory. States
+ *  between it and the window are paged in as well, so that the window
+ *  stays a contiguous run of states. States at the far end of the window
+ *  are dropped to keep it within its maximum size.
+ *
+ *  If the state is more than a window away, the states in between would
+ *  each be deserialized only to be dropped, so the window is emptied and
+ *  started again at the state.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+bool
+journal_history<TYPE, SERIALIZER>::page_in (size_t index)
+{
+    bool result = true;
+    size_t last = m_first + m_window.size();        /* one past the window  */
+    size_t distance = 0;
+    if (index < m_first)
+        distance = m_first - index;
+    else if (index >= last)
+        distance = index - last + 1;
+
+    if (m_window.empty() || distance > m_window_max)
+    {
+        memento<TYPE> m;
+        result = load(index, m);
+        if (result)
+        {
+            m_window.clear();
+            m_window.push_back(std::move(m));
+            m_first = index;
+        }
+    }
+    while (result && index < m_first)
+    {
+        memento<TYPE> m;
+        result = load(m_first - 1, m);
+        if (result)
+        {
+            m_window.push_front(std::move(m));
+            --m_first;
+            if (m_window.size() > m_window_max)
+                m_window.pop_back();
+        }
+    }
+    while (result && index >= m_first + m_window.size())
+    {
+        memento<TYPE> m;
+        result = load(m_first + m_window.size(), m);
+        if (result)
+        {
+            m_window.push_back(std::move(m));
+            if (m_window.size() > m_window_max)
+            {
+                m_window.pop_front();
+                ++m_first;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Appends a state after the current one, first dropping the states that
+ *  could have been redone, from both memory and the journal.
+ *
+ * \return
+ *      Returns false if the state could not be written to the journal.
+ *      In that case the history is unchanged.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+bool
+journal_history<TYPE, SERIALIZER>::push (memento<TYPE> && m)
+{
+    bool result = m_journal.is_open();
+    if (result)
+    {
+        size_t keep = active() ? m_present + 1 : 0 ;
+        result = m_journal.truncate(keep);
+        if (result)
+        {
+            while (m_window.size() > 0 && m_first + m_window.size() > keep)
+                m_window.pop_back();
+
+            result = SERIALIZER::serialize(m.get_state(), m_data);
+        }
+        if (result)
+            result = m_journal.append(m_data);
+
+        if (result)
+        {
+            if (m_first + m_window.size() != keep)     /* window elsewhere */
+            {
+                m_window.clear();
+                m_first = keep;
+            }
+
+            m_window.push_back(std::move(m));
+            if (m_window.size() > m_window_max)
+            {
+                m_window.pop_front();
+                ++m_first;
+            }
+            m_present = m_journal.count() - 1;
+        }
+    }
+    return result;
+}
+
+template <typename TYPE, typename SERIALIZER>
+const TYPE &
+journal_history<TYPE, SERIALIZER>::undo ()
+{
+    static TYPE s_dummy;
+    if (undoable() && page_in(m_present - 1))
+    {
+        --m_present;
+        return m_window[m_present - m_first].get_state();
+    }
+    else
+        return s_dummy;
+}
+
+template <typename TYPE, typename SERIALIZER>
+const TYPE &
+journal_history<TYPE, SERIALIZER>::redo ()
+{
+    static TYPE s_dummy;
+    if (redoable() && page_in(m_present + 1))
+    {
+        ++m_present;
+        return m_window[m_present - m_first].get_state();
+    }
+    else
+        return s_dummy;
+}
+
+/**
+ *  Gets any state in the journal, paging it in if needed. This can move
+ *  the window away from the current state, so a later undo or redo might
+ *  need to page in again.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+const TYPE &
+journal_history<TYPE, SERIALIZER>::get (size_t index)
+{
+    static TYPE s_dummy;
+    if (index < m_journal.count() && page_in(index))
+        return m_window[index - m_first].get_state();
+    else
+        return s_dummy;
+}
+
+/**
+ *  Empties the history and the journal.
+ */
+
+template <typename TYPE, typename SERIALIZER>
+bool
+journal_history<TYPE, SERIALIZER>::reset ()
+{
+    bool result = active();
+    if (result)
+    {
+        (void) m_journal.truncate(0);
+        m_window.clear();
+        m_first = m_present = 0;
+    }
+    return result;
+}
+
+}           // namespace cfg
+
+#endif      // CFG66_CFG_JOURNAL_HPP
+
+/*
+ * journal.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -27,7 +27,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-08-03
- * \updates       2024-09-05
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  Documented in the cpp file. Also note the type alias, option_memento,
@@ -36,6 +36,8 @@
  *
  */
 
+#include <utility>                      /* std::move()                      */
+
 #include "cpp_types.hpp"                /* string, vector, msglevel         */
 #include "cfg/options.hpp"              /* cfg::options (with source names) */
 
@@ -96,6 +98,11 @@ public:                                     /* originator's wide interface  */
         // no other code
     }
 
+    memento (TYPE && s) : m_state (std::move(s))
+    {
+        // no other code
+    }
+
     memento (const memento &) = default;
     memento (memento &&) = default;
     memento & operator = (const memento &) = default;
@@ -107,6 +114,12 @@ public:                                     /* originator's wide interface  */
         return true;
     }
 
+    bool set_state (TYPE && s)
+    {
+        m_state = std::move(s);
+        return true;
+    }
+
     const TYPE & get_state () const
     {
         return m_state;
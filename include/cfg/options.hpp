@@ -28,7 +28,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-07-27
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  Supports variables of the following types:
@@ -59,6 +59,7 @@
  *          be used to hold string versions of enumeration values.
  */
 
+#include <cstdint>                      /* std::uint64_t                    */
 #include <map>                          /* std::map container               */
 #include <string>                       /* std::string class                */
 
@@ -117,6 +118,10 @@ static std::string global{""};
 static std::string lookup{"?"};
 static std::string bad{"?"};
 
+template <typename TYPE>
+class history_serializer;               /* see the journal.hpp module       */
+class options_snapshot;                 /* see the snapshot.hpp module      */
+
 /**
  *  Accessor function class.
  */
@@ -124,6 +129,8 @@ static std::string bad{"?"};
 class options
 {
     friend class cli::parser;
+    friend class history_serializer<options>;
+    friend class options_snapshot;
 
 public:
 
@@ -295,6 +302,17 @@ private:
 
     container m_option_pairs;
 
+    /**
+     *  Changes whenever options might have been inserted into or erased from
+     *  m_option_pairs, including through the non-const option_pairs(). It
+     *  comes from one counter shared by all options objects, and a copy or
+     *  move gets a new value, so code holding pointers into the container
+     *  (e.g. the fast-lookup tables of cli::parser) can tell it must
+     *  refresh them.
+     */
+
+    std::size_t m_generation;
+
 public:
 
     options (bool loadglobal = stock);
@@ -304,10 +322,10 @@ public:
         const std::string & file = "",
         const std::string & section = ""
     );
-    options (const options & other) = default;
-    options (options && other) = default;
-    options & operator = (const options & other) = default;
-    options & operator = (options && other) = default;
+    options (const options & other);
+    options (options && other);
+    options & operator = (const options & other);
+    options & operator = (options && other);
     ~options () = default;
 
     static std::string kind_to_string (kind k);
@@ -333,6 +351,7 @@ public:
 
     container & option_pairs ()
     {
+        touch();                        /* the caller might add or erase    */
         return m_option_pairs;
     }
 
@@ -341,6 +360,11 @@ public:
         return m_option_pairs;
     }
 
+    std::size_t generation () const
+    {
+        return m_generation;
+    }
+
     const std::string & code_list () const
     {
         return m_code_list;
@@ -400,6 +424,7 @@ public:
         bool fromcli = false
     );
     bool modified () const;
+    std::uint64_t fingerprint (std::uint64_t seed = 0) const;
     bool was_read_from_cli (const std::string & name) const;
     void set_read_from_cli (const std::string & name, bool flag = true);
     void unmodify (const std::string & name);
@@ -545,11 +570,21 @@ public:
         const std::string & name,
         int & minimum, int & maximum
     ) const;
+    int integer_value_range
+    (
+        const spec & s,
+        int & minimum, int & maximum
+    ) const;
     float floating_value_range
     (
         const std::string & name,
         float & minimum, float & maximum
     ) const;
+    float floating_value_range
+    (
+        const spec & s,
+        float & minimum, float & maximum
+    ) const;
 
     const spec & find_spec (const std::string & name) const;
 
@@ -567,8 +602,22 @@ protected:
 
 private:
 
+    void touch ();
     spec & find_spec (const std::string & name);
     container::const_iterator find_match (const std::string & name) const;
+    bool set_spec_value
+    (
+        const std::string & name,
+        spec & s,
+        const std::string & value
+    );
+    bool change_spec_value
+    (
+        const std::string & name,
+        spec & s,
+        const std::string & value,
+        bool fromcli
+    );
     std::string long_name (char code) const;
     std::string long_name (const std::string & code) const;
     bool check_range
@@ -29,16 +29,25 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-02-18
- * \updates       2024-01-22
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This module is inspired by MidiPerformance::getSequenceColor() in
  *  Kepler34.
+ *
+ *  The palette template keeps its colors in a std::map. The dense_palette
+ *  template keeps them in fixed arrays indexed by the color enumeration,
+ *  so that a lookup is one indexed load. It is meant for code, such as a
+ *  renderer, that looks up a color for every slot or note drawn.
  */
 
+#include <array>                        /* std::array container class       */
+#include <cstddef>                      /* std::size_t                      */
 #include <map>                          /* std::map container class         */
 #include <string>                       /* std::string class                */
 
+#include "c_macros.h"                   /* not_nullptr() macro              */
+
 /*
  *  Do not document a namespace; it breaks Doxygen.
  */
@@ -148,6 +157,30 @@ enum class InvertibleColor
 #define palette_to_int(x)       static_cast<int>(PaletteColor :: x )
 #define inv_palette_to_int(x)   static_cast<int>(InvertibleColor :: x )
 
+/**
+ *  The sizes of the two color sets.
+ */
+
+const int c_palette_color_count = palette_to_int(max);
+const int c_invertible_color_count = inv_palette_to_int(max);
+
+/**
+ *  Indicates if an index names one of the colors of its set. The "none"
+ *  and "max" values do not.
+ */
+
+constexpr bool
+palette_in_range (PaletteColor index)
+{
+    return index >= PaletteColor::black && index < PaletteColor::max;
+}
+
+constexpr bool
+palette_in_range (InvertibleColor index)
+{
+    return index >= InvertibleColor::black && index < InvertibleColor::max;
+}
+
 /**
  *  A generic collection of whatever types of color classes (QColor,
  *  Gdk::Color) one wants to hold, and reference by an index number.
@@ -387,6 +420,316 @@ palette<COLOR>::get_color_name_ex (InvertibleColor index) const
     return result;
 }
 
+/**
+ *  A palette that holds its colors in arrays indexed by the color
+ *  enumerations, rather than in a map. There are three arrays: the
+ *  PaletteColor colors, with PaletteColor::none in slot 0, and the normal
+ *  and inverse InvertibleColor colors. Unlike palette<>, the two color
+ *  sets do not share keys.
+ *
+ *  Every slot always holds a color, so a lookup never fails. Slots not set
+ *  by add() hold a default COLOR and an empty name, except that the "none"
+ *  slot is named "None", as in palette<>.
+ */
+
+template <typename COLOR>
+class dense_palette
+{
+
+private:
+
+    /**
+     *  The number of PaletteColor slots, including the "none" slot.
+     */
+
+    static const int sm_palette_slots = c_palette_color_count + 1;
+
+    std::array<COLOR, sm_palette_slots> m_colors;
+    std::array<std::string, sm_palette_slots> m_color_names;
+
+    /**
+     *  Row 0 holds the normal colors, row 1 the inverse colors.
+     */
+
+    std::array<std::array<COLOR, c_invertible_color_count>, 2> m_invertibles;
+    std::array<std::string, c_invertible_color_count> m_invertible_names;
+
+    /**
+     *  Selects the row of m_invertibles used by get_color(InvertibleColor).
+     *  It is 1 if the --inverse option is in force, and 0 otherwise.
+     */
+
+    int m_inverse;
+
+    /**
+     *  Counts the successful calls to add(). Replacing a color counts
+     *  again.
+     */
+
+    int m_count;
+
+public:
+
+    dense_palette ();
+    dense_palette (const dense_palette &) = default;
+    dense_palette (dense_palette &&) = default;
+    dense_palette & operator = (const dense_palette &) = default;
+    dense_palette & operator = (dense_palette &&) = default;
+    ~dense_palette () = default;
+
+    bool add (PaletteColor index, const COLOR & c, const std::string & name);
+    bool add
+    (
+        InvertibleColor index,
+        const COLOR & c,
+        const COLOR & inverse,
+        const std::string & name
+    );
+
+    bool add (InvertibleColor index, const COLOR & c, const std::string & name)
+    {
+        return add(index, c, c, name);
+    }
+
+    /**
+     *  Gets a PaletteColor. Out-of-range indices, including
+     *  PaletteColor::none, yield the "none" color in slot 0.
+     */
+
+    const COLOR & get_color (PaletteColor index) const
+    {
+        return m_colors[palette_slot(index)];
+    }
+
+    const COLOR & get_color (InvertibleColor index) const
+    {
+        return m_invertibles[m_inverse][invertible_slot(index)];
+    }
+
+    /**
+     *  Gets the inverse color, whatever the current inverse setting.
+     */
+
+    const COLOR & get_inverse_color (InvertibleColor index) const
+    {
+        return m_invertibles[1][invertible_slot(index)];
+    }
+
+    const COLOR & get_normal_color (InvertibleColor index) const
+    {
+        return m_invertibles[0][invertible_slot(index)];
+    }
+
+    const std::string & get_color_name (PaletteColor index) const
+    {
+        return m_color_names[palette_slot(index)];
+    }
+
+    const std::string & get_color_name (InvertibleColor index) const
+    {
+        return m_invertible_names[invertible_slot(index)];
+    }
+
+    std::string get_color_name_ex (PaletteColor index) const;
+    std::string get_color_name_ex (InvertibleColor index) const;
+
+    std::size_t get_colors
+    (
+        const PaletteColor * indices, std::size_t count, COLOR * destination
+    ) const;
+    std::size_t get_colors
+    (
+        const InvertibleColor * indices, std::size_t count, COLOR * destination
+    ) const;
+
+    bool inverse () const
+    {
+        return m_inverse != 0;
+    }
+
+    void inverse (bool flag)
+    {
+        m_inverse = flag ? 1 : 0 ;
+    }
+
+    bool no_color (PaletteColor index) const
+    {
+        return index == PaletteColor::none;
+    }
+
+    int count () const
+    {
+        return m_count;
+    }
+
+private:
+
+    /**
+     *  Maps a PaletteColor to its slot. PaletteColor::none (-1) maps to 0;
+     *  anything out of range also maps to 0.
+     */
+
+    static std::size_t palette_slot (PaletteColor index)
+    {
+        unsigned slot = unsigned(static_cast<int>(index) + 1);
+        return slot < unsigned(sm_palette_slots) ? slot : 0 ;
+    }
+
+    /**
+     *  Maps an InvertibleColor to its slot. Anything out of range maps to
+     *  the black slot, as palette<> does.
+     */
+
+    static std::size_t invertible_slot (InvertibleColor index)
+    {
+        unsigned slot = unsigned(static_cast<int>(index));
+        return slot < unsigned(c_invertible_color_count) ? slot : 0 ;
+    }
+
+};          // class dense_palette
+
+/**
+ *  Creates the palette, with default COLOR objects and empty names.
+ */
+
+template <typename COLOR>
+dense_palette<COLOR>::dense_palette () :
+    m_colors            (),
+    m_color_names       (),
+    m_invertibles       (),
+    m_invertible_names  (),
+    m_inverse           (0),
+    m_count             (0)
+{
+    m_color_names[0] = "None";
+}
+
+/**
+ *  Sets a PaletteColor slot. Unlike palette<>::add(), an existing color is
+ *  replaced.
+ *
+ * \return
+ *      Returns true if the index was valid. PaletteColor::none is valid;
+ *      it sets the color used for out-of-range indices.
+ */
+
+template <typename COLOR>
+bool
+dense_palette<COLOR>::add
+(
+    PaletteColor index,
+    const COLOR & color,
+    const std::string & colorname
+)
+{
+    bool result = index == PaletteColor::none || palette_in_range(index);
+    if (result)
+    {
+        std::size_t slot = palette_slot(index);
+        m_colors[slot] = color;
+        m_color_names[slot] = colorname;
+        ++m_count;
+    }
+    return result;
+}
+
+/**
+ *  Sets the normal and inverse colors of an InvertibleColor slot.
+ */
+
+template <typename COLOR>
+bool
+dense_palette<COLOR>::add
+(
+    InvertibleColor index,
+    const COLOR & color,
+    const COLOR & inverse,
+    const std::string & colorname
+)
+{
+    bool result = palette_in_range(index);
+    if (result)
+    {
+        std::size_t slot = invertible_slot(index);
+        m_invertibles[0][slot] = color;
+        m_invertibles[1][slot] = inverse;
+        m_invertible_names[slot] = colorname;
+        ++m_count;
+    }
+    return result;
+}
+
+template <typename COLOR>
+std::string
+dense_palette<COLOR>::get_color_name_ex (PaletteColor index) const
+{
+    std::string result = std::to_string(static_cast<int>(index));
+    result += " ";
+    result += get_color_name(index);
+    return result;
+}
+
+template <typename COLOR>
+std::string
+dense_palette<COLOR>::get_color_name_ex (InvertibleColor index) const
+{
+    std::string result = std::to_string(static_cast<int>(index));
+    result += " ";
+    result += get_color_name(index);
+    return result;
+}
+
+/**
+ *  Looks up many colors at once, for example all of the slots of a grid.
+ *
+ * \param indices
+ *      Provides the color indices to look up.
+ *
+ * \param count
+ *      Provides the number of indices, and the number of COLOR objects
+ *      that the destination can hold.
+ *
+ * \param destination
+ *      Receives the colors, in the order of the indices.
+ *
+ * \return
+ *      Returns the number of colors stored, which is count, or 0 if a
+ *      pointer is null.
+ */
+
+template <typename COLOR>
+std::size_t
+dense_palette<COLOR>::get_colors
+(
+    const PaletteColor * indices, std::size_t count, COLOR * destination
+) const
+{
+    std::size_t result = 0;
+    if (not_nullptr(indices) && not_nullptr(destination))
+    {
+        for ( ; result < count; ++result)
+            destination[result] = m_colors[palette_slot(indices[result])];
+    }
+    return result;
+}
+
+template <typename COLOR>
+std::size_t
+dense_palette<COLOR>::get_colors
+(
+    const InvertibleColor * indices, std::size_t count, COLOR * destination
+) const
+{
+    std::size_t result = 0;
+    if (not_nullptr(indices) && not_nullptr(destination))
+    {
+        const auto & row = m_invertibles[m_inverse];
+        for ( ; result < count; ++result)
+            destination[result] = row[invertible_slot(indices[result])];
+    }
+    return result;
+}
+
 }           // namespace cfg
 
 #endif      // CFG66_CFG_PALETTE_HPP
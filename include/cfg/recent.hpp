@@ -27,7 +27,7 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-03-29
- * \updates       2024-09-05
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  It is based on the "recent" class of Seq66, with some additional
@@ -35,7 +35,13 @@
  */
 
 #include <deque>
+#include <memory>                       /* std::shared_ptr<>                */
+#include <mutex>                        /* std::mutex, std::lock_guard<>    */
 #include <string>
+#include <thread>                       /* std::thread                      */
+#include <unordered_map>                /* std::unordered_map<>             */
+#include <utility>                      /* std::pair<>                      */
+#include <vector>
 
 namespace cfg
 {
@@ -62,6 +68,38 @@ private:
 
     using container = std::deque<std::string>;
 
+    /**
+     *  Provides an index of the paths in the list, for fast lookup. Each
+     *  path is mapped to the generation at which it was added, so that a
+     *  validation result for an entry that has since been removed and added
+     *  again is not applied to the new entry.
+     */
+
+    using index = std::unordered_map<std::string, unsigned long>;
+
+    /**
+     *  A path and its generation, as checked by a validation.
+     */
+
+    using entry = std::pair<std::string, unsigned long>;
+    using entries = std::vector<entry>;
+
+    /**
+     *  The state shared with a background validation. The thread holds its
+     *  own pointer to it, and is joined by validate() before another one is
+     *  started, and by the destructor.
+     */
+
+    class validation
+    {
+    public:
+
+        std::mutex validation_lock;
+        entries validation_stale;
+        bool validation_busy {false};
+        std::thread validation_thread;
+    };
+
 private:
 
     /**
@@ -70,6 +108,19 @@ private:
 
     container m_recent_list;
 
+    /**
+     *  Holds the same paths as m_recent_list, so that checking whether a
+     *  path is in the list does not require a linear search.
+     */
+
+    index m_recent_index;
+
+    /**
+     *  Counts the entries added, to provide their generations.
+     */
+
+    unsigned long m_generation;
+
     /**
      *  Holds the constraint on the number of recent files.  Usually a value
      *  like 12.
@@ -77,18 +128,54 @@ private:
 
     const int m_maximum_size;
 
+    /**
+     *  If true, append() and add() do not check that the file is readable.
+     *  Instead, validate() checks all of the entries in a background
+     *  thread, and the unreadable ones are pruned later.
+     */
+
+    bool m_deferred_validation;
+
+    /**
+     *  Indicates that entries have been added since the last validation.
+     */
+
+    bool m_validation_pending;
+
+    /**
+     *  Holds the results of the latest background validation.
+     */
+
+    std::shared_ptr<validation> m_validation;
+
 public:
 
     recent ();
-    recent (const recent &) = default;
+    recent (const recent & source);
     recent (recent &&) = default;
     recent & operator = (const recent &);
     recent & operator = (recent &&) = delete;
-    ~recent () = default;
+    ~recent ();
 
     void clear ()
     {
         m_recent_list.clear();
+        m_recent_index.clear();
+    }
+
+    bool deferred_validation () const
+    {
+        return m_deferred_validation;
+    }
+
+    void deferred_validation (bool flag)
+    {
+        m_deferred_validation = flag;
+    }
+
+    bool validation_pending () const
+    {
+        return m_validation_pending;
     }
 
     int count () const
@@ -115,6 +202,26 @@ public:
     bool append (const std::string & item);
     bool add (const std::string & item);
     bool remove (const std::string & item);
+    bool contains (const std::string & item) const;
+    bool validate ();
+    bool validating () const;
+    int prune ();
+
+private:
+
+    bool contains_path (const std::string & path) const
+    {
+        return m_recent_index.find(path) != m_recent_index.end();
+    }
+
+    std::string full_path (const std::string & item) const;
+    void index_erase (const std::string & path);
+    void join_validation ();
+    static void check_batch
+    (
+        std::shared_ptr<validation> v,
+        const entries & batch
+    );
 
 };          // class recent
 
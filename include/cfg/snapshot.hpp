@@ -0,0 +1,229 @@
+#if ! defined CFG66_CFG_SNAPSHOT_HPP
+#define CFG66_CFG_SNAPSHOT_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          snapshot.hpp
+ *
+ *  This module defines immutable, structurally-shared snapshots of options
+ *  and inisections.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#include <memory>                       /* std::shared_ptr<>                */
+
+#include "cpp_types.hpp"                /* string, vector, msglevel         */
+#include "cfg/inisections.hpp"          /* cfg::inisections class           */
+#include "cfg/options.hpp"              /* cfg::options class               */
+
+/*
+ * Do not attempt to Doxygenate the documentation here; it breaks Doxygen.
+ */
+
+namespace cfg
+{
+
+/**
+ *  An immutable copy of a set of options. The options are stored, in name
+ *  order, in chunks of up to chunk_size options. Copying a snapshot copies
+ *  one pointer. Changing a value makes a new snapshot that shares every
+ *  chunk except the one holding the option.
+ *
+ *  Snapshots can be handed to other threads freely, since nothing they
+ *  share is ever changed.
+ */
+
+class options_snapshot
+{
+
+public:
+
+    static const size_t chunk_size{16};
+
+    using chunk = std::vector<options::option>;
+    using chunk_pointer = std::shared_ptr<const chunk>;
+
+private:
+
+    /**
+     *  The shared part of a snapshot.
+     */
+
+    class table
+    {
+    public:
+
+        std::vector<chunk_pointer> table_chunks;
+        size_t table_size;
+        std::string table_source_file;
+        std::string table_source_section;
+    };
+
+    std::shared_ptr<const table> m_table;
+
+public:
+
+    options_snapshot ();
+    explicit options_snapshot (const options & opts);
+    options_snapshot (const options_snapshot &) = default;
+    options_snapshot (options_snapshot &&) = default;
+    options_snapshot & operator = (const options_snapshot &) = default;
+    options_snapshot & operator = (options_snapshot &&) = default;
+    ~options_snapshot () = default;
+
+    size_t size () const
+    {
+        return m_table->table_size;
+    }
+
+    bool empty () const
+    {
+        return size() == 0;
+    }
+
+    size_t chunk_count () const
+    {
+        return m_table->table_chunks.size();
+    }
+
+    const std::string & source_file () const
+    {
+        return m_table->table_source_file;
+    }
+
+    const std::string & source_section () const
+    {
+        return m_table->table_source_section;
+    }
+
+    /**
+     *  Indicates that two snapshots are the same snapshot, not just equal.
+     */
+
+    bool same (const options_snapshot & other) const
+    {
+        return m_table == other.m_table;
+    }
+
+    bool shares_chunk (const options_snapshot & other, size_t index) const;
+    const options::spec * find (const std::string & name) const;
+    std::string value (const std::string & name) const;
+    options_snapshot set_value
+    (
+        const std::string & name,
+        const std::string & value
+    ) const;
+    options to_options () const;
+    bool apply (options & target) const;
+
+private:
+
+    bool locate
+    (
+        const std::string & name, size_t & c, size_t & index
+    ) const;
+
+};          // class options_snapshot
+
+/**
+ *  An immutable copy of a set of INI sections. Each section holds an
+ *  options_snapshot, so changing one value copies the list of sections
+ *  and one chunk of one section.
+ */
+
+class inisections_snapshot
+{
+
+public:
+
+    /**
+     *  One INI section: its name, configuration type, and options.
+     */
+
+    class section
+    {
+    public:
+
+        std::string section_name;
+        std::string section_config_type;
+        options_snapshot section_options;
+    };
+
+    using sectionlist = std::vector<section>;
+
+private:
+
+    std::shared_ptr<const sectionlist> m_sections;
+
+public:
+
+    inisections_snapshot ();
+    explicit inisections_snapshot (const inisections & sections);
+    inisections_snapshot (const inisections_snapshot &) = default;
+    inisections_snapshot (inisections_snapshot &&) = default;
+    inisections_snapshot & operator = (const inisections_snapshot &) = default;
+    inisections_snapshot & operator = (inisections_snapshot &&) = default;
+    ~inisections_snapshot () = default;
+
+    size_t size () const
+    {
+        return m_sections->size();
+    }
+
+    const sectionlist & sections () const
+    {
+        return *m_sections;
+    }
+
+    const options_snapshot & find_options
+    (
+        const std::string & sectionname
+    ) const;
+    std::string value
+    (
+        const std::string & sectionname,
+        const std::string & name
+    ) const;
+    inisections_snapshot set_value
+    (
+        const std::string & sectionname,
+        const std::string & name,
+        const std::string & value
+    ) const;
+
+};          // class inisections_snapshot
+
+}           // namespace cfg
+
+#endif      // CFG66_CFG_SNAPSHOT_HPP
+
+/*
+ * snapshot.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
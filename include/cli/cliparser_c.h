@@ -24,10 +24,16 @@
  *
  *  Type definitions pulled out for the needs of the refactoring.
  *
+ *  There are two sets of functions. The first, older set works on a single
+ *  hidden parser, and is meant for use by one thread. The second set works
+ *  on a cfg66_parser handle. Each handle holds its own parser, so different
+ *  threads can each use their own handle at the same time. A single handle
+ *  must not be used by more than one thread at a time without locking.
+ *
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-07-15
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -92,6 +98,34 @@ extern const char * debug_text (void);
 extern bool help_request (void);
 extern bool version_request (void);
 
+/**
+ *  An opaque handle to a parser. See the cliparser_c.cpp module.
+ */
+
+typedef struct cfg66_parser cfg66_parser;
+
+extern cfg66_parser * cfg66_parser_create
+(
+    const options_spec * opts, int optcount
+);
+extern void cfg66_parser_destroy (cfg66_parser * p);
+extern void cfg66_parser_reset (cfg66_parser * p);
+extern bool cfg66_parser_parse (cfg66_parser * p, int argc, char * argv []);
+extern bool cfg66_parser_change_value
+(
+    cfg66_parser * p, const char * name, const char * value, bool fromcli
+);
+extern bool cfg66_parser_value
+(
+    const cfg66_parser * p, const char * name,
+    const char ** value, size_t * length
+);
+extern const char * cfg66_parser_help_text (cfg66_parser * p);
+extern const char * cfg66_parser_debug_text (cfg66_parser * p);
+extern const char * cfg66_parser_error_msg (const cfg66_parser * p);
+extern bool cfg66_parser_help_request (const cfg66_parser * p);
+extern bool cfg66_parser_version_request (const cfg66_parser * p);
+
 EXTERN_C_END
 
 #endif          // CFG66_CLIPARSER_C_H
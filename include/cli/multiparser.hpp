@@ -27,14 +27,19 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-06-23
- * \updates       2024-09-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  This class provides a way to look up command-line options specified by
  *  multiple INI files and INI sections.
+ *
+ *  As mappings are added, each option is also given a direct "route" to the
+ *  cfg::options object (in the inimanager) that holds it, so that parsing
+ *  needs only one table lookup per command-line token.
  */
 
 #include <map>                          /* std::map<> template class        */
+#include <vector>                       /* std::vector<> template class     */
 
 #include "cfg/inisections.hpp"          /* cfg::inisections and options     */
 #include "cli/parser.hpp"               /* cfg::parser class                */
@@ -86,6 +91,30 @@ public:
 
     using names = std::map<std::string, duo>;
 
+    /**
+     *  A direct route from a command-line option to the options object that
+     *  holds it (in an inisection owned by the inimanager) and to the option
+     *  itself. This avoids the codes/names lookups and the search for the
+     *  inisection for each token parsed.
+     *
+     *  The section and option are found when the route is added, if the
+     *  section is active, and found again when needed if the section was
+     *  not active then, or if options have since been added to or erased
+     *  from it (see cfg::options::generation()). So an option in a section
+     *  activated later still becomes reachable.
+     */
+
+    struct route
+    {
+        std::string route_name;
+        duo route_duo;
+        cfg::options * route_options;
+        lookup_entry route_option;
+        std::size_t route_generation;
+    };
+
+    using routes = std::vector<route>;
+
 private:
 
     /**
@@ -116,6 +145,14 @@ private:
 
     names m_cli_mappings;
 
+    /**
+     *  The routes, sorted by long option name, and the routes indexed by
+     *  option code. Built in cli_mappings_add().
+     */
+
+    routes m_name_routes;
+    routes m_code_routes;
+
 public:
 
     multiparser () = delete;
@@ -172,8 +209,40 @@ public:
         return m_ini_manager;
     }
 
+protected:
+
+    virtual bool parse_tokens (int argc, char * argv []) override
+    {
+        return fast_parse(argc, argv);  /* always use the routes            */
+    }
+
+    virtual bool lookup_ready () const override
+    {
+        return true;                    /* routes are kept up-to-date       */
+    }
+
+    virtual lookup_entry lookup_name
+    (
+        const char * name, std::size_t len
+    ) const override;
+    virtual lookup_entry select_option
+    (
+        const char * name, std::size_t len, bool & inactive
+    ) override;
+
 private:
 
+    void add_route
+    (
+        const std::string & name,
+        char code,
+        const std::string & configtype,
+        const std::string & configsection
+    );
+    const route * find_route (const char * name, std::size_t len) const;
+    route * find_route (const char * name, std::size_t len);
+    bool resolve_route (route & rt) const;
+
     const codes & code_mappings () const
     {
         return m_code_mappings;
@@ -27,7 +27,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-09-30
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  Provides for the handling of options specifications.  This module is
@@ -53,7 +53,19 @@
  *  The --config option is, by default, the session file in the default
  *  --home directory.
  *
+ * Fast lookup:
  *
+ *  Calling fast_lookup(true) makes parse() build a sorted table of the long
+ *  option names and a table of the option codes, once, and then walk argv
+ *  as raw C strings. Each token is resolved with a binary search (or one
+ *  index for a code), and values are stored directly into the option, with
+ *  no per-token std::string copies.
+ *
+ * Args files:
+ *
+ *  A token of the form "@argsfile" is replaced by the options read from that
+ *  file, one line at a time, quoted as per util::tokenize_quoted(). Errors
+ *  are reported as "argsfile:line: message".
  */
 
 #include <string>                       /* std::string class                */
@@ -74,6 +86,27 @@ namespace cli
 class parser
 {
 
+public:
+
+    /**
+     *  An entry in the fast-lookup tables. It points to the name/spec pair
+     *  held in the option set, so that the option name need not be copied.
+     */
+
+    using lookup_entry = cfg::options::container::value_type *;
+
+    /**
+     *  The code table is indexed by 7-bit option-code characters.
+     */
+
+    static const std::size_t code_table_size{128};
+
+    /**
+     *  Limits how deeply "@argsfile" files can refer to other args files.
+     */
+
+    static const int args_file_depth_max{8};
+
 private:
 
     /**
@@ -130,6 +163,39 @@ private:
     bool m_use_log_file;
     std::string m_log_file;
 
+    /**
+     *  If true, parse() uses the fast-lookup tables below. The default is
+     *  false.
+     */
+
+    bool m_fast_lookup;
+
+    /**
+     *  The sorted long-name table and the code table. Since std::map is
+     *  already sorted by name, building the name table is one walk through
+     *  the option set. The tables refer to the options in m_lookup_owner,
+     *  and are rebuilt if that set is a different object (e.g. this parser
+     *  was copied) or its generation has changed, meaning options might
+     *  have been added or erased.
+     */
+
+    std::vector<lookup_entry> m_name_table;
+    std::vector<lookup_entry> m_code_table;
+    const cfg::options * m_lookup_owner;
+    std::size_t m_lookup_generation;
+
+    /**
+     *  Reused to hold values being stored, to avoid reallocation per token.
+     */
+
+    std::string m_value_scratch;
+
+    /**
+     *  The current nesting of "@argsfile" files being parsed.
+     */
+
+    int m_args_file_depth;
+
 public:
 
     parser ();
@@ -173,6 +239,16 @@ public:
         return m_has_error;
     }
 
+    bool fast_lookup () const
+    {
+        return m_fast_lookup;
+    }
+
+    void fast_lookup (bool flag)
+    {
+        m_fast_lookup = flag;
+    }
+
     const std::string & error_msg () const
     {
         return m_error_msg;
@@ -498,9 +574,30 @@ protected:
     );
     bool parse_value
     (
-        int argc, char * argv [], int index,
+        int argc, char * argv [], int & index,
         const std::string & token
     );
+    void value_error (const std::string & name, const std::string & value);
+    virtual bool parse_tokens (int argc, char * argv []);
+    bool parse_args_file (const std::string & filename);
+    void args_file_error
+    (
+        const std::string & filename,
+        int lineno,
+        const std::string & msg
+    );
+    bool build_lookup ();
+    virtual bool lookup_ready () const;
+    virtual lookup_entry lookup_name
+    (
+        const char * name, std::size_t len
+    ) const;
+    virtual lookup_entry select_option
+    (
+        const char * name, std::size_t len, bool & inactive
+    );
+    bool fast_parse (int argc, char * argv []);
+    bool fast_parse_value (int argc, char * argv [], int & index);
 
 };          // class parser
 
@@ -0,0 +1,204 @@
+#if ! defined CFG66_UTIL_BYTESTREAM_HPP
+#define CFG66_UTIL_BYTESTREAM_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          bytestream.hpp
+ *
+ *  This module declares/defines a class for reading big-endian data from a
+ *  file too large to be read into memory.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include <memory>                       /* std::unique_ptr<>                */
+
+#include "util/byteview.hpp"            /* util::byteview, util::bytevector */
+
+namespace util
+{
+
+/**
+ *  Reads a file through a sliding window, with the get and peek functions
+ *  of bytevector. The next block of the file is read by a background
+ *  thread while the current one is parsed.
+ */
+
+class bytestream
+{
+
+public:
+
+    /**
+     *  The default size of each block read from the file, and the default
+     *  most bytes that can be peeked at, or required, at once.
+     */
+
+    static const size_t default_block_size = 4 * 1024 * 1024;
+    static const size_t default_peek_max = 64 * 1024;
+
+private:
+
+    /**
+     *  The file and the read-ahead thread, defined in the cpp file.
+     */
+
+    class reader;
+
+    std::unique_ptr<reader> m_reader;
+    std::string m_file_name;
+
+    /**
+     *  The window buffer. The first m_peek_max bytes are room for the
+     *  unread end of the previous block; the block itself follows.
+     */
+
+    util::bytes m_buffer;
+    size_t m_block_size;
+    size_t m_peek_max;
+
+    /**
+     *  The bytes in the window, the file offset of the first one, and the
+     *  read position in the window.
+     */
+
+    const util::byte * m_window;
+    size_t m_window_size;
+    size_t m_window_offset;
+    size_t m_position;
+
+    /**
+     *  Set once the last block of the file has been taken.
+     */
+
+    bool m_end_of_file;
+
+    /**
+     *  The first error, as in bytevector. Later errors are not reported.
+     */
+
+    std::string m_error_message;
+    bool m_error_is_fatal;
+
+public:
+
+    bytestream ();
+    bytestream (const bytestream &) = delete;
+    bytestream & operator = (const bytestream &) = delete;
+    ~bytestream ();
+
+    bool open
+    (
+        const std::string & infilename,
+        size_t blocksize = default_block_size,
+        size_t peekmax = default_peek_max
+    );
+    void close ();
+
+    bool is_open () const
+    {
+        return bool(m_reader);
+    }
+
+    const std::string & error_message () const
+    {
+        return m_error_message;
+    }
+
+    bool fatal_error () const
+    {
+        return m_error_is_fatal;
+    }
+
+    /**
+     *  The offset in the file of the next byte to be read.
+     */
+
+    size_t position () const
+    {
+        return m_window_offset + m_position;
+    }
+
+    /**
+     *  The bytes that can be read without waiting for the next block.
+     */
+
+    size_t available () const
+    {
+        return m_window_size - m_position;
+    }
+
+    bool done ()
+    {
+        return ! require(1);
+    }
+
+    bool require (size_t sz)
+    {
+        return sz <= available() || fill(sz);
+    }
+
+    bool skip (size_t sz);
+    util::byte get_byte ();
+    util::ushort get_short ();
+    util::ulong get_triple ();
+    util::ulong get_long ();
+    util::ulonglong get_longlong ();
+    util::ulong get_varinum ();
+    std::string get_string (size_t len);
+    util::byte peek_byte ();
+    util::byte peek_byte (size_t offset);
+    util::ushort peek_short ();
+    util::ulong peek_long ();
+    util::ulonglong peek_longlong ();
+    const util::byte * peek (size_t sz);
+    byteview peek_view (size_t sz);
+
+private:
+
+    bool fill (size_t sz);
+    bool next_block ();
+    bool set_error (const std::string & msg);
+
+    template <typename T>
+    T get_big ();
+
+};              // class bytestream
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_BYTESTREAM_HPP
+
+/*
+ * bytestream.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,7 +28,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-05-16
- * \updates       2024-05-21
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The bytevector class is meant for handling number binary data in chunks
@@ -43,9 +43,30 @@
 
 #include <climits>                      /* LONG_MAX and other limits        */
 #include <cstdint>                      /* uint64_t and other types         */
+#include <cstdio>                       /* std::FILE                        */
+#include <cstring>                      /* std::memcpy()                    */
+#include <memory>                       /* std::shared_ptr<>                */
 #include <string>                       /* std::string, basic_string        */
 #include <vector>                       /* std::vector<byte> etc.           */
 
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "platform_macros.h"            /* PLATFORM_GNU, PLATFORM_MSVC      */
+
+#if defined PLATFORM_MSVC
+#include <stdlib.h>                     /* _byteswap_ushort(), etc.         */
+#endif
+
+/**
+ *  Defined if the host is big-endian, in which case the big-endian loads
+ *  need no byte-swap. All of our Windows targets are little-endian.
+ */
+
+#if defined __BYTE_ORDER__ && defined __ORDER_BIG_ENDIAN__
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define CFG66_BIG_ENDIAN_HOST
+#endif
+#endif
+
 namespace util
 {
 
@@ -81,19 +102,142 @@ using ulonglong = uint64_t;
 
 using bytes = std::vector<byte>;
 
+/**
+ *  Byte-swaps for each of the fixed-width types. The compiler intrinsics
+ *  become a single instruction.
+ */
+
+inline byte
+byte_swap (byte x)
+{
+    return x;
+}
+
+inline ushort
+byte_swap (ushort x)
+{
+#if defined PLATFORM_GNU || defined PLATFORM_CLANG
+    return __builtin_bswap16(x);
+#elif defined PLATFORM_MSVC
+    return _byteswap_ushort(x);
+#else
+    return ushort((x << 8) | (x >> 8));
+#endif
+}
+
+inline ulong
+byte_swap (ulong x)
+{
+#if defined PLATFORM_GNU || defined PLATFORM_CLANG
+    return __builtin_bswap32(x);
+#elif defined PLATFORM_MSVC
+    return _byteswap_ulong(x);
+#else
+    return
+        ((x & 0xFF000000) >> 24) | ((x & 0x00FF0000) >> 8) |
+        ((x & 0x0000FF00) << 8)  | ((x & 0x000000FF) << 24) ;
+#endif
+}
+
+inline ulonglong
+byte_swap (ulonglong x)
+{
+#if defined PLATFORM_GNU || defined PLATFORM_CLANG
+    return __builtin_bswap64(x);
+#elif defined PLATFORM_MSVC
+    return _byteswap_uint64(x);
+#else
+    return
+        (ulonglong(byte_swap(ulong(x))) << 32) | byte_swap(ulong(x >> 32));
+#endif
+}
+
+/**
+ *  Loads a big-endian value from a possibly unaligned address. The
+ *  std::memcpy() compiles to a single load. The caller must make sure
+ *  that sizeof(T) bytes are available.
+ */
+
+template <typename T>
+inline T
+load_big (const byte * p)
+{
+    T result;
+    std::memcpy(&result, p, sizeof result);
+#if ! defined CFG66_BIG_ENDIAN_HOST
+    result = byte_swap(result);
+#endif
+    return result;
+}
+
+/**
+ *  Stores a value as big-endian bytes at a possibly unaligned address. The
+ *  caller must make sure that sizeof(T) bytes are available.
+ */
+
+template <typename T>
+inline void
+store_big (T value, byte * p)
+{
+#if ! defined CFG66_BIG_ENDIAN_HOST
+    value = byte_swap(value);
+#endif
+    std::memcpy(p, &value, sizeof value);
+}
+
+/**
+ *  A per-thread pool of byte vectors, for building many outputs one after
+ *  the other without allocating for each one. See bytevector::acquire()
+ *  and bytevector::recycle().
+ */
+
+class bytepool
+{
+
+public:
+
+    /**
+     *  A hook to adjust the size reserved for a new buffer. It gets the
+     *  pool's estimate (the running average of the sizes of recycled
+     *  buffers) and returns the size to reserve.
+     */
+
+    using estimator = size_t (*) (size_t estimate);
+
+    static const size_t max_buffers = 16;
+    static const size_t max_capacity = 16 * 1024 * 1024;
+
+    static util::bytes acquire (size_t estimate = 0);
+    static void release (util::bytes & b);
+    static size_t available ();
+    static size_t estimate ();
+    static void set_estimator (estimator e);
+    static void drain ();
+
+};              // class bytepool
+
 /**
  *  This class handles the parsing and writing of byte data.
  */
 
 class bytevector
 {
+    friend class bytetransaction;
+
+private:
+
+    /**
+     *  A read-only memory-mapping of a file, defined in the cpp file.
+     */
+
+    class mapping;
 
 private:
 
     /**
      *  Holds the initial or final size of the MIDI bytevector.  It is a
      *  nominal size set when allocating data. The true size is always
-     *  m_data.size().
+     *  size().
      */
 
     size_t m_nominal_size;
@@ -129,11 +273,23 @@ private:
     mutable bool m_disable_reported;
 
     /**
-     *  Holds all the bytes of the bytevector, read in at once.
+     *  Holds all the bytes of the bytevector, read in at once. In mapped
+     *  mode (see read_mapped()), this is empty until the first put or
+     *  poke copies the mapped bytes into it.
      */
 
     util::bytes m_data;
 
+    /**
+     *  In mapped mode, holds the mapping of the file, plus the address and
+     *  size of the mapped bytes. Copies of a mapped bytevector share the
+     *  mapping, which is read-only, and is released with the last copy.
+     */
+
+    std::shared_ptr<const mapping> m_mapping;
+    const util::byte * m_map_data;
+    size_t m_map_size;
+
     /**
      *  Holds the position in the bytevector. This is at least a 31-bit
      *  value in the recent architectures running Linux and Windows, so it
@@ -154,9 +310,9 @@ public:
         size_t amount   = 0
     );
     bytevector (const bytevector &) = default;
-    bytevector (bytevector &&) = default;
+    bytevector (bytevector && source);
     bytevector & operator = (const bytevector &) = default;
-    bytevector & operator = (bytevector &&) = default;
+    bytevector & operator = (bytevector && source);
     ~bytevector () = default;
 
     void assign
@@ -188,19 +344,41 @@ public:
         return m_error_is_fatal;
     }
 
+    /**
+     *  Gets the byte vector for changing. In mapped mode, this first
+     *  copies the mapped bytes into the vector.
+     */
+
     util::bytes & byte_list ()
     {
+        unmap();
         return m_data;
     }
 
+    /**
+     *  Gets the byte vector. In mapped mode it is empty; use data() and
+     *  size() to get at the bytes in either mode.
+     */
+
     const util::bytes & byte_list () const
     {
         return m_data;
     }
 
+    bool mapped () const
+    {
+        return not_nullptr(m_map_data);
+    }
+
+    const util::byte * data () const
+    {
+        return mapped() ? m_map_data : m_data.data() ;
+    }
+
     void clear ()
     {
         clear_errors();
+        release_mapping();
         m_data.clear();
         m_nominal_size = m_offset = m_position = 0;
     }
@@ -221,11 +399,13 @@ public:
         return m_nominal_size;
     }
 
-    size_t size ()
+    size_t size () const
     {
-        return m_data.size();
+        return mapped() ? m_map_size : m_data.size() ;
     }
 
+    std::uint64_t fingerprint () const;
+
     size_t offset () const
     {
         return m_offset;
@@ -236,7 +416,7 @@ public:
 
     bool seek (size_t pos)
     {
-        bool result = pos < m_data.size();
+        bool result = pos < size();
         if (result)
             m_position = pos;
 
@@ -250,7 +430,7 @@ public:
 
     void increment () const
     {
-        if (m_position < (m_data.size() - 1))
+        if (m_position < (size() - 1))
             ++m_position;
     }
 
@@ -262,7 +442,7 @@ public:
 
     void skip (size_t sz)
     {
-        if (m_position < (m_data.size() - sz))
+        if (m_position < (size() - sz))
             m_position += sz;
     }
 
@@ -272,6 +452,7 @@ public:
     util::ulong get_long () const;
     util::ulonglong get_longlong () const;
     util::ulong get_varinum ();
+    size_t get_varinums (util::ulong * destination, size_t count);
     std::string get_string (size_t len = 0);
     util::byte peek_byte () const;
     util::byte peek_byte (size_t offset) const;
@@ -281,29 +462,54 @@ public:
     util::ulonglong peek_longlong () const;
     std::string peek_string (size_t offset = 0, size_t amount = 0);
 
+    template <typename T>
+    size_t get_array (T * destination, size_t count) const;
+
     /*
      * Useful in testing the completeness of reading data.
      */
 
     size_t remainder () const
     {
-        return m_data.size() - m_position;
+        return size() - m_position;
     }
 
     void put_byte (util::byte c)
     {
+        unmap();
         m_data.push_back(c);
         ++m_position;
     }
 
+    /**
+     *  Reserves room for \a sz more bytes, so that the puts that follow do
+     *  not reallocate.
+     */
+
+    void reserve (size_t sz)
+    {
+        unmap();
+        m_data.reserve(m_data.size() + sz);
+    }
+
+    size_t capacity () const
+    {
+        return mapped() ? m_map_size : m_data.capacity() ;
+    }
+
+    void acquire (size_t estimate = 0);
+    void recycle ();
+
     void put_short (util::ushort value);
     void put_triple (util::ulong x);
     void put_long (util::ulong value);
     void put_longlong (util::ulonglong value);
     void put_varinum (util::ulong v);
+    void put_varinums (const util::ulong * values, size_t count);
 
     void poke_byte (util::byte c, size_t pos)
     {
+        unmap();
         if (pos < m_data.size())
             m_data[pos] = c;
     }
@@ -313,8 +519,38 @@ public:
     void poke_longlong (util::ulonglong value, size_t pos);
 
     bool read (const std::string & infilename);
+    bool read_mapped (const std::string & infilename);
     bool write (const std::string & outfilename);
 
+private:
+
+    /**
+     *  The copy-on-write switch out of mapped mode. Cheap if not mapped.
+     */
+
+    void unmap ()
+    {
+        if (mapped())
+            copy_mapping();
+    }
+
+    void copy_mapping ();
+    void release_mapping ();
+
+    /**
+     *  Appends a value as big-endian bytes with one resize and one store.
+     */
+
+    template <typename T>
+    void put_big (T value)
+    {
+        unmap();
+        size_t sz = m_data.size();
+        m_data.resize(sz + sizeof(T));
+        store_big<T>(value, m_data.data() + sz);
+        m_position += sizeof(T);
+    }
+
 public:
 
     bool set_error (const std::string & msg) const;
@@ -323,6 +559,271 @@ public:
 
 };              // class bytevector
 
+/**
+ *  A checked block of reads from a bytevector. The reads are checked up
+ *  front, by require(), rather than byte by byte:
+ *
+ *      util::bytetransaction t{bv};
+ *      if (t.require(14, "MThd header"))
+ *      {
+ *          tag = t.get_long();
+ *          ...
+ *      }
+ *      if (! t.commit())
+ *          std::cerr << t.error_message();
+ *
+ *  See the cpp file for the rules.
+ */
+
+class bytetransaction
+{
+
+private:
+
+    /**
+     *  The bytevector being read. Its position is moved only by commit().
+     */
+
+    bytevector & m_source;
+    const util::byte * m_data;
+    size_t m_size;
+
+    /**
+     *  The read position, and where the transaction started.
+     */
+
+    size_t m_position;
+    size_t m_start;
+
+    /**
+     *  The first error: where it happened, how many bytes were needed,
+     *  and a static description. The message is built only when asked for.
+     */
+
+    bool m_failed;
+    size_t m_error_offset;
+    size_t m_error_needed;
+    const char * m_error_what;
+
+public:
+
+    explicit bytetransaction (bytevector & source);
+    bytetransaction (const bytetransaction &) = delete;
+    bytetransaction & operator = (const bytetransaction &) = delete;
+    ~bytetransaction () = default;
+
+    bool ok () const
+    {
+        return ! m_failed;
+    }
+
+    size_t position () const
+    {
+        return m_position;
+    }
+
+    size_t remainder () const
+    {
+        return m_size - m_position;
+    }
+
+    size_t error_offset () const
+    {
+        return m_error_offset;
+    }
+
+    /**
+     *  Checks that \a sz more bytes can be read. After the first failure,
+     *  it always fails.
+     */
+
+    bool require (size_t sz, const char * what = nullptr)
+    {
+        if (! m_failed && sz > remainder())
+            fail(what, sz);
+
+        return ! m_failed;
+    }
+
+    bool fail (const char * what, size_t needed = 0);
+
+    /*
+     * Unchecked reads. Each must be covered by a successful require().
+     */
+
+    util::byte get_byte ()
+    {
+        return m_data[m_position++];
+    }
+
+    util::ushort get_short ()
+    {
+        return get_big<util::ushort>();
+    }
+
+    util::ulong get_triple ()
+    {
+        const util::byte * p = m_data + m_position;
+        m_position += 3;
+        return (util::ulong(p[0]) << 16) | (util::ulong(p[1]) << 8) | p[2];
+    }
+
+    util::ulong get_long ()
+    {
+        return get_big<util::ulong>();
+    }
+
+    util::ulonglong get_longlong ()
+    {
+        return get_big<util::ulonglong>();
+    }
+
+    void skip (size_t sz)
+    {
+        m_position += sz;
+    }
+
+    util::ulong get_varinum ();
+    bool commit ();
+    void rollback ();
+    std::string error_message () const;
+
+private:
+
+    template <typename T>
+    T get_big ()
+    {
+        T result = load_big<T>(m_data + m_position);
+        m_position += sizeof(T);
+        return result;
+    }
+
+};              // class bytetransaction
+
+/**
+ *  Writes bytes to a file in large blocks. It can write a whole buffer at
+ *  once, or take the contents of a bytevector segment by segment, so that
+ *  a large output can be built and written piecewise:
+ *
+ *      bytewriter w;
+ *      w.open("big.bin", estimated_size);
+ *      for (...)
+ *      {
+ *          bv.put_long(...);           // etc.
+ *          if (bv.size() > 65536)
+ *              w.flush(bv);            // takes the bytes, empties bv
+ *      }
+ *      w.flush(bv);
+ *      w.close();
+ */
+
+class bytewriter
+{
+
+public:
+
+    /**
+     *  The default amount of queued data that triggers a write.
+     */
+
+    static const size_t default_segment_size = 1024 * 1024;
+
+private:
+
+    std::string m_file_name;
+    std::FILE * m_file;
+
+    /**
+     *  Segments taken from bytevectors by flush(), not yet written.
+     */
+
+    std::vector<util::bytes> m_segments;
+    size_t m_pending;
+    size_t m_segment_size;
+
+    /**
+     *  The number of bytes written so far.
+     */
+
+    size_t m_written;
+
+    /**
+     *  Indicates that the file space was reserved, so the file must be
+     *  trimmed to m_written when closed.
+     */
+
+    bool m_preallocated;
+    std::string m_error_message;
+
+public:
+
+    bytewriter (size_t segmentsize = default_segment_size);
+    bytewriter (const bytewriter &) = delete;
+    bytewriter & operator = (const bytewriter &) = delete;
+    ~bytewriter ();
+
+    bool is_open () const
+    {
+        return not_nullptr(m_file);
+    }
+
+    size_t written () const
+    {
+        return m_written;
+    }
+
+    const std::string & error_message () const
+    {
+        return m_error_message;
+    }
+
+    bool open (const std::string & outfilename, size_t expected = 0);
+    bool write (const util::byte * data, size_t sz);
+    bool flush (bytevector & bv);
+    bool close ();
+
+private:
+
+    bool write_pending ();
+    bool set_error (const std::string & msg);
+
+};              // class bytewriter
+
+/**
+ *  Reads a run of big-endian values of one of the fixed-width types into
+ *  an array, checking the bounds once for the whole run.
+ *
+ * \param destination
+ *      Receives the values. It must hold at least \a count values.
+ *
+ * \param count
+ *      The number of values to read.
+ *
+ * \return
+ *      Returns the number of values read, which is \a count, or 0 if there
+ *      are not enough bytes left. In that case nothing is read and an
+ *      error is set.
+ */
+
+template <typename T>
+size_t
+bytevector::get_array (T * destination, size_t count) const
+{
+    size_t result = 0;
+    if (count <= remainder() / sizeof(T) && not_nullptr(destination))
+    {
+        const byte * p = data() + m_position;
+        for ( ; result < count; ++result, p += sizeof(T))
+            destination[result] = load_big<T>(p);
+
+        m_position += count * sizeof(T);
+    }
+    else if (count > 0 && ! m_disable_reported)
+        (void) set_error_dump("Array extends past end of data");
+
+    return result;
+}
+
 }               // namespace util
 
 #endif          // defined __cplusplus : do not expose to C code
@@ -0,0 +1,280 @@
+#if ! defined CFG66_UTIL_BYTEVIEW_HPP
+#define CFG66_UTIL_BYTEVIEW_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          byteview.hpp
+ *
+ *  This module declares/defines a class for reading big-endian data from
+ *  a range of bytes owned by something else.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include "util/bytevector.hpp"          /* util::bytevector, util::byte     */
+
+namespace util
+{
+
+/**
+ *  A read-only window onto bytes owned by a bytevector (or anything else),
+ *  with its own read position. It provides the get and peek functions of
+ *  bytevector, but copies nothing. The bytes must outlive the view.
+ */
+
+class byteview
+{
+
+private:
+
+    /**
+     *  The first byte of the view, and the number of bytes in it.
+     */
+
+    const util::byte * m_data;
+    size_t m_size;
+
+    /**
+     *  The offset of the view in the buffer it was sliced from, counting
+     *  all the way back to the original buffer. Useful in error messages.
+     */
+
+    size_t m_offset;
+
+    /**
+     *  The read position in the view.
+     */
+
+    size_t m_position;
+
+    /**
+     *  Set if any read ran past the end of the view. It stays set until
+     *  clear_error() is called. Such reads yield 0.
+     */
+
+    bool m_overrun;
+
+public:
+
+    byteview ();
+    byteview (const util::byte * data, size_t sz, size_t offset = 0);
+    explicit byteview (const bytevector & bv);
+    byteview (const bytevector & bv, size_t offset, size_t amount);
+    byteview (const byteview &) = default;
+    byteview & operator = (const byteview &) = default;
+    ~byteview () = default;
+
+    const util::byte * data () const
+    {
+        return m_data;
+    }
+
+    size_t size () const
+    {
+        return m_size;
+    }
+
+    bool empty () const
+    {
+        return m_size == 0;
+    }
+
+    size_t offset () const
+    {
+        return m_offset;
+    }
+
+    size_t position () const
+    {
+        return m_position;
+    }
+
+    size_t real_position () const
+    {
+        return m_offset + m_position;
+    }
+
+    size_t remainder () const
+    {
+        return m_size - m_position;
+    }
+
+    bool overrun () const
+    {
+        return m_overrun;
+    }
+
+    void clear_error ()
+    {
+        m_overrun = false;
+    }
+
+    bool seek (size_t pos)
+    {
+        bool result = pos <= m_size;
+        if (result)
+            m_position = pos;
+
+        return result;
+    }
+
+    void reset ()
+    {
+        m_position = 0;
+    }
+
+    bool skip (size_t sz);
+
+    util::byte get_byte ()
+    {
+        util::byte result = 0;
+        if (m_position < m_size)
+            result = m_data[m_position++];
+        else
+            m_overrun = true;
+
+        return result;
+    }
+
+    util::ushort get_short ()
+    {
+        return get_big<util::ushort>();
+    }
+
+    util::ulong get_long ()
+    {
+        return get_big<util::ulong>();
+    }
+
+    util::ulonglong get_longlong ()
+    {
+        return get_big<util::ulonglong>();
+    }
+
+    util::ulong get_triple ();
+    util::ulong get_varinum ();
+    std::string get_string (size_t len);
+    byteview get_view (size_t len);
+
+    template <typename T>
+    size_t get_array (T * destination, size_t count);
+
+    util::byte peek_byte (size_t offset = 0) const
+    {
+        return offset < remainder() ? m_data[m_position + offset] : 0 ;
+    }
+
+    util::ushort peek_short () const
+    {
+        return peek_big<util::ushort>();
+    }
+
+    util::ulong peek_long () const
+    {
+        return peek_big<util::ulong>();
+    }
+
+    util::ulonglong peek_longlong () const
+    {
+        return peek_big<util::ulonglong>();
+    }
+
+    byteview slice (size_t offset, size_t amount) const;
+    std::string to_string () const;
+
+private:
+
+    /**
+     *  One bounds check, then one unaligned load and byte-swap.
+     */
+
+    template <typename T>
+    T get_big ()
+    {
+        T result = 0;
+        if (remainder() >= sizeof(T))
+        {
+            result = load_big<T>(m_data + m_position);
+            m_position += sizeof(T);
+        }
+        else
+        {
+            m_position = m_size;
+            m_overrun = true;
+        }
+        return result;
+    }
+
+    template <typename T>
+    T peek_big () const
+    {
+        return remainder() >= sizeof(T) ?
+            load_big<T>(m_data + m_position) : T(0) ;
+    }
+
+};          // class byteview
+
+/**
+ *  Reads a run of big-endian values into an array, checking the bounds
+ *  once. Nothing is read if the run does not fit.
+ *
+ * \return
+ *      Returns the number of values read, either \a count or 0.
+ */
+
+template <typename T>
+size_t
+byteview::get_array (T * destination, size_t count)
+{
+    size_t result = 0;
+    if (count <= remainder() / sizeof(T) && not_nullptr(destination))
+    {
+        const util::byte * p = m_data + m_position;
+        for ( ; result < count; ++result, p += sizeof(T))
+            destination[result] = load_big<T>(p);
+
+        m_position += count * sizeof(T);
+    }
+    else if (count > 0)
+        m_overrun = true;
+
+    return result;
+}
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_BYTEVIEW_HPP
+
+/*
+ * byteview.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,120 @@
+#if ! defined CFG66_UTIL_CHARCONV_HPP
+#define CFG66_UTIL_CHARCONV_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          charconv.hpp
+ *
+ *  This module declares/defines conversions between numbers and text that
+ *  do not depend on the locale and do not allocate.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include <cstddef>                      /* std::size_t                      */
+
+#include "util/strview.hpp"             /* util::strview class              */
+
+namespace util
+{
+
+/**
+ *  The ways a conversion can fail.
+ */
+
+enum class convert_error
+{
+    none,           /**< The conversion succeeded.                          */
+    invalid,        /**< The text is not a number, or a bad character.      */
+    out_of_range    /**< Too large for the type, or for the buffer.         */
+};
+
+/**
+ *  The result of from_chars() or to_chars(). For from_chars(),
+ *  \a position is the offset of the first character that is not part of
+ *  the number, or of the character that made the text invalid. For
+ *  to_chars(), it is the number of characters written.
+ */
+
+struct convert_result
+{
+    std::size_t position;
+    convert_error error;
+
+    bool ok () const
+    {
+        return error == convert_error::none;
+    }
+};
+
+/**
+ *  The size of a buffer that holds the output of any to_chars() call with
+ *  the default precision.
+ */
+
+const std::size_t number_chars_max = 32;
+
+/*
+ * Free functions in the util namespace.
+ */
+
+extern convert_result from_chars (strview s, long & value, int base = 10);
+extern convert_result from_chars
+(
+    strview s, unsigned long & value, int base = 10
+);
+extern convert_result from_chars (strview s, int & value, int base = 10);
+extern convert_result from_chars (strview s, double & value);
+extern convert_result from_chars (strview s, float & value);
+extern convert_result to_chars (char * dest, std::size_t sz, long value);
+extern convert_result to_chars
+(
+    char * dest, std::size_t sz, unsigned long value
+);
+extern convert_result to_chars (char * dest, std::size_t sz, int value);
+extern convert_result to_chars
+(
+    char * dest, std::size_t sz, double value, int precision = 0
+);
+extern convert_result to_chars
+(
+    char * dest, std::size_t sz, float value, int precision = 0
+);
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_CHARCONV_HPP
+
+/*
+ * charconv.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,112 @@
+#if ! defined CFG66_UTIL_CHARSCAN_HPP
+#define CFG66_UTIL_CHARSCAN_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          charscan.hpp
+ *
+ *  This module declares/defines a small set of characters that can be
+ *  searched for many bytes at a time.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include <cstddef>                      /* std::size_t                      */
+
+namespace util
+{
+
+/**
+ *  A set of delimiter characters, such as CFG66_TRIM_CHARS, made once and
+ *  then used to find the first byte in (or not in) the set.
+ */
+
+class charset
+{
+
+public:
+
+    /**
+     *  Sets with more characters than this are searched a byte at a time.
+     */
+
+    static const int simd_max = 16;
+
+private:
+
+    /**
+     *  The distinct characters of the set, for the vector compares, and a
+     *  bit per byte value, for the byte-at-a-time search.
+     */
+
+    unsigned char m_chars[simd_max];
+    int m_count;
+    unsigned long long m_bits[4];
+
+public:
+
+    charset (const char * chars, std::size_t count);
+    charset (const charset &) = default;
+    charset & operator = (const charset &) = default;
+    ~charset () = default;
+
+    bool contains (char c) const
+    {
+        unsigned char b = static_cast<unsigned char>(c);
+        return ((m_bits[b >> 6] >> (b & 63)) & 1) != 0;
+    }
+
+    int count () const
+    {
+        return m_count;
+    }
+
+    const unsigned char * chars () const
+    {
+        return m_chars;
+    }
+
+    std::size_t find_first_of (const char * data, std::size_t sz) const;
+    std::size_t find_first_not_of (const char * data, std::size_t sz) const;
+
+};              // class charset
+
+extern const char * charscan_method ();
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_CHARSCAN_HPP
+
+/*
+ * charscan.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
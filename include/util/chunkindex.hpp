@@ -0,0 +1,152 @@
+#if ! defined CFG66_UTIL_CHUNKINDEX_HPP
+#define CFG66_UTIL_CHUNKINDEX_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          chunkindex.hpp
+ *
+ *  This module declares/defines an index of the chunks of a tagged-length
+ *  container, such as a MIDI file.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include "util/byteview.hpp"            /* util::byteview, util::bytevector */
+
+namespace util
+{
+
+/**
+ *  Walks a container made of chunks, each a 4-byte tag and a 4-byte
+ *  big-endian length followed by the data, and records where each chunk
+ *  is. Any chunk can then be opened as a byteview of its data.
+ */
+
+class chunkindex
+{
+
+public:
+
+    /**
+     *  One chunk. The offset is that of the chunk's data, just past its
+     *  8-byte header, relative to the start of the scanned bytes.
+     */
+
+    class chunk
+    {
+    public:
+
+        util::ulong chunk_tag;
+        size_t chunk_offset;
+        size_t chunk_length;
+    };
+
+    using chunklist = std::vector<chunk>;
+
+private:
+
+    /**
+     *  The bytes that were scanned. The index does not own them.
+     */
+
+    byteview m_data;
+
+    /**
+     *  The chunks, in file order.
+     */
+
+    chunklist m_chunks;
+
+    /**
+     *  Set if the last chunk claims more bytes than there are, or there are
+     *  stray bytes too short to be a chunk header. The last chunk's length
+     *  is cut to the bytes available.
+     */
+
+    bool m_truncated;
+
+public:
+
+    chunkindex ();
+    chunkindex (const chunkindex &) = default;
+    chunkindex & operator = (const chunkindex &) = default;
+    ~chunkindex () = default;
+
+    static util::ulong make_tag (const std::string & tag);
+    static std::string tag_name (util::ulong tag);
+
+    bool scan (const byteview & data, bool padeven = false);
+
+    bool scan (const bytevector & bv, bool padeven = false)
+    {
+        return scan(byteview(bv), padeven);
+    }
+
+    size_t count () const
+    {
+        return m_chunks.size();
+    }
+
+    bool truncated () const
+    {
+        return m_truncated;
+    }
+
+    const chunklist & chunks () const
+    {
+        return m_chunks;
+    }
+
+    int find (util::ulong tag, int nth = 0) const;
+
+    int find (const std::string & tag, int nth = 0) const
+    {
+        return find(make_tag(tag), nth);
+    }
+
+    byteview view (int index) const;
+
+    byteview view (const std::string & tag, int nth = 0) const
+    {
+        return view(find(tag, nth));
+    }
+
+};          // class chunkindex
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_CHUNKINDEX_HPP
+
+/*
+ * chunkindex.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,131 @@
+#if ! defined CFG66_UTIL_HASH64_HPP
+#define CFG66_UTIL_HASH64_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          hash64.hpp
+ *
+ *  This module declares/defines a fast 64-bit hash of data, files, and
+ *  strings, for detecting changes.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include <cstddef>                      /* std::size_t                      */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <string>                       /* std::string                      */
+
+#include "util/strview.hpp"             /* util::strview class              */
+
+namespace util
+{
+
+/**
+ *  A hash computed a piece at a time. Feeding the same bytes in any number
+ *  of pieces gives the same digest as hash_bytes() of them all.
+ */
+
+class hash64
+{
+
+public:
+
+    using value_type = std::uint64_t;
+
+    /**
+     *  Data is hashed in stripes of this many bytes.
+     */
+
+    static const std::size_t stripe_size = 32;
+
+private:
+
+    /**
+     *  The four lanes of the hash of the whole stripes so far.
+     */
+
+    value_type m_lanes[4];
+
+    /**
+     *  The bytes of a partial stripe, and how many there are.
+     */
+
+    unsigned char m_buffer[stripe_size];
+    std::size_t m_buffered;
+
+    /**
+     *  The total number of bytes, and the seed, which are part of the
+     *  digest.
+     */
+
+    value_type m_total;
+    value_type m_seed;
+
+public:
+
+    hash64 (value_type seed = 0);
+    hash64 (const hash64 &) = default;
+    hash64 & operator = (const hash64 &) = default;
+    ~hash64 () = default;
+
+    void reset (value_type seed = 0);
+    void update (const void * data, std::size_t sz);
+    void update_field (strview s);
+    value_type digest () const;
+
+    void update (strview s)
+    {
+        update(s.data(), s.size());
+    }
+
+};              // class hash64
+
+/*
+ * Free functions in the util namespace.
+ */
+
+extern std::uint64_t hash_bytes
+(
+    const void * data, std::size_t sz, std::uint64_t seed = 0
+);
+extern std::uint64_t hash_string (strview s, std::uint64_t seed = 0);
+extern bool hash_file (const std::string & filename, std::uint64_t & result);
+extern std::string hash_to_string (std::uint64_t h);
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_HASH64_HPP
+
+/*
+ * hash64.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
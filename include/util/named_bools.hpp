@@ -27,15 +27,24 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2021-09-13
- * \updates       2022-07-01
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  This seems to be much easier for small sets of booleans that using an
  *  enumeration.
+ *
+ *  The atomic_named_bools class is a variant for flags that are checked
+ *  often, and from more than one thread. See the cpp file.
  */
 
+#include <array>                        /* std::array container class       */
+#include <atomic>                       /* std::atomic<> template           */
+#include <cstdint>                      /* std::uint64_t                    */
+#include <initializer_list>             /* std::initializer_list<>          */
 #include <map>                          /* std::map container class         */
+#include <mutex>                        /* std::mutex, std::lock_guard<>    */
 #include <string>                       /* std::string class                */
+#include <vector>                       /* std::vector class                */
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -102,6 +111,167 @@ public:
 
 };          // class named_bools
 
+/**
+ *  A set of up to 256 named booleans, kept as bits in atomic words. A name
+ *  is looked up once, when it is registered, to get a handle (the index of
+ *  its bit). After that, get() and set() by handle are single atomic
+ *  operations, with no lock and no string comparison.
+ */
+
+class atomic_named_bools
+{
+
+public:
+
+    using handle = int;
+    using word = std::uint64_t;
+
+    static const int word_bits = 64;
+    static const int word_count = 4;
+    static const int capacity = word_bits * word_count;
+    static const handle invalid = -1;
+
+    /**
+     *  A plain copy of all the flags, taken by snapshot(). It is also used
+     *  as a mask of many flags, made by mask().
+     */
+
+    class bits
+    {
+        friend class atomic_named_bools;
+
+    private:
+
+        std::array<word, word_count> m_words;
+
+    public:
+
+        bits () : m_words ()
+        {
+            // no code
+        }
+
+        bool get (handle h) const
+        {
+            return valid(h) ?
+                ((m_words[h / word_bits] >> (h % word_bits)) & 1) != 0 :
+                false ;
+        }
+
+        void set (handle h, bool value = true)
+        {
+            if (valid(h))
+            {
+                word bit = word(1) << (h % word_bits);
+                if (value)
+                    m_words[h / word_bits] |= bit;
+                else
+                    m_words[h / word_bits] &= ~bit;
+            }
+        }
+
+        bool operator == (const bits & rhs) const
+        {
+            return m_words == rhs.m_words;
+        }
+
+        bool operator != (const bits & rhs) const
+        {
+            return m_words != rhs.m_words;
+        }
+
+    };
+
+private:
+
+    /**
+     *  The flags. Bit h % 64 of word h / 64 is the flag with handle h.
+     */
+
+    std::array<std::atomic<word>, word_count> m_words;
+
+    /**
+     *  The registered names and their handles. These are used only by
+     *  registration and by lookups by name, under m_name_lock.
+     */
+
+    std::map<std::string, handle> m_handles;
+    std::vector<std::string> m_names;
+    mutable std::mutex m_name_lock;
+
+public:
+
+    atomic_named_bools ();
+    atomic_named_bools (const atomic_named_bools &) = delete;
+    atomic_named_bools & operator = (const atomic_named_bools &) = delete;
+    ~atomic_named_bools () = default;
+
+    static bool valid (handle h)
+    {
+        return h >= 0 && h < capacity;
+    }
+
+    handle add (const std::string & name, bool value = false);
+    handle find (const std::string & name) const;
+    std::string name (handle h) const;
+    int count () const;
+    void clear ();
+
+    /**
+     *  Gets a flag by handle. Lock-free.
+     */
+
+    bool get (handle h) const
+    {
+        return valid(h) ?
+            ((m_words[h / word_bits].load(std::memory_order_acquire) >>
+                (h % word_bits)) & 1) != 0 :
+            false ;
+    }
+
+    /**
+     *  Sets a flag by handle. Lock-free.
+     *
+     * \return
+     *      Returns the previous value of the flag.
+     */
+
+    bool set (handle h, bool value = true)
+    {
+        bool result = false;
+        if (valid(h))
+        {
+            word bit = word(1) << (h % word_bits);
+            std::atomic<word> & w = m_words[h / word_bits];
+            word old = value ?
+                w.fetch_or(bit, std::memory_order_acq_rel) :
+                w.fetch_and(~bit, std::memory_order_acq_rel) ;
+
+            result = (old & bit) != 0;
+        }
+        return result;
+    }
+
+    /**
+     *  Lookups by name, as in named_bools. These take the name lock; use
+     *  handles in hot code.
+     */
+
+    bool get (const std::string & name) const
+    {
+        return get(find(name));
+    }
+
+    bool set (const std::string & name, bool value = true);
+
+    bits mask (std::initializer_list<handle> handles) const;
+    bits snapshot () const;
+    bool all (const bits & m) const;
+    bool any (const bits & m) const;
+    void set (const bits & m, bool value = true);
+
+};          // class atomic_named_bools
+
 }           // namespace util
 
 #endif      // CFG66_UTIL_NAMED_BOOLS_HPP
@@ -27,7 +27,7 @@
  *
  * \author        Chris Ahlstrom
  * \date          2018-11-23
- * \updates       2025-02-13
+ * \updates       2026-10-18
  * \version       $Revision$
  *
  *    Also see the strfunctions.cpp module.
@@ -51,6 +51,7 @@
  */
 
 #include "cpp_types.hpp"                /* std::string, tokenization alias  */
+#include "util/strview.hpp"             /* util::strview, util::strviews    */
 
 #if ! defined CFG66_STRING_FORMAT_FUNCTION
 #define CFG66_STRING_FORMAT_FUNCTION
@@ -212,6 +213,7 @@ extern double string_to_double
 );
 extern bool is_floating_string (const std::string & value);
 extern std::string double_to_string(double value, int precision = 0);
+extern std::string float_to_string (float value, int precision = 0);
 extern float string_to_float
 (
     const std::string & s, float defalt = 0.0, int rounding = 0
@@ -278,6 +280,188 @@ extern std::string first_sentence
 extern int count_character (const std::string & s, char target = '\n');
 extern bool target_terminated (const std::string & s, char target = '\n');
 
+/*--------------------------------------------------------------------------
+ * Overloads that take and return views, and so do not allocate. Passing a
+ * std::string still calls the functions above, and passing a C string
+ * calls the overloads below.
+ *--------------------------------------------------------------------------*/
+
+extern bool is_empty_string (strview item);
+extern strview strip_comments (strview item);
+extern strview strip_quotes (strview item);
+extern bool strcompare (strview a, strview b);
+extern bool strncompare (strview a, strview b, size_t n = 0);
+extern bool strcasecompare (strview a, strview b);
+extern strview ltrim (strview str, strview chars = CFG66_TRIM_CHARS);
+extern strview rtrim (strview str, strview chars = CFG66_TRIM_CHARS);
+extern strview trim (strview str, strview chars = CFG66_TRIM_CHARS);
+extern bool string_to_bool (strview s, bool defalt = false);
+extern bool string_to_int_pair
+(
+    strview s,
+    int & v1, int & v2,
+    strview delimiter = " "
+);
+extern double string_to_double
+(
+    strview s,
+    double defalt = 0.0,
+    int rounding = 0
+);
+extern float string_to_float
+(
+    strview s, float defalt = 0.0, int rounding = 0
+);
+extern long string_to_long (strview s, long defalt = 0L);
+extern unsigned long string_to_unsigned_long
+(
+    strview s, unsigned long defalt = 0UL
+);
+extern unsigned string_to_unsigned (strview s, unsigned defalt = 0U);
+extern int string_to_int (strview s, int defalt = 0);
+extern bool string_not_void (strview s);
+extern bool string_is_void (strview s);
+extern bool strings_match (strview target, strview x);
+extern size_t tokenize
+(
+    strviews & tokens,
+    strview source,
+    strview delimiters = " \t"
+);
+extern size_t tokenize_quoted (strviews & tokens, strview source);
+extern int tokenize_stanzas
+(
+    strviews & tokens,
+    strview source,
+    strview::size_type bleft = 0,
+    strview brackets = strview()
+);
+
+/*--------------------------------------------------------------------------
+ * Overloads for C strings. A string literal converts equally well to
+ * std::string and to strview, so without these a call such as trim("x")
+ * would be ambiguous. They give the same results as the std::string
+ * functions, without making a temporary std::string.
+ *--------------------------------------------------------------------------*/
+
+inline bool
+is_empty_string (const char * item)
+{
+    return is_empty_string(strview(item));
+}
+
+inline std::string
+strip_comments (const char * item)
+{
+    return strip_comments(strview(item)).to_string();
+}
+
+inline std::string
+strip_quotes (const char * item)
+{
+    return strip_quotes(strview(item)).to_string();
+}
+
+inline bool
+strcompare (const char * a, const char * b)
+{
+    return strcompare(strview(a), strview(b));
+}
+
+inline bool
+strncompare (const char * a, const char * b, size_t n = 0)
+{
+    return strncompare(strview(a), strview(b), n);
+}
+
+inline bool
+strcasecompare (const char * a, const char * b)
+{
+    return strcasecompare(strview(a), strview(b));
+}
+
+inline std::string
+trim (const char * str, const std::string & chars = CFG66_TRIM_CHARS)
+{
+    return trim(strview(str), strview(chars)).to_string();
+}
+
+inline bool
+string_to_bool (const char * s, bool defalt = false)
+{
+    return string_to_bool(strview(s), defalt);
+}
+
+/*
+ *  The std::string version of string_to_int_pair() does not call the
+ *  strview version, so this one calls it, to keep its results.
+ */
+
+inline bool
+string_to_int_pair
+(
+    const char * s,
+    int & v1, int & v2,
+    const std::string & delimiter = " "
+)
+{
+    return string_to_int_pair(std::string(s), v1, v2, delimiter);
+}
+
+inline double
+string_to_double (const char * s, double defalt = 0.0, int rounding = 0)
+{
+    return string_to_double(strview(s), defalt, rounding);
+}
+
+inline float
+string_to_float (const char * s, float defalt = 0.0, int rounding = 0)
+{
+    return string_to_float(strview(s), defalt, rounding);
+}
+
+inline long
+string_to_long (const char * s, long defalt = 0L)
+{
+    return string_to_long(strview(s), defalt);
+}
+
+inline unsigned long
+string_to_unsigned_long (const char * s, unsigned long defalt = 0UL)
+{
+    return string_to_unsigned_long(strview(s), defalt);
+}
+
+inline unsigned
+string_to_unsigned (const char * s, unsigned defalt = 0U)
+{
+    return string_to_unsigned(strview(s), defalt);
+}
+
+inline int
+string_to_int (const char * s, int defalt = 0)
+{
+    return string_to_int(strview(s), defalt);
+}
+
+inline bool
+string_not_void (const char * s)
+{
+    return string_not_void(strview(s));
+}
+
+inline bool
+string_is_void (const char * s)
+{
+    return string_is_void(strview(s));
+}
+
+inline bool
+strings_match (const char * target, const char * x)
+{
+    return strings_match(strview(target), strview(x));
+}
+
 /*--------------------------------------------------------------------------
  * Functions that support nsm66. From NSM's file module.
  *--------------------------------------------------------------------------*/
@@ -0,0 +1,215 @@
+#if ! defined CFG66_UTIL_STRVIEW_HPP
+#define CFG66_UTIL_STRVIEW_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          strview.hpp
+ *
+ *  This module declares/defines a read-only view of characters owned by a
+ *  string or a buffer.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include <cstring>                      /* std::strlen(), std::memcmp()     */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "c_macros.h"                   /* not_nullptr() macro              */
+#include "util/charscan.hpp"            /* util::charset class              */
+
+namespace util
+{
+
+/**
+ *  A pointer and a length, with the find functions of std::string. It is
+ *  much like the C++17 std::string_view, which cfg66 cannot yet require.
+ *  The characters must outlive the view.
+ */
+
+class strview
+{
+
+public:
+
+    using size_type = std::string::size_type;
+    using const_iterator = const char *;
+
+    static const size_type npos = std::string::npos;
+
+private:
+
+    const char * m_data;
+    size_type m_size;
+
+public:
+
+    strview () : m_data (""), m_size (0)
+    {
+        // no code
+    }
+
+    strview (const char * s, size_type sz) : m_data (s), m_size (sz)
+    {
+        // no code
+    }
+
+    strview (const char * s) :
+        m_data  (not_nullptr(s) ? s : ""),
+        m_size  (not_nullptr(s) ? std::strlen(s) : 0)
+    {
+        // no code
+    }
+
+    strview (const std::string & s) : m_data (s.data()), m_size (s.size())
+    {
+        // no code
+    }
+
+    strview (const strview &) = default;
+    strview & operator = (const strview &) = default;
+    ~strview () = default;
+
+    const char * data () const
+    {
+        return m_data;
+    }
+
+    size_type size () const
+    {
+        return m_size;
+    }
+
+    size_type length () const
+    {
+        return m_size;
+    }
+
+    bool empty () const
+    {
+        return m_size == 0;
+    }
+
+    char operator [] (size_type i) const
+    {
+        return m_data[i];
+    }
+
+    char front () const
+    {
+        return m_data[0];
+    }
+
+    char back () const
+    {
+        return m_data[m_size - 1];
+    }
+
+    const_iterator begin () const
+    {
+        return m_data;
+    }
+
+    const_iterator end () const
+    {
+        return m_data + m_size;
+    }
+
+    void remove_prefix (size_type n)
+    {
+        m_data += n;
+        m_size -= n;
+    }
+
+    void remove_suffix (size_type n)
+    {
+        m_size -= n;
+    }
+
+    std::string to_string () const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    bool starts_with (strview s) const
+    {
+        return s.m_size <= m_size &&
+            std::memcmp(m_data, s.m_data, s.m_size) == 0;
+    }
+
+    strview substr (size_type pos, size_type n = npos) const;
+    int compare (strview s) const;
+    size_type find (char c, size_type pos = 0) const;
+    size_type find (strview s, size_type pos = 0) const;
+    size_type find_first_of (strview chars, size_type pos = 0) const;
+    size_type find_first_not_of (strview chars, size_type pos = 0) const;
+    size_type find_last_of (strview chars, size_type pos = npos) const;
+    size_type find_last_not_of (strview chars, size_type pos = npos) const;
+
+    size_type find_first_of (const charset & cs, size_type pos = 0) const;
+    size_type find_first_not_of (const charset & cs, size_type pos = 0) const;
+
+    size_type find_first_of (char c, size_type pos = 0) const
+    {
+        return find(c, pos);
+    }
+
+};              // class strview
+
+/**
+ *  A list of views, such as the tokens of a line. Reusing one list for each
+ *  line keeps its storage, so that tokenizing does not allocate.
+ */
+
+using strviews = std::vector<strview>;
+
+inline bool
+operator == (strview a, strview b)
+{
+    return a.size() == b.size() &&
+        (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool
+operator != (strview a, strview b)
+{
+    return ! (a == b);
+}
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_STRVIEW_HPP
+
+/*
+ * strview.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
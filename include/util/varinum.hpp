@@ -0,0 +1,80 @@
+#if ! defined CFG66_UTIL_VARINUM_HPP
+#define CFG66_UTIL_VARINUM_HPP
+
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          varinum.hpp
+ *
+ *  This module declares functions to decode and encode runs of MIDI
+ *  variable-length quantities.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Documented in the cpp file.
+ */
+
+#if defined __cplusplus                 /* do not expose this to C code     */
+
+#include "util/bytevector.hpp"          /* util::byte, util::ulong          */
+
+namespace util
+{
+
+/**
+ *  The longest varinum accepted by the batch decoder, in bytes. Four
+ *  bytes hold 28 bits, the MIDI maximum of 0x0FFFFFFF. The encoder can
+ *  need one more byte for values above that, as put_varinum() does.
+ */
+
+const size_t c_varinum_max_bytes = 4;
+const size_t c_varinum_encode_max = 5;
+
+extern bool decode_varinums
+(
+    const util::byte * data,
+    size_t sz,
+    util::ulong * destination,
+    size_t & count,
+    size_t & consumed
+);
+extern size_t encode_varinums
+(
+    const util::ulong * values,
+    size_t count,
+    util::byte * destination
+);
+extern size_t varinum_size (util::ulong value);
+
+}           // namespace util
+
+#endif      // defined __cplusplus : do not expose to C code
+
+#endif      // CFG66_UTIL_VARINUM_HPP
+
+/*
+ * varinum.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-11-23
- * \updates       2024-09-27
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  std::streamoff is a signed integral type (usually long long) that can
@@ -53,6 +53,7 @@
 #include "cfg/appinfo.hpp"              /* informational functions          */
 #include "cfg/configfile.hpp"           /* cfg::configfile class            */
 #include "util/filefunctions.hpp"       /* util::filename_base() etc.       */
+#include "util/hash64.hpp"              /* util::hash_file()                */
 #include "util/msgfunctions.hpp"        /* util::error_message() etc.       */
 
 /*
@@ -110,6 +111,7 @@ configfile::configfile
     m_file_name     (filename),
     m_version       ("0"),
     m_file_version  ("0"),
+    m_file_fingerprint (0),
     m_line          (),
     m_line_number   (0),
     m_line_position      (0)
@@ -350,8 +352,14 @@ configfile::get_line (std::ifstream & file, bool strip)
     (void) std::getline(file, m_line);
     if (strip)
     {
-        m_line = util::trim(m_line);
-        m_line = util::strip_comments(m_line);
+        /*
+         * Trim the line in place. strip_comments() also trims white space.
+         */
+
+        util::strview v = util::strip_comments(util::strview(m_line));
+        auto start = std::string::size_type(v.data() - m_line.data());
+        m_line.erase(start + v.size());
+        m_line.erase(0, start);
     }
 
     bool result = file.good();
@@ -587,42 +595,39 @@ configfile::extract_variable
     bool partial
 )
 {
+    static const util::charset s_name_end{" =", 2};
     std::string result = util::questionable_string();
-    auto epos = line.find_first_of("=");
-    if (epos != std::string::npos)
+    util::strview v{line};
+    auto spos = v.find_first_of(s_name_end);        /* Check-point 1        */
+    if (spos != util::strview::npos)
     {
-        auto spos = line.find_first_of(" ");        /* Check-point 1        */
-        if (spos > epos)
-            spos = epos;
-
-        std::string vname = line.substr(0, spos);
-        bool ok = partial ?
-            util::strings_match(vname, variablename) : vname == variablename ;
-
-        if (ok)
+        auto epos = v[spos] == '=' ? spos : v.find('=', spos + 1) ;
+        if (epos != util::strview::npos)
         {
-            bool havequotes = false;                /* Check-point 2        */
-            char quotechar[2] = { 'x', 0 };
-            auto qpos = line.find_first_of("\"", epos + 1);
-            auto qpos2 = std::string::npos;
-            if (qpos != std::string::npos)
-            {
-                quotechar[0] = line[qpos];
-                qpos2 = line.find_first_of(quotechar, qpos + 1);
-                if (qpos2 != std::string::npos)
-                    havequotes = true;
-            }
-            if (havequotes)
-            {
-                result = line.substr(qpos + 1, qpos2 - qpos - 1);
-            }
-            else
+            util::strview vname = v.substr(0, spos);
+            bool ok = partial ?
+                util::strings_match(vname, util::strview(variablename)) :
+                vname == variablename ;
+
+            if (ok)
             {
-                spos = line.find_first_not_of(" ", epos + 1);
-                if (spos != std::string::npos)
+                auto qpos = v.find('"', epos + 1);  /* Check-point 2        */
+                auto qpos2 = util::strview::npos;
+                if (qpos != util::strview::npos)
+                    qpos2 = v.find('"', qpos + 1);
+
+                if (qpos2 != util::strview::npos)
                 {
-                    epos = line.find_first_of(" ", spos);
-                    result = line.substr(spos, epos-spos);
+                    result = v.substr(qpos + 1, qpos2 - qpos - 1).to_string();
+                }
+                else
+                {
+                    spos = v.find_first_not_of(" ", epos + 1);
+                    if (spos != util::strview::npos)
+                    {
+                        epos = v.find(' ', spos);
+                        result = v.substr(spos, epos - spos).to_string();
+                    }
                 }
             }
         }
@@ -777,7 +782,7 @@ configfile::write_integer
     if (usehex)
         file << name << " = 0x" << std::hex << std::setw(2) << value << "\n";
     else
-        file << name << " = " << value << "\n";
+        file << name << " = " << util::int_to_string(value) << "\n";
 }
 
 /**
@@ -798,7 +803,7 @@ configfile::get_float
     if (! util::is_missing_string(value))               /* ! value.empty()  */
     {
         result = value == "default" ?
-            sm_float_default : float(util::string_to_double(value)) ;
+            sm_float_default : util::string_to_float(value) ;
     }
     return result;
 }
@@ -811,7 +816,7 @@ configfile::write_float
     float value
 )
 {
-    file << name << " = " << value << "\n";
+    file << name << " = " << util::float_to_string(value) << "\n";
 }
 
 /**
@@ -1269,6 +1274,46 @@ configfile::set_up_ifstream (std::ifstream & instream)
     return result;
 }
 
+/**
+ *  Hashes the file as it is now on disk, and keeps the hash. A derived
+ *  class calls this after parsing or writing the file.
+ *
+ * \return
+ *      Returns false, and clears the fingerprint, if the file could not be
+ *      read.
+ */
+
+bool
+configfile::update_file_fingerprint ()
+{
+    std::uint64_t h = 0;
+    bool result = util::hash_file(file_name(), h);
+    m_file_fingerprint = result ? h : 0 ;
+    return result;
+}
+
+/**
+ *  Checks whether the file on disk differs from the file as last parsed or
+ *  written, such as after an edit by the user or another program. A reload
+ *  can then be skipped if it does not. This costs one read of the file,
+ *  but no parsing or comparing of text.
+ *
+ * \return
+ *      Returns true if the contents differ, if the file cannot be read, or
+ *      if there is no fingerprint to compare to.
+ */
+
+bool
+configfile::file_changed () const
+{
+    std::uint64_t h = 0;
+    bool result = m_file_fingerprint == 0;
+    if (! result)
+        result = ! util::hash_file(file_name(), h) || h != m_file_fingerprint;
+
+    return result;
+}
+
 /**
  *  Verifies that the string is of the form "[xyz]".
  */
@@ -0,0 +1,565 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          deltahistory.cpp
+ *
+ *  This module defines an undo/redo mechanism for cfg::options that stores
+ *  only the changes between steps.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  history<options> stores a full copy of the options, descriptions and
+ *  all, for every step. delta_history stores, for every step, only the
+ *  (name, old value, new value) of each option that changed. Using the
+ *  steps of the history.cpp banner, with a checkpoint interval of 2:
+ *
+\verbatim
+        1.  [C0]                        Step #1 (initial state, checkpoint)
+        2.  [C0]--[d1]                  Step #2 (first change)
+        3.  [C0]--[d1]--[C2]            Step #3 (second change, checkpoint)
+        4.  [C0]--[d1]--[C2]            Step #4 (undo: revert d2)
+        5.  [C0]--[d1]--[C2]            Step #5 (redo: apply d2)
+        6.  [C0]--[d1]--[C2]--[d3]      Step #6 (third change)
+        7.  [C1]--[C2]--[d3]--[d4]      Step #7 (fourth change, pop-front)
+\endverbatim
+ *
+ *  The current options are always kept in full, so undo and redo only
+ *  revert or apply the changes of one step. The checkpoints bound the work
+ *  needed by get() to rebuild an arbitrary step. When the first step is
+ *  popped, the second one is turned into a checkpoint, so the first step
+ *  is always a full copy.
+ *
+ *  If options are added or removed between two steps, the step is stored
+ *  as a checkpoint, and undoing it rebuilds the previous step.
+ *
+ *  As in history<>, adding a step after some undos discards the steps
+ *  that could have been redone.
+ */
+
+#include <sstream>                      /* std::ostringstream for testing   */
+
+#include "cfg/deltahistory.hpp"         /* cfg::delta_history class         */
+
+namespace cfg
+{
+
+/*--------------------------------------------------------------------------
+ * options_delta
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  An empty step. The checkpoint options are created without the stock
+ *  options, to keep the step small.
+ */
+
+options_delta::options_delta () :
+    m_changes       (),
+    m_has_changes   (false),
+    m_is_checkpoint (false),
+    m_checkpoint    (false)
+{
+    // no other code
+}
+
+/**
+ *  A full step, as used for the first step of a history.
+ */
+
+options_delta::options_delta (const options & full) :
+    m_changes       (),
+    m_has_changes   (false),
+    m_is_checkpoint (true),
+    m_checkpoint    (full)
+{
+    // no other code
+}
+
+/**
+ *  A step holding the changes from one set of options to another. If the
+ *  two sets do not hold the same options, then the step is a checkpoint
+ *  instead.
+ */
+
+options_delta::options_delta (const options & before, const options & after) :
+    m_changes       (),
+    m_has_changes   (same_layout(before, after)),
+    m_is_checkpoint (false),
+    m_checkpoint    (false)
+{
+    if (m_has_changes)
+    {
+        auto bit = before.option_pairs().cbegin();
+        for (const auto & op : after.option_pairs())
+        {
+            const options::spec & b = bit->second;
+            const options::spec & a = op.second;
+            if
+            (
+                b.option_value != a.option_value ||
+                b.option_modified != a.option_modified
+            )
+            {
+                change c
+                {
+                    op.first, b.option_value, a.option_value,
+                    b.option_modified, a.option_modified
+                };
+                m_changes.push_back(c);
+            }
+            ++bit;
+        }
+    }
+    else
+        make_checkpoint(after);
+}
+
+void
+options_delta::make_checkpoint (const options & full)
+{
+    m_checkpoint = full;
+    m_is_checkpoint = true;
+}
+
+void
+options_delta::drop_checkpoint ()
+{
+    m_checkpoint = options(false);
+    m_is_checkpoint = false;
+}
+
+/**
+ *  Indicates if two sets of options hold the same option names and come
+ *  from the same file and section. Only then can one be changed into the
+ *  other by changing values.
+ */
+
+bool
+options_delta::same_layout (const options & a, const options & b)
+{
+    bool result =
+        a.size() == b.size() &&
+        a.source_file() == b.source_file() &&
+        a.source_section() == b.source_section();
+
+    if (result)
+    {
+        auto bit = b.option_pairs().cbegin();
+        for (const auto & op : a.option_pairs())
+        {
+            if (op.first != bit->first)
+            {
+                result = false;
+                break;
+            }
+            ++bit;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Changes the target from the previous step to this step.
+ *
+ * \param [inout] target
+ *      The options of the previous step. If this step has no changes, but
+ *      is a checkpoint, the target is replaced by the checkpoint.
+ *
+ * \return
+ *      Returns false if the step could not be applied.
+ */
+
+bool
+options_delta::apply (options & target) const
+{
+    bool result = m_has_changes;
+    if (result)
+    {
+        options::container & pairs = target.option_pairs();
+        for (const auto & c : m_changes)
+        {
+            auto it = pairs.find(c.change_name);
+            result = it != pairs.end();
+            if (result)
+            {
+                it->second.option_value = c.change_new_value;
+                it->second.option_modified = c.change_new_modified;
+            }
+            else
+                break;
+        }
+    }
+    else if (m_is_checkpoint)
+    {
+        target = m_checkpoint;
+        result = true;
+    }
+    return result;
+}
+
+/**
+ *  Changes the target from this step back to the previous step.
+ *
+ * \return
+ *      Returns false if the step has no changes to revert, in which case
+ *      the previous step must be rebuilt from a checkpoint.
+ */
+
+bool
+options_delta::revert (options & target) const
+{
+    bool result = m_has_changes;
+    if (result)
+    {
+        options::container & pairs = target.option_pairs();
+        for (const auto & c : m_changes)
+        {
+            auto it = pairs.find(c.change_name);
+            result = it != pairs.end();
+            if (result)
+            {
+                it->second.option_value = c.change_old_value;
+                it->second.option_modified = c.change_old_modified;
+            }
+            else
+                break;
+        }
+    }
+    return result;
+}
+
+/*--------------------------------------------------------------------------
+ * delta_history
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  Default constructor. Uses the same maximum size as history<>.
+ */
+
+delta_history::delta_history () :
+    m_delta_list            (),
+    m_max_size              (32),
+    m_checkpoint_interval   (16),
+    m_since_checkpoint      (0),
+    m_present               (0),
+    m_current               (false),
+    m_rebuilt               (false)
+{
+    // no other code
+}
+
+delta_history::delta_history (size_t maximum, size_t interval) :
+    m_delta_list            (),
+    m_max_size              (maximum),
+    m_checkpoint_interval   (interval),
+    m_since_checkpoint      (0),
+    m_present               (0),
+    m_current               (false),
+    m_rebuilt               (false)
+{
+    // no other code
+}
+
+delta_history::delta_history
+(
+    size_t maximum, const options & firstone, size_t interval
+) :
+    m_delta_list            (),
+    m_max_size              (maximum),
+    m_checkpoint_interval   (interval),
+    m_since_checkpoint      (0),
+    m_present               (0),
+    m_current               (false),
+    m_rebuilt               (false)
+{
+    (void) add(firstone);
+}
+
+/**
+ *  Adds a step after the current step. Any steps that could have been
+ *  redone are discarded first.
+ *
+ * \return
+ *      Returns true if no step needed to be popped.
+ */
+
+bool
+delta_history::add (const options & opts)
+{
+    bool result = true;
+    if (active())
+    {
+        while (m_delta_list.size() > m_present + 1)
+            m_delta_list.pop_back();
+
+        result = m_delta_list.size() < m_max_size;
+        if (! result)
+            result = ! pop();           /* should never be false, though    */
+
+        recount_since_checkpoint();     /* redo steps or a pop may be gone  */
+
+        options_delta d{m_current, opts};
+        ++m_since_checkpoint;
+        if (d.checkpoint())
+        {
+            m_since_checkpoint = 0;
+        }
+        else if
+        (
+            m_checkpoint_interval > 0 &&
+            m_since_checkpoint >= m_checkpoint_interval
+        )
+        {
+            d.make_checkpoint(opts);
+            m_since_checkpoint = 0;
+        }
+        m_delta_list.push_back(std::move(d));
+        m_present = m_delta_list.size() - 1;
+    }
+    else
+    {
+        m_delta_list.push_back(options_delta{opts});
+        m_present = 0;
+        m_since_checkpoint = 0;
+    }
+    m_current = opts;
+    return result;
+}
+
+/**
+ *  Removes the first step, first making the second step a checkpoint so
+ *  that the history still starts with full options.
+ */
+
+bool
+delta_history::pop ()
+{
+    bool result = active();
+    if (result)
+    {
+        if (m_delta_list.size() > 1)
+        {
+            const options_delta & first = m_delta_list[0];
+            options_delta & second = m_delta_list[1];
+            if (! second.checkpoint())
+            {
+                options full = first.get_checkpoint();
+                (void) second.apply(full);
+                second.make_checkpoint(full);
+            }
+        }
+        m_delta_list.pop_front();
+        if (m_present > 0)
+            --m_present;
+
+        recount_since_checkpoint();
+    }
+    return result;
+}
+
+/**
+ *  Sets the count of steps since the last checkpoint from the steps that
+ *  are left, after steps are discarded by add() or pop(). Keeping a
+ *  running count instead would let the spacing of checkpoints drift.
+ */
+
+void
+delta_history::recount_since_checkpoint ()
+{
+    size_t count = 0;
+    for (size_t k = m_delta_list.size(); k > 0; --k)
+    {
+        if (m_delta_list[k - 1].checkpoint())
+            break;
+
+        ++count;
+    }
+    m_since_checkpoint = count;
+}
+
+/**
+ *  Rebuilds the options of a step from the nearest checkpoint at or before
+ *  it.
+ */
+
+void
+delta_history::rebuild (size_t index, options & target) const
+{
+    size_t k = index;
+    while (k > 0 && ! m_delta_list[k].checkpoint())
+        --k;
+
+    target = m_delta_list[k].get_checkpoint();
+    for (size_t j = k + 1; j <= index; ++j)
+        (void) m_delta_list[j].apply(target);
+}
+
+/**
+ *  Moves to the previous step by reverting the changes of the current step.
+ */
+
+const options &
+delta_history::undo ()
+{
+    static options s_dummy;
+    if (undoable())
+    {
+        if (! m_delta_list[m_present].revert(m_current))
+            rebuild(m_present - 1, m_current);
+
+        --m_present;
+        return m_current;
+    }
+    else
+        return s_dummy;
+}
+
+/**
+ *  Moves to the next step by applying its changes.
+ */
+
+const options &
+delta_history::redo ()
+{
+    static options s_dummy;
+    if (redoable())
+    {
+        ++m_present;
+        if (! m_delta_list[m_present].apply(m_current))
+            rebuild(m_present, m_current);
+
+        return m_current;
+    }
+    else
+        return s_dummy;
+}
+
+/**
+ *  Clears the history. True is returned if there was anything to clear.
+ */
+
+bool
+delta_history::reset ()
+{
+    bool result = active();
+    if (result)
+    {
+        m_delta_list.clear();
+        m_present = 0;
+        m_since_checkpoint = 0;
+        m_current = options(false);
+        m_rebuilt = options(false);
+    }
+    return result;
+}
+
+/**
+ *  Gets the options of any step. Except for the current step, the options
+ *  are rebuilt into a member that is overwritten by the next call.
+ */
+
+const options &
+delta_history::get (size_t index) const
+{
+    static options s_dummy;
+    if (active() && index < m_delta_list.size())
+    {
+        if (index == m_present)
+            return m_current;
+
+        rebuild(index, m_rebuilt);
+        return m_rebuilt;
+    }
+    else
+        return s_dummy;
+}
+
+size_t
+delta_history::change_count () const
+{
+    size_t result = 0;
+    for (const auto & d : m_delta_list)
+        result += d.count();
+
+    return result;
+}
+
+size_t
+delta_history::checkpoint_count () const
+{
+    size_t result = 0;
+    for (const auto & d : m_delta_list)
+    {
+        if (d.checkpoint())
+            ++result;
+    }
+    return result;
+}
+
+/**
+ *  Free function for testing. Shows the changes of each step.
+ */
+
+std::string
+options_history (const delta_history & h)
+{
+    std::string result;
+    if (h.active())
+    {
+        std::ostringstream ost;
+        ost
+            << "Count: " << std::to_string(h.size()) << " deltas; "
+            << "Present = " << std::to_string(h.present())
+            << "; Max. size = " << std::to_string(h.max_size())
+            << "; Checkpoints = " << std::to_string(h.checkpoint_count())
+            << std::endl
+            ;
+
+        for (size_t index = 0; index < h.size(); ++index)
+        {
+            const options_delta & d = h.delta(index);
+            ost << "(" << index << ")" << (d.checkpoint() ? " C" : "");
+            for (const auto & c : d.change_list())
+            {
+                ost
+                    << " " << c.change_name << ": \"" << c.change_old_value
+                    << "\" -> \"" << c.change_new_value << "\""
+                    ;
+            }
+            ost << std::endl;
+        }
+        result = ost.str();
+    }
+    else
+        result = "Empty";
+
+    return result;
+}
+
+}           // namespace cfg
+
+/*
+ * deltahistory.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
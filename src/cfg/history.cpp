@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2023-01-06
- * \updates       2023-07-29
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  See the "Design Patterns" book by Gamma et al., starting on page
@@ -100,6 +100,35 @@
  *      so item "[0]" is popped from the front and is lost for the duration
  *      of the program. The change is pushed/added, "present" is unchanged,
  *      and points to item "[4]" at index 3.
+ *
+ *  If a change is added after an undo, the states that could have been
+ *  redone are dropped before the new state is pushed, and "present" points
+ *  to the new state.
+ *
+ *  Storage:
+ *
+ *      The default storage policy, history_deque, is the deque described
+ *      above. The history_ring policy allocates all "max size" slots up
+ *      front and reuses them, so that a full history does no allocation
+ *      per step. With either policy, add(TYPE &&) and emplace() move the
+ *      new state into the list, and undo() and redo() return a reference
+ *      to the stored state without copying it.
+ *
+ *  Coalescing:
+ *
+ *      Continuous edits, such as dragging a slider, can add hundreds of
+ *      states per second, each one pushing out an older useful state. Two
+ *      ways of merging such edits into one memento are provided:
+ *
+ *      -   Call coalesce_window() with a time, and pass the name of the
+ *          edited item as the key to add(). Consecutive adds with the same
+ *          key, each within that time of the last, replace the present
+ *          memento instead of pushing a new one.
+ *      -   Bracket the edits with begin_group() and end_group(). Every add
+ *          after the first one in the group replaces the present memento.
+ *
+ *      The first memento is never replaced, nor is one that an undo has
+ *      moved back to.
  */
 
 #include <sstream>                      /* std::ostringstream for testing   */
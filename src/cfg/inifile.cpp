@@ -24,7 +24,7 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-11-23
- * \updates       2024-08-04
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  */
@@ -112,6 +112,8 @@ inifile::parse ()
 
             for (auto & section : sections)
                 parse_section(file, section);
+
+            (void) update_file_fingerprint();
         }
     }
     return result;
@@ -185,6 +187,8 @@ inifile::write ()
          */
 
         write_cfg66_footer(file);
+        file.close();
+        (void) update_file_fingerprint();
     }
     else
     {
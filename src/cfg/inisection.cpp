@@ -25,7 +25,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-06-19
- * \updates       2024-07-28
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  See the inisections class and modules for details.
@@ -33,6 +33,7 @@
 
 #include "cfg/appinfo.hpp"              /* cfg::appinfo data structure      */
 #include "cfg/inisection.hpp"           /* cfg::inisection classes          */
+#include "util/hash64.hpp"              /* util::hash_string()              */
 #include "util/strfunctions.hpp"        /* util::word_wrap()                */
 
 namespace cfg
@@ -135,6 +136,16 @@ inisection::settings_text () const
     return result;
 }
 
+/**
+ *  The fingerprint of the section name and the option values.
+ */
+
+std::uint64_t
+inisection::fingerprint (std::uint64_t seed) const
+{
+    return m_option_set.fingerprint(util::hash_string(m_name, seed));
+}
+
 /**
  *  If this is not the main configuration section, "[Cfg66]" or whatever the
  *  application changed it to at startup, the section configuration type,
@@ -25,7 +25,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-08-04
+ * \updates       2026-10-18
  * \license       See above.
  *
  * Operations to support:
@@ -363,6 +363,22 @@ inisections::settings_text () const
     return result;
 }
 
+/**
+ *  The fingerprint of all of the sections, in order. An application can
+ *  keep the value from when the file was last written, and skip an autosave
+ *  if it is unchanged.
+ */
+
+std::uint64_t
+inisections::fingerprint () const
+{
+    std::uint64_t result = 0;
+    for (const auto & sec : section_list())
+        result = sec.fingerprint(result);
+
+    return result;
+}
+
 std::string
 inisections::cli_help_text () const
 {
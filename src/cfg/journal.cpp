@@ -0,0 +1,546 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          journal.cpp
+ *
+ *  This module defines an on-disk undo journal and a history that uses it.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A journal file has an 8-byte header, "CFG66J01", followed by records.
+ *  Each record is:
+ *
+\verbatim
+        Length      4 bytes, little-endian, the length of the data.
+        Checksum    4 bytes, little-endian, FNV-1a of the data.
+        Data        Length bytes, as written by the serializer.
+\endverbatim
+ *
+ *  Records are only appended, or cut off at the end when states that could
+ *  have been redone are replaced. So a crash can only damage the last
+ *  record. When the journal is opened, the records are scanned, and the
+ *  file is truncated after the last record with a good length and
+ *  checksum.
+ *
+ *  On UNIXen the file is memory-mapped for reading, so paging a state back
+ *  in reads straight from the page cache. Elsewhere, the file is read into
+ *  a buffer.
+ */
+
+#include <cstring>                      /* std::memcmp()                    */
+
+#include "platform_macros.h"            /* detects the build platform       */
+#include "cfg/journal.hpp"              /* cfg::journal, journal_history<>  */
+#include "util/filefunctions.hpp"       /* util::file_open(), etc.          */
+#include "util/msgfunctions.hpp"        /* util::file_error()               */
+
+#if defined PLATFORM_UNIX
+#include <sys/mman.h>                   /* ::mmap(), ::munmap()             */
+#include <unistd.h>                     /* ::ftruncate(), ::fsync()         */
+#else
+#include <io.h>                         /* ::_chsize_s(), ::_commit()       */
+#endif
+
+namespace cfg
+{
+
+/**
+ *  The file header and the size of a record header.
+ */
+
+static const char sc_journal_magic [] = "CFG66J01";
+static const size_t sc_magic_size = 8;
+static const size_t sc_record_header_size = 8;
+
+/**
+ *  Little-endian 32-bit values, so journals can be moved between machines.
+ */
+
+static void
+put_u32 (std::string & out, unsigned long v)
+{
+    out.push_back(char(v & 0xFF));
+    out.push_back(char((v >> 8) & 0xFF));
+    out.push_back(char((v >> 16) & 0xFF));
+    out.push_back(char((v >> 24) & 0xFF));
+}
+
+static unsigned long
+get_u32 (const char * p)
+{
+    const unsigned char * u = reinterpret_cast<const unsigned char *>(p);
+    return
+        (unsigned long)(u[0]) | ((unsigned long)(u[1]) << 8) |
+        ((unsigned long)(u[2]) << 16) | ((unsigned long)(u[3]) << 24);
+}
+
+/**
+ *  The 32-bit FNV-1a hash, used only to detect a torn record.
+ */
+
+static unsigned long
+checksum (const char * data, size_t length)
+{
+    unsigned long h = 2166136261UL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h = (h * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
+
+/*--------------------------------------------------------------------------
+ * journal
+ *--------------------------------------------------------------------------*/
+
+journal::journal () :
+    m_file_name (),
+    m_file      (nullptr),
+    m_offsets   (),
+    m_file_size (0),
+    m_sync      (false),
+    m_map       (nullptr),
+    m_map_size  (0),
+    m_buffer    ()
+{
+    // no other code
+}
+
+journal::~journal ()
+{
+    close();
+}
+
+/**
+ *  Opens or creates the journal file.
+ *
+ * \param filename
+ *      The full path to the journal.
+ *
+ * \param restore
+ *      If true, the records in an existing journal are kept. Otherwise the
+ *      journal is emptied.
+ *
+ * \return
+ *      Returns true if the journal is open and valid.
+ */
+
+bool
+journal::open (const std::string & filename, bool restore)
+{
+    close();
+    bool exists = restore && util::file_exists(filename);
+    m_file = util::file_open(filename, exists ? "r+b" : "w+b");
+    bool result = not_nullptr(m_file);
+    if (result)
+    {
+        m_file_name = filename;
+        if (exists)
+            result = scan();
+        else
+            result = truncate(0);
+
+        if (! result)
+        {
+            (void) util::file_error("Journal invalid", filename);
+            close();
+        }
+    }
+    else
+        (void) util::file_error("Journal open failed", filename);
+
+    return result;
+}
+
+void
+journal::close ()
+{
+    unmap_file();
+    if (not_nullptr(m_file))
+    {
+        (void) std::fclose(m_file);
+        m_file = nullptr;
+    }
+    m_offsets.clear();
+    m_file_size = 0;
+}
+
+/**
+ *  Finds the records of an existing journal, and cuts off any partial or
+ *  corrupt record at the end.
+ */
+
+bool
+journal::scan ()
+{
+    (void) std::fseek(m_file, 0, SEEK_END);
+    long size = std::ftell(m_file);
+    m_file_size = size > 0 ? size_t(size) : 0 ;
+    if (m_file_size < sc_magic_size)
+        return truncate(0);             /* crashed before the header        */
+
+    bool result = map_file();
+    if (result)
+        result = std::memcmp(m_map, sc_journal_magic, sc_magic_size) == 0;
+
+    if (result)
+    {
+        size_t offset = sc_magic_size;
+        while (offset + sc_record_header_size <= m_file_size)
+        {
+            const char * p = m_map + offset;
+            size_t length = size_t(get_u32(p));
+            size_t end = offset + sc_record_header_size + length;
+            if (end > m_file_size || end < offset)
+                break;
+
+            const char * data = p + sc_record_header_size;
+            if (checksum(data, length) != get_u32(p + 4))
+                break;
+
+            m_offsets.push_back(offset);
+            offset = end;
+        }
+        if (offset != m_file_size)
+        {
+            m_file_size = offset;
+            util::warn_message("Journal damaged, truncated", m_file_name);
+            result = truncate(m_offsets.size());
+        }
+    }
+    return result;
+}
+
+/**
+ *  Appends a record.
+ *
+ * \return
+ *      Returns false if the record could not be written in full. The
+ *      partial record is then cut off.
+ */
+
+bool
+journal::append (const std::string & data)
+{
+    bool result = is_open();
+    if (result)
+    {
+        std::string header;
+        put_u32(header, (unsigned long)(data.length()));
+        put_u32(header, checksum(data.data(), data.length()));
+        result = std::fseek(m_file, long(m_file_size), SEEK_SET) == 0;
+        if (result)
+        {
+            result =
+                std::fwrite(header.data(), 1, header.size(), m_file) ==
+                    header.size() &&
+                std::fwrite(data.data(), 1, data.size(), m_file) ==
+                    data.size() &&
+                std::fflush(m_file) == 0;
+        }
+        if (result)
+        {
+#if defined PLATFORM_UNIX
+            if (m_sync)
+                (void) ::fsync(::fileno(m_file));
+#else
+            if (m_sync)
+                (void) ::_commit(::_fileno(m_file));
+
+            unmap_file();                   /* the copy lacks this record   */
+#endif
+            m_offsets.push_back(m_file_size);
+            m_file_size += header.size() + data.size();
+        }
+        else
+        {
+            (void) util::file_error("Journal write failed", m_file_name);
+            (void) truncate(m_offsets.size());
+        }
+    }
+    return result;
+}
+
+/**
+ *  Keeps only the first records of the journal. An empty journal still
+ *  has its header.
+ */
+
+bool
+journal::truncate (size_t recordcount)
+{
+    bool result = is_open();
+    if (result && recordcount < m_offsets.size())
+    {
+        m_file_size = m_offsets[recordcount];
+        m_offsets.resize(recordcount);
+    }
+    else if (result && recordcount == 0)
+        m_file_size = 0;
+
+    if (result && m_file_size < sc_magic_size)
+    {
+        result =
+            std::fseek(m_file, 0, SEEK_SET) == 0 &&
+            std::fwrite(sc_journal_magic, 1, sc_magic_size, m_file) ==
+                sc_magic_size &&
+            std::fflush(m_file) == 0;
+
+        m_file_size = sc_magic_size;
+        m_offsets.clear();
+    }
+    if (result)
+    {
+#if defined PLATFORM_UNIX
+        result = ::ftruncate(::fileno(m_file), off_t(m_file_size)) == 0;
+#else
+        result = ::_chsize_s(::_fileno(m_file), (__int64) m_file_size) == 0;
+#endif
+    }
+#if ! defined PLATFORM_UNIX
+    unmap_file();                           /* the copy has dropped records */
+#endif
+    return result;
+}
+
+/**
+ *  Provides the data of a record.
+ *
+ * \param index
+ *      The index of the record, starting at 0.
+ *
+ * \param [out] data
+ *      Points to the data in the mapping. It is valid until the journal is
+ *      appended to, truncated, or closed.
+ *
+ * \param [out] length
+ *      The length of the data.
+ *
+ * \return
+ *      Returns false if the index is out of range or the file could not be
+ *      mapped.
+ */
+
+bool
+journal::record (size_t index, const char * & data, size_t & length) const
+{
+    bool result = index < m_offsets.size() && map_file();
+    if (result)
+    {
+        const char * p = m_map + m_offsets[index];
+        length = size_t(get_u32(p));
+        data = p + sc_record_header_size;
+    }
+    return result;
+}
+
+/**
+ *  Makes sure the mapping covers the valid part of the file. A shared
+ *  mapping always shows the current bytes of the file, so it is replaced
+ *  only when the file has grown past it. The buffer used where there is no
+ *  mmap() is a copy, so append() and truncate() discard it, and it is read
+ *  again here.
+ */
+
+bool
+journal::map_file () const
+{
+    bool result = is_open();
+    if (result && (is_nullptr(m_map) || m_map_size < m_file_size))
+    {
+        unmap_file();
+#if defined PLATFORM_UNIX
+        void * p = ::mmap
+        (
+            nullptr, m_file_size, PROT_READ, MAP_SHARED, ::fileno(m_file), 0
+        );
+        result = p != MAP_FAILED;
+        if (result)
+        {
+            (void) ::madvise(p, m_file_size, MADV_RANDOM);
+            m_map = static_cast<const char *>(p);
+            m_map_size = m_file_size;
+        }
+#else
+        m_buffer.resize(m_file_size);
+        result =
+            std::fseek(m_file, 0, SEEK_SET) == 0 &&
+            std::fread(&m_buffer[0], 1, m_file_size, m_file) == m_file_size;
+
+        if (result)
+        {
+            m_map = m_buffer.data();
+            m_map_size = m_file_size;
+        }
+#endif
+    }
+    return result;
+}
+
+void
+journal::unmap_file () const
+{
+    if (not_nullptr(m_map))
+    {
+#if defined PLATFORM_UNIX
+        (void) ::munmap(const_cast<char *>(m_map), m_map_size);
+#else
+        m_buffer.clear();
+#endif
+        m_map = nullptr;
+        m_map_size = 0;
+    }
+}
+
+/*--------------------------------------------------------------------------
+ * history_serializer<options>
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  Each field is written as its length and its bytes, so no escaping is
+ *  needed. A parser for this is in deserialize().
+ */
+
+static void
+put_field (std::string & data, const std::string & field)
+{
+    put_u32(data, (unsigned long)(field.length()));
+    data += field;
+}
+
+static void
+put_flag (std::string & data, bool flag)
+{
+    data.push_back(flag ? '1' : '0');
+}
+
+static bool
+get_field (const char * & p, const char * end, std::string & field)
+{
+    bool result = end - p >= 4;
+    if (result)
+    {
+        size_t length = size_t(get_u32(p));
+        p += 4;
+        result = size_t(end - p) >= length;
+        if (result)
+        {
+            field.assign(p, length);
+            p += length;
+        }
+    }
+    return result;
+}
+
+static bool
+get_byte (const char * & p, const char * end, char & c)
+{
+    bool result = p < end;
+    if (result)
+        c = *p++;
+
+    return result;
+}
+
+bool
+history_serializer<options>::serialize (const options & s, std::string & data)
+{
+    data.clear();
+    put_field(data, s.source_file());
+    put_field(data, s.source_section());
+    put_u32(data, (unsigned long)(s.size()));
+    for (const auto & op : s.option_pairs())
+    {
+        const options::spec & sp = op.second;
+        put_field(data, op.first);
+        data.push_back(sp.option_code);
+        data.push_back(char(static_cast<int>(sp.option_kind)));
+        put_flag(data, sp.option_cli_enabled);
+        put_field(data, sp.option_default);
+        put_field(data, sp.option_value);
+        put_flag(data, sp.option_read_from_cli);
+        put_flag(data, sp.option_modified);
+        put_field(data, sp.option_desc);
+        put_flag(data, sp.option_global);
+    }
+    return true;
+}
+
+bool
+history_serializer<options>::deserialize
+(
+    const char * d, size_t len, options & s
+)
+{
+    const char * end = d + len;
+    std::string file, section;
+    bool result = get_field(d, end, file) && get_field(d, end, section);
+    if (result)
+        result = end - d >= 4;
+
+    if (result)
+    {
+        size_t count = size_t(get_u32(d));
+        d += 4;
+        s = options(false);
+        s.source_file(file);
+        s.source_section(section);
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string name;
+            options::spec sp{};
+            char code, kind, enabled, fromcli, modified, global;
+            result =
+                get_field(d, end, name) &&
+                get_byte(d, end, code) && get_byte(d, end, kind) &&
+                get_byte(d, end, enabled) &&
+                get_field(d, end, sp.option_default) &&
+                get_field(d, end, sp.option_value) &&
+                get_byte(d, end, fromcli) && get_byte(d, end, modified) &&
+                get_field(d, end, sp.option_desc) &&
+                get_byte(d, end, global);
+
+            if (! result)
+                break;
+
+            sp.option_code = code;
+            sp.option_kind = static_cast<options::kind>(kind);
+            sp.option_cli_enabled = enabled == '1';
+            sp.option_read_from_cli = fromcli == '1';
+            sp.option_modified = modified == '1';
+            sp.option_global = global == '1';
+            (void) s.add(options::option{name, sp});
+        }
+    }
+    return result;
+}
+
+}           // namespace cfg
+
+/*
+ * journal.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-09-30
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  The cli::options class provides a way to hold the state of command-line
@@ -150,14 +150,17 @@
  */
 
 #include <algorithm>                    /* std::sort()                      */
+#include <atomic>                       /* std::atomic<> generation counter */
 #include <cmath>                        /* std::fabs(), std::fabsf()        */
 #include <iomanip>                      /* std::setw()                      */
 #include <limits>                       /* std::numeric_limits<>            */
 #include <sstream>                      /* std::ostringstream               */
+#include <utility>                      /* std::move()                      */
 
 #include "c_macros.h"                   /* not_nullptr()                    */
 #include "cfg/appinfo.hpp"              /* cfg::level_color()               */
 #include "cfg/options.hpp"              /* cfg::options class               */
+#include "util/hash64.hpp"              /* util::hash64 class               */
 #include "util/strfunctions.hpp"        /* util::string_to_int() etc.       */
 
 #if defined USE_COLOR_CLI_HELP_TEXT
@@ -210,13 +213,27 @@ options::spec::spec
  * options
  *--------------------------------------------------------------------------*/
 
+/**
+ *  Provides a new generation number. One counter serves all options
+ *  objects, so that two of them never have the same generation, even if
+ *  one replaces the other at the same address.
+ */
+
+static std::size_t
+next_generation ()
+{
+    static std::atomic<std::size_t> s_generation{0};
+    return ++s_generation;
+}
+
 options::options (bool loadglobal) :
     m_code_list         (),
     m_has_error         (false),
     m_error_msg         (),
     m_source_file       (),
     m_source_section    (),
-    m_option_pairs      ()
+    m_option_pairs      (),
+    m_generation        (next_generation())
 {
     if (loadglobal)
     {
@@ -236,7 +253,8 @@ options::options
     m_error_msg         (),
     m_source_file       (file),
     m_source_section    (section),
-    m_option_pairs      (specs)
+    m_option_pairs      (specs),
+    m_generation        (next_generation())
 {
     if (file.empty() && section.empty())
     {
@@ -247,6 +265,78 @@ options::options
         initialize();
 }
 
+/**
+ *  The copy and move functions are the defaults, except that the result
+ *  gets a new generation, since its options are new map nodes.
+ */
+
+options::options (const options & other) :
+    m_code_list         (other.m_code_list),
+    m_has_error         (other.m_has_error),
+    m_error_msg         (other.m_error_msg),
+    m_source_file       (other.m_source_file),
+    m_source_section    (other.m_source_section),
+    m_option_pairs      (other.m_option_pairs),
+    m_generation        (next_generation())
+{
+    // No other code
+}
+
+options::options (options && other) :
+    m_code_list         (std::move(other.m_code_list)),
+    m_has_error         (other.m_has_error),
+    m_error_msg         (std::move(other.m_error_msg)),
+    m_source_file       (std::move(other.m_source_file)),
+    m_source_section    (std::move(other.m_source_section)),
+    m_option_pairs      (std::move(other.m_option_pairs)),
+    m_generation        (next_generation())
+{
+    other.touch();
+}
+
+options &
+options::operator = (const options & other)
+{
+    if (this != &other)
+    {
+        m_code_list = other.m_code_list;
+        m_has_error = other.m_has_error;
+        m_error_msg = other.m_error_msg;
+        m_source_file = other.m_source_file;
+        m_source_section = other.m_source_section;
+        m_option_pairs = other.m_option_pairs;
+        touch();
+    }
+    return *this;
+}
+
+options &
+options::operator = (options && other)
+{
+    if (this != &other)
+    {
+        m_code_list = std::move(other.m_code_list);
+        m_has_error = other.m_has_error;
+        m_error_msg = std::move(other.m_error_msg);
+        m_source_file = std::move(other.m_source_file);
+        m_source_section = std::move(other.m_source_section);
+        m_option_pairs = std::move(other.m_option_pairs);
+        touch();
+        other.touch();
+    }
+    return *this;
+}
+
+/**
+ *  Marks the option container as possibly having gained or lost options.
+ */
+
+void
+options::touch ()
+{
+    m_generation = next_generation();
+}
+
 /**
  *  Empties the options container completely. It then (optionally) adds
  *  in stock help and version information. This function must be called
@@ -272,7 +362,7 @@ options::reset ()
 void
 options::initialize ()
 {
-    init_container(option_pairs());
+    init_container(m_option_pairs);
 }
 
 /**
@@ -403,11 +493,11 @@ options::check_range
         std::string msg = "Option '";
         msg += name;
         msg += "=";
-        msg += util::double_to_string(value);
+        msg += util::float_to_string(value);
         msg += "' outside of range ";
-        msg += util::double_to_string(minimum);
+        msg += util::float_to_string(minimum);
         msg += " to ";
-        msg += util::double_to_string(maximum);
+        msg += util::float_to_string(maximum);
         m_has_error = true;
         if (adding)
         {
@@ -459,58 +549,89 @@ options::set_value
         if (result)
         {
             spec & ncop = const_cast<spec &>(opt->second);
-            result = value != ncop.option_value;
-            if (result)
-            {
-                if (option_is_boolean(ncop))
-                {
-                    std::string newvalue = "true";
-                    if (value != "true")
-                        newvalue = "false";
+            result = set_spec_value(opt->first, ncop, value);
+        }
+    }
+    return result;
+}
 
-                    ncop.option_value = newvalue;
-                }
-                else if (option_is_int(ncop))
-                {
-                    int minimum;
-                    int maximum;
-                    int defalt = integer_value_range(name, minimum, maximum);
-                    if (value.empty())
-                    {
-                        ncop.option_value = std::to_string(defalt);
-                    }
-                    else
-                    {
-                        int iv = util::string_to_int(value);
-                        result = check_range
-                        (
-                            name, float(iv), float(minimum), float(maximum)
-                        );
-                        if (result)
-                            ncop.option_value = value;
-                    }
-                }
-                else if (option_is_float(ncop))
-                {
-                    float minimum;
-                    float maximum;
-                    float defalt = floating_value_range(name, minimum, maximum);
-                    if (value.empty())
-                    {
-                        ncop.option_value = std::to_string(defalt);
-                    }
-                    else
-                    {
-                        float iv = float(util::string_to_double(value));
-                        result = check_range(name, iv, minimum, maximum);
-                        if (result)
-                            ncop.option_value = value;
-                    }
-                }
-                else
-                    ncop.option_value = value;
+/**
+ *  The guts of set_value(), usable once the option has already been looked
+ *  up. This lets the cli::parser fast-lookup mode set a value without a
+ *  second search through the container.
+ *
+ *  \private
+ *
+ * \param name
+ *      The long name of the option, used for range lookup and error messages.
+ *
+ * \param [inout] s
+ *      The option specification to modify.
+ *
+ * \param value
+ *      The value to be assigned. See set_value().
+ *
+ * \return
+ *      Returns true if the value actually changed and is in range.
+ */
+
+bool
+options::set_spec_value
+(
+    const std::string & name,
+    spec & s,
+    const std::string & value
+)
+{
+    bool result = value != s.option_value;
+    if (result)
+    {
+        if (option_is_boolean(s))
+        {
+            if (value == "true")
+                s.option_value = "true";
+            else
+                s.option_value = "false";
+        }
+        else if (option_is_int(s))
+        {
+            int minimum;
+            int maximum;
+            int defalt = integer_value_range(s, minimum, maximum);
+            if (value.empty())
+            {
+                s.option_value = util::int_to_string(defalt);
+            }
+            else
+            {
+                int iv = util::string_to_int(value);
+                result = check_range
+                (
+                    name, float(iv), float(minimum), float(maximum)
+                );
+                if (result)
+                    s.option_value = value;
             }
         }
+        else if (option_is_float(s))
+        {
+            float minimum;
+            float maximum;
+            float defalt = floating_value_range(s, minimum, maximum);
+            if (value.empty())
+            {
+                s.option_value = util::float_to_string(defalt);
+            }
+            else
+            {
+                float iv = util::string_to_float(value);
+                result = check_range(name, iv, minimum, maximum);
+                if (result)
+                    s.option_value = value;
+            }
+        }
+        else
+            s.option_value = value;
     }
     return result;
 }
@@ -543,14 +664,42 @@ options::change_value
     bool fromcli
 )
 {
-    bool result = set_value(name, value);
+    bool result = ! name.empty();
     if (result)
     {
-        auto opt = find_match(name);                /* always succeeds here */
-        spec & ncop = const_cast<spec &>(opt->second);
-        ncop.option_modified = true;
+        auto opt = find_match(name);
+        result = option_exists(opt);
+        if (result)
+        {
+            spec & ncop = const_cast<spec &>(opt->second);
+            result = change_spec_value(opt->first, ncop, value, fromcli);
+        }
+    }
+    return result;
+}
+
+/**
+ *  The guts of change_value(), for an option that has already been looked
+ *  up.
+ *
+ *  \private
+ */
+
+bool
+options::change_spec_value
+(
+    const std::string & name,
+    spec & s,
+    const std::string & value,
+    bool fromcli
+)
+{
+    bool result = set_spec_value(name, s, value);
+    if (result)
+    {
+        s.option_modified = true;
         if (fromcli)
-            ncop.option_read_from_cli = true;
+            s.option_read_from_cli = true;
     }
     return result;
 }
@@ -570,6 +719,29 @@ options::modified () const
     return result;
 }
 
+/**
+ *  Hashes the names and values of the options. Two option sets with the
+ *  same values have the same fingerprint, so saving or reloading can be
+ *  skipped if the fingerprint has not changed since the last time. Unlike
+ *  modified(), this is not fooled by a value changed and then changed back.
+ *
+ * \param seed
+ *      Used to chain the fingerprints of several option sets, as done by
+ *      inisections::fingerprint().
+ */
+
+std::uint64_t
+options::fingerprint (std::uint64_t seed) const
+{
+    util::hash64 h(seed);
+    for (const auto & op : option_pairs())
+    {
+        h.update_field(op.first);
+        h.update_field(op.second.option_value);
+    }
+    return h.digest();
+}
+
 /**
  *  If this function returns true, then the option was already obtained from the
  *  command-line, and should not be overwritten (except from an edit within
@@ -622,7 +794,7 @@ options::unmodify (const std::string & name)
 void
 options::unmodify_all ()
 {
-    for (auto & op : option_pairs())
+    for (auto & op : m_option_pairs)
         op.second.option_modified = false;
 }
 
@@ -1353,7 +1525,7 @@ options::floating_value (const std::string & name) const
 void
 options::floating_value (const std::string & name, float value)
 {
-    std::string dvalue = util::double_to_string(value);
+    std::string dvalue = util::float_to_string(value);
     bool ok = change_value(name, dvalue);
     if (! ok)
     {
@@ -1436,7 +1608,23 @@ options::integer_value_range
     int & maximum
 ) const
 {
-    std::string defstring = default_value(name);
+    return integer_value_range(find_spec(name), minimum, maximum);
+}
+
+/**
+ *  Same as the name overload, but works on an option that has already
+ *  been looked up.
+ */
+
+int
+options::integer_value_range
+(
+    const spec & s,
+    int & minimum,
+    int & maximum
+) const
+{
+    const std::string & defstring = s.option_default;
     lib66::tokenization range = range_tokens(defstring);
     int result = -99999;
     if (range.size() == 3)
@@ -1486,7 +1674,18 @@ options::floating_value_range
     float & maximum
 ) const
 {
-    std::string defstring = default_value(name);
+    return floating_value_range(find_spec(name), minimum, maximum);
+}
+
+float
+options::floating_value_range
+(
+    const spec & s,
+    float & minimum,
+    float & maximum
+) const
+{
+    const std::string & defstring = s.option_default;
     lib66::tokenization range = range_tokens(defstring);
     float result = -99999.0;
     if (range.size() == 3)
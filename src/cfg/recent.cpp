@@ -25,14 +25,32 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-03-29
- * \updates       2024-09-05
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The cfg66::recent class simply keeps track of recently-used files for the
  *  "Recent Files" menu.
+ *
+ *  The paths are also kept in a hash map, so that checking whether a path
+ *  is in the list, as append(), add(), remove(), and contains() do, does
+ *  not require a search of the list. Removing a path from the middle of
+ *  the list still searches it, but the list is short.
+ *
+ *  Normally, append() and add() check that a file is readable before it is
+ *  put in the list. On a slow or networked file-system, that check can
+ *  stall the caller, which is often the user-interface thread. If
+ *  deferred_validation(true) is set, the check is skipped; instead,
+ *  validate() checks all of the entries, as a batch, in a background
+ *  thread. The unreadable entries are removed the next time the list is
+ *  changed, or when prune() is called, unless they have been removed and
+ *  added again since they were checked. In this mode absolute paths
+ *  are only normalized, not resolved, since resolving them also touches
+ *  the file-system.
  */
 
 #include <algorithm>                    /* std::find()                      */
+#include <system_error>                 /* std::system_error                */
+#include <thread>                       /* std::thread                      */
 
 #include "cfg/recent.hpp"               /* cfg66 recent-files container     */
 #include "util/filefunctions.hpp"       /* util::get_full_path()            */
@@ -53,12 +71,44 @@ static const int sc_recent_files_max = 12;
  */
 
 recent::recent () :
-    m_recent_list   (),
-    m_maximum_size  (sc_recent_files_max)
+    m_recent_list           (),
+    m_recent_index          (),
+    m_generation            (0),
+    m_maximum_size          (sc_recent_files_max),
+    m_deferred_validation   (false),
+    m_validation_pending    (false),
+    m_validation            (std::make_shared<validation>())
 {
     // no code
 }
 
+/**
+ *  The copy constructor. The copy gets its own validation state, so that a
+ *  validation started by the source does not prune the copy.
+ */
+
+recent::recent (const recent & source) :
+    m_recent_list           (source.m_recent_list),
+    m_recent_index          (source.m_recent_index),
+    m_generation            (source.m_generation),
+    m_maximum_size          (source.m_maximum_size),
+    m_deferred_validation   (source.m_deferred_validation),
+    m_validation_pending    (source.m_validation_pending),
+    m_validation            (std::make_shared<validation>())
+{
+    // no code
+}
+
+/**
+ *  Waits for a background validation to finish, since its thread must be
+ *  joined.
+ */
+
+recent::~recent ()
+{
+    join_validation();
+}
+
 /**
  *  The conventional, but rote, principal assignent operator.  It has to be
  *  created to comment out re-assigning a constant.
@@ -69,7 +119,17 @@ recent::operator = (const recent & source)
 {
     if (this != &source)
     {
-        m_recent_list   = source.m_recent_list;
+        m_recent_list           = source.m_recent_list;
+        m_recent_index          = source.m_recent_index;
+        m_generation            = source.m_generation;
+        m_deferred_validation   = source.m_deferred_validation;
+        m_validation_pending    = source.m_validation_pending;
+        join_validation();              /* its results are for old entries  */
+        if (m_validation)
+        {
+            std::lock_guard<std::mutex> guard(m_validation->validation_lock);
+            m_validation->validation_stale.clear();
+        }
 
         /*
          * A constant, cannot be reassigned:
@@ -99,22 +159,28 @@ recent::operator = (const recent & source)
 bool
 recent::append (const std::string & item)
 {
+    (void) prune();
     bool result = count() < maximum();
     if (result)
     {
-        std::string path = util::get_full_path(util::normalize_path(item));
+        std::string path = full_path(item);
         result = ! path.empty();
-        if (result)
+        if (result && ! m_deferred_validation)
             result = util::file_readable(path);
 
         if (result)
         {
-            const auto & it = std::find
+            auto r = m_recent_index.insert
             (
-                m_recent_list.cbegin(), m_recent_list.cend(), path
+                std::make_pair(path, m_generation + 1)
             );
-            if (it == m_recent_list.end())              /* not found?   */
+            if (r.second)                               /* not found?   */
+            {
+                ++m_generation;
                 m_recent_list.push_back(path);          /* append it!   */
+                if (m_deferred_validation)
+                    m_validation_pending = true;
+            }
         }
     }
     return result;
@@ -138,28 +204,32 @@ recent::append (const std::string & item)
 bool
 recent::add (const std::string & item)
 {
-    std::string path = util::get_full_path(util::normalize_path(item));
+    (void) prune();
+
+    std::string path = full_path(item);
     bool result = ! path.empty();
-    if (result)
+    if (result && ! m_deferred_validation)
         result = util::file_readable(path);
 
     if (result)
     {
-        const auto & it = std::find
-        (
-            m_recent_list.cbegin(), m_recent_list.cend(), path
-        );
-        if (it != m_recent_list.end())
-            (void) m_recent_list.erase(it);
+        if (contains_path(path))
+            index_erase(path);
 
         result = count() < maximum();
         if (! result)
         {
-            m_recent_list.pop_back();   /* remove last entry to make room   */
+            (void) m_recent_index.erase(m_recent_list.back());
+            m_recent_list.pop_back();           /* make room for new entry  */
             result = true;
         }
         if (result)
+        {
             m_recent_list.push_front(path);
+            (void) m_recent_index.insert(std::make_pair(path, ++m_generation));
+            if (m_deferred_validation)
+                m_validation_pending = true;
+        }
     }
     return result;
 }
@@ -180,18 +250,192 @@ recent::add (const std::string & item)
 bool
 recent::remove (const std::string & item)
 {
-    std::string path = util::get_full_path(util::normalize_path(item));
-    bool result = ! path.empty();
+    (void) prune();
+
+    std::string path = full_path(item);
+    bool result = contains_path(path);
     if (result)
+        index_erase(path);
+
+    return result;
+}
+
+/**
+ *  Indicates if the path is in the recent-files list.
+ *
+ * \param item
+ *      Provides the path to look up. It is converted in the same way as in
+ *      add().
+ *
+ * \return
+ *      Returns true if the path is in the list.
+ */
+
+bool
+recent::contains (const std::string & item) const
+{
+    return contains_path(full_path(item));
+}
+
+/**
+ *  Converts a file-name to the form stored in the list: UNIX separators,
+ *  and a full path. In deferred-validation mode, a path that is already
+ *  absolute is not resolved, since that would touch the file-system.
+ */
+
+std::string
+recent::full_path (const std::string & item) const
+{
+    std::string result = util::normalize_path(item);
+    if (! m_deferred_validation || ! util::name_has_root_path(result))
+        result = util::get_full_path(result);
+
+    return result;
+}
+
+/**
+ *  Removes a path that is known to be in the list from both the list and
+ *  the index. The index does not hold positions, which every push_front()
+ *  and erase() would shift, so the list is searched for the path.
+ */
+
+void
+recent::index_erase (const std::string & path)
+{
+    auto it = std::find(m_recent_list.begin(), m_recent_list.end(), path);
+    if (it != m_recent_list.end())
+        (void) m_recent_list.erase(it);
+
+    (void) m_recent_index.erase(path);
+}
+
+/**
+ *  Joins the thread of the latest validation, if any, waiting for it to
+ *  finish.
+ */
+
+void
+recent::join_validation ()
+{
+    if (m_validation && m_validation->validation_thread.joinable())
+        m_validation->validation_thread.join();
+}
+
+/**
+ *  Checks a batch of paths for readability, and posts the unreadable ones
+ *  to the validation state. This is the body of the validation thread.
+ */
+
+void
+recent::check_batch
+(
+    std::shared_ptr<validation> v,
+    const entries & batch
+)
+{
+    entries stale;
+    for (const auto & e : batch)
+    {
+        if (! util::file_readable(e.first))
+            stale.push_back(e);
+    }
+
+    std::lock_guard<std::mutex> guard(v->validation_lock);
+    v->validation_stale.insert
+    (
+        v->validation_stale.end(), stale.cbegin(), stale.cend()
+    );
+    v->validation_busy = false;
+}
+
+/**
+ *  Starts checking the readability of all of the entries, as one batch, in
+ *  a background thread. The thread works on a copy of the list, so the
+ *  list can be used and changed in the meantime. Entries found to be
+ *  unreadable are removed by the next prune(), which is also done by
+ *  append(), add(), and remove().
+ *
+ *  If a thread cannot be started, the batch is checked here.
+ *
+ * \return
+ *      Returns false if a validation is already running, in which case
+ *      nothing is done.
+ */
+
+bool
+recent::validate ()
+{
+    bool result = bool(m_validation);
+    if (result)
+    {
+        std::lock_guard<std::mutex> guard(m_validation->validation_lock);
+        result = ! m_validation->validation_busy;
+        if (result)
+            m_validation->validation_busy = true;
+    }
+    if (result)
+    {
+        std::shared_ptr<validation> v = m_validation;
+        entries batch(m_recent_index.cbegin(), m_recent_index.cend());
+        m_validation_pending = false;
+        join_validation();                  /* the last one has finished    */
+        try
+        {
+            v->validation_thread = std::thread(check_batch, v, batch);
+        }
+        catch (const std::system_error &)
+        {
+            check_batch(v, batch);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Indicates that a background validation has not yet finished.
+ */
+
+bool
+recent::validating () const
+{
+    bool result = bool(m_validation);
+    if (result)
+    {
+        std::lock_guard<std::mutex> guard(m_validation->validation_lock);
+        result = m_validation->validation_busy;
+    }
+    return result;
+}
+
+/**
+ *  Removes the entries that the latest validation found to be unreadable.
+ *  It is cheap to call if there are none. An entry removed and added again
+ *  after it was checked has a new generation, and is kept.
+ *
+ * \return
+ *      Returns the number of entries removed.
+ */
+
+int
+recent::prune ()
+{
+    int result = 0;
+    if (m_validation)
     {
-        const auto & it = std::find
-        (
-            m_recent_list.cbegin(), m_recent_list.cend(), path
-        );
-        if (it != m_recent_list.end())
-            (void) m_recent_list.erase(it);
-        else
-            result = false;
+        entries stale;
+        {
+            std::lock_guard<std::mutex> guard(m_validation->validation_lock);
+            stale.swap(m_validation->validation_stale);
+        }
+        for (const auto & e : stale)
+        {
+            auto it = m_recent_index.find(e.first);
+            if (it != m_recent_index.end() && it->second == e.second)
+            {
+                index_erase(e.first);
+                ++result;
+            }
+        }
     }
     return result;
 }
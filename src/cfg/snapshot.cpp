@@ -0,0 +1,367 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cfg66; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          snapshot.cpp
+ *
+ *  This module defines immutable, structurally-shared snapshots of options
+ *  and inisections.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  Copying a cfg::options copies its whole std::map, descriptions and all.
+ *  An options_snapshot instead keeps the options in fixed-size chunks
+ *  behind shared pointers:
+ *
+\verbatim
+        snapshot A ---> table A: [c0] [c1] [c2]
+                                  |    |    |
+        snapshot B ---> table B: [c0] [c1'] [c2]
+\endverbatim
+ *
+ *  Taking a copy of a snapshot copies one pointer, so it is O(1). Changing
+ *  a value (here, one in chunk c1) makes a new table, which copies only
+ *  the chunk pointers, and a new copy of the one chunk holding the option.
+ *  Everything else is shared. Nothing reachable from a snapshot is ever
+ *  changed, so snapshots can be read from any thread without locking.
+ *
+ *  This makes options_snapshot a cheap TYPE for history<>, and a safe way
+ *  to hand a configuration to a worker thread.
+ *
+ *  Note that set_value() does not validate the value against the kind or
+ *  range of the option. Edit an options object for that, and take a new
+ *  snapshot of it.
+ */
+
+#include <algorithm>                    /* std::lower_bound()               */
+
+#include "cfg/snapshot.hpp"             /* cfg::options_snapshot, etc.      */
+
+namespace cfg
+{
+
+/*--------------------------------------------------------------------------
+ * options_snapshot
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  An empty snapshot. All empty snapshots share one table.
+ */
+
+options_snapshot::options_snapshot () : m_table ()
+{
+    static const std::shared_ptr<const table> s_empty_table
+    {
+        std::make_shared<const table>()
+    };
+    m_table = s_empty_table;
+}
+
+/**
+ *  Takes the first snapshot of a set of options, copying each option into
+ *  a chunk.
+ */
+
+options_snapshot::options_snapshot (const options & opts) : m_table ()
+{
+    auto t = std::make_shared<table>();
+    t->table_size = opts.size();
+    t->table_source_file = opts.source_file();
+    t->table_source_section = opts.source_section();
+    t->table_chunks.reserve((opts.size() + chunk_size - 1) / chunk_size);
+
+    std::shared_ptr<chunk> current;
+    for (const auto & op : opts.option_pairs())
+    {
+        if (! current || current->size() == chunk_size)
+        {
+            current = std::make_shared<chunk>();
+            current->reserve(chunk_size);
+            t->table_chunks.push_back(current);
+        }
+        current->push_back(op);
+    }
+    m_table = t;
+}
+
+/**
+ *  Indicates if two snapshots share a chunk, rather than having equal
+ *  copies of it. Mostly useful for testing.
+ */
+
+bool
+options_snapshot::shares_chunk
+(
+    const options_snapshot & other, size_t index
+) const
+{
+    return
+        index < chunk_count() && index < other.chunk_count() &&
+        m_table->table_chunks[index] == other.m_table->table_chunks[index];
+}
+
+/**
+ *  Finds the chunk and the index in the chunk of an option, using binary
+ *  searches. The chunks are in name order, and so are the options in
+ *  each chunk.
+ */
+
+bool
+options_snapshot::locate
+(
+    const std::string & name, size_t & c, size_t & index
+) const
+{
+    const auto & chunks = m_table->table_chunks;
+    auto cit = std::lower_bound
+    (
+        chunks.cbegin(), chunks.cend(), name,
+        [] (const chunk_pointer & cp, const std::string & n)
+        {
+            return cp->back().first < n;
+        }
+    );
+    bool result = cit != chunks.cend();
+    if (result)
+    {
+        const chunk & ch = **cit;
+        auto oit = std::lower_bound
+        (
+            ch.cbegin(), ch.cend(), name,
+            [] (const options::option & op, const std::string & n)
+            {
+                return op.first < n;
+            }
+        );
+        result = oit != ch.cend() && oit->first == name;
+        if (result)
+        {
+            c = size_t(cit - chunks.cbegin());
+            index = size_t(oit - ch.cbegin());
+        }
+    }
+    return result;
+}
+
+/**
+ *  Looks up an option by its long name.
+ *
+ * \return
+ *      Returns a pointer to the specification, or a null pointer if the
+ *      option is not in the snapshot. The pointer is valid as long as any
+ *      snapshot sharing its chunk exists.
+ */
+
+const options::spec *
+options_snapshot::find (const std::string & name) const
+{
+    size_t c, index;
+    return locate(name, c, index) ?
+        &(*m_table->table_chunks[c])[index].second : nullptr ;
+}
+
+std::string
+options_snapshot::value (const std::string & name) const
+{
+    const options::spec * sp = find(name);
+    return not_nullptr(sp) ? sp->option_value : std::string() ;
+}
+
+/**
+ *  Makes a new snapshot with one option changed, and marked as modified.
+ *  This snapshot is not changed.
+ *
+ * \return
+ *      Returns the new snapshot. If the option does not exist, or already
+ *      has the value, a copy of this snapshot is returned.
+ */
+
+options_snapshot
+options_snapshot::set_value
+(
+    const std::string & name,
+    const std::string & value
+) const
+{
+    options_snapshot result{*this};
+    size_t c, index;
+    if (locate(name, c, index))
+    {
+        const chunk & old = *m_table->table_chunks[c];
+        if (old[index].second.option_value != value)
+        {
+            auto t = std::make_shared<table>(*m_table); /* copies pointers  */
+            auto ch = std::make_shared<chunk>(old);     /* copies one chunk */
+            options::spec & sp = (*ch)[index].second;
+            sp.option_value = value;
+            sp.option_modified = true;
+            t->table_chunks[c] = ch;
+            result.m_table = t;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Makes a full options object from the snapshot.
+ */
+
+options
+options_snapshot::to_options () const
+{
+    options result{false};
+    result.source_file(source_file());
+    result.source_section(source_section());
+    for (const auto & cp : m_table->table_chunks)
+        result.option_pairs().insert(cp->cbegin(), cp->cend());
+
+    return result;
+}
+
+/**
+ *  Copies the values and modified flags of the snapshot into an existing
+ *  options object, leaving its other options alone.
+ *
+ * \return
+ *      Returns false if any option of the snapshot is missing from the
+ *      target.
+ */
+
+bool
+options_snapshot::apply (options & target) const
+{
+    bool result = true;
+    options::container & pairs = target.option_pairs();
+    for (const auto & cp : m_table->table_chunks)
+    {
+        for (const auto & op : *cp)
+        {
+            auto it = pairs.find(op.first);
+            if (it != pairs.end())
+            {
+                it->second.option_value = op.second.option_value;
+                it->second.option_modified = op.second.option_modified;
+            }
+            else
+                result = false;
+        }
+    }
+    return result;
+}
+
+/*--------------------------------------------------------------------------
+ * inisections_snapshot
+ *--------------------------------------------------------------------------*/
+
+inisections_snapshot::inisections_snapshot () : m_sections ()
+{
+    static const std::shared_ptr<const sectionlist> s_empty_list
+    {
+        std::make_shared<const sectionlist>()
+    };
+    m_sections = s_empty_list;
+}
+
+inisections_snapshot::inisections_snapshot (const inisections & sections) :
+    m_sections ()
+{
+    auto sl = std::make_shared<sectionlist>();
+    sl->reserve(sections.section_list().size());
+    for (const auto & sec : sections.section_list())
+    {
+        section s
+        {
+            sec.name(), sec.config_type(), options_snapshot{sec.option_set()}
+        };
+        sl->push_back(s);
+    }
+    m_sections = sl;
+}
+
+/**
+ *  Finds the options of a section.
+ *
+ * \return
+ *      Returns an empty snapshot if there is no such section.
+ */
+
+const options_snapshot &
+inisections_snapshot::find_options (const std::string & sectionname) const
+{
+    static const options_snapshot s_empty;
+    for (const auto & s : *m_sections)
+    {
+        if (s.section_name == sectionname)
+            return s.section_options;
+    }
+    return s_empty;
+}
+
+std::string
+inisections_snapshot::value
+(
+    const std::string & sectionname,
+    const std::string & name
+) const
+{
+    return find_options(sectionname).value(name);
+}
+
+/**
+ *  Makes a new snapshot with one option in one section changed.
+ */
+
+inisections_snapshot
+inisections_snapshot::set_value
+(
+    const std::string & sectionname,
+    const std::string & name,
+    const std::string & value
+) const
+{
+    inisections_snapshot result{*this};
+    for (size_t i = 0; i < m_sections->size(); ++i)
+    {
+        const section & s = (*m_sections)[i];
+        if (s.section_name == sectionname)
+        {
+            options_snapshot changed = s.section_options.set_value(name, value);
+            if (! changed.same(s.section_options))
+            {
+                auto sl = std::make_shared<sectionlist>(*m_sections);
+                (*sl)[i].section_options = changed;
+                result.m_sections = sl;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+}           // namespace cfg
+
+/*
+ * snapshot.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
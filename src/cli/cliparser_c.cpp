@@ -22,15 +22,20 @@
  *    This module provides C-compatible access to the cliparser class for
  *    parsing command line without using getopt.
  *
+ *    The older functions use a single static cli::parser. The cfg66_parser
+ *    functions use a heap-allocated parser per handle, and share no state
+ *    between handles.
+ *
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-07-15
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
 
 #include <cstdio>
+#include <new>                          /* std::nothrow                     */
 
 #include "cli/parser.hpp"               /* cfg::options, cli::parser        */
 #include "cli/cliparser_c.h"            /* cliparser_c functions            */
@@ -62,18 +67,18 @@ initialize (void)
  *  This "transformer" function takes an array of options_spec C structures
  *  with character pointers and converts them to cfg::options::spec structures,
  *  then adds the name to make a cfg::options::option pair, then fills the
- *  static cli::parser object with them.
+ *  given cli::parser object with them.
  *
  *  Note that this function forces the option_value to be empty.
  */
 
-bool
-create_option_list (const options_spec * opts, int optcount)
+static bool
+fill_option_list (cli::parser & p, const options_spec * opts, int optcount)
 {
     bool result = not_nullptr(opts);
     if (result)
     {
-        parser().reset();     /* clears, adds help & version opts */
+        p.reset();                      /* clears, adds help & version opts */
         for (int i = 0; i < optcount; ++i)
         {
             const options_spec * opts_ptr = &opts[i];
@@ -93,7 +98,7 @@ create_option_list (const options_spec * opts, int optcount)
              *  modified and read_from_cli always false at first.
              */
 
-            cfg::options::spec os;
+            cfg::options::spec os{};        /* value-initialize the flags       */
             std::string name = opts_ptr->option_name;
             os.option_code = opts_ptr->option_code;
             os.option_kind = okind;
@@ -113,12 +118,18 @@ create_option_list (const options_spec * opts, int optcount)
 
 #endif // defined USER_CONSTRUCTOR_FOR_OPTIONS_SPEC
 
-            parser().add(op);
+            p.add(op);
         }
     }
     return result;
 }
 
+bool
+create_option_list (const options_spec * opts, int optcount)
+{
+    return fill_option_list(parser(), opts, optcount);
+}
+
 /**
  *  Parses a command-line.  Assumes that create_option_list() has
  *  been called already.
@@ -197,6 +208,174 @@ version_request (void)
     return parser().version_request();
 }
 
+/*--------------------------------------------------------------------------
+ * Handle-based functions
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  The opaque parser handle. The text buffers hold the most recent results
+ *  of cfg66_parser_help_text() and cfg66_parser_debug_text(), so that the
+ *  returned pointers remain valid until the next such call on this handle.
+ */
+
+struct cfg66_parser
+{
+    cli::parser parser_object;
+    std::string help_buffer;
+    std::string debug_buffer;
+};
+
+/**
+ *  Creates a parser handle holding the stock options plus the given
+ *  options. No exceptions escape to the C caller.
+ *
+ * \return
+ *      Returns the new handle, or a null pointer if the options could not
+ *      be added or memory ran out. Free it with cfg66_parser_destroy().
+ */
+
+cfg66_parser *
+cfg66_parser_create (const options_spec * opts, int optcount)
+{
+    cfg66_parser * result = nullptr;
+    try
+    {
+        result = new (std::nothrow) cfg66_parser;
+        if (not_nullptr(result))
+        {
+            if (! fill_option_list(result->parser_object, opts, optcount))
+            {
+                delete result;
+                result = nullptr;
+            }
+        }
+    }
+    catch (...)
+    {
+        delete result;
+        result = nullptr;
+    }
+    return result;
+}
+
+void
+cfg66_parser_destroy (cfg66_parser * p)
+{
+    delete p;
+}
+
+void
+cfg66_parser_reset (cfg66_parser * p)
+{
+    if (not_nullptr(p))
+        p->parser_object.reset();
+}
+
+bool
+cfg66_parser_parse (cfg66_parser * p, int argc, char * argv [])
+{
+    bool result = not_nullptr(p);
+    if (result)
+        result = p->parser_object.parse(argc, argv);
+
+    return result;
+}
+
+bool
+cfg66_parser_change_value
+(
+    cfg66_parser * p, const char * name, const char * value, bool fromcli
+)
+{
+    bool result = not_nullptr(p) && not_nullptr_2(name, value);
+    if (result)
+        result = p->parser_object.change_value(name, value, fromcli);
+
+    return result;
+}
+
+/**
+ *  Provides zero-copy access to the value of an option. The pointer refers
+ *  to the value stored in the option, and is valid until the option is
+ *  changed or the handle is destroyed or reset.
+ *
+ * \param p
+ *      The parser handle.
+ *
+ * \param name
+ *      The long name or code of the option.
+ *
+ * \param [out] value
+ *      Receives a pointer to the null-terminated value.
+ *
+ * \param [out] length
+ *      Receives the length of the value. Can be null if not needed.
+ *
+ * \return
+ *      Returns true if the option exists.
+ */
+
+bool
+cfg66_parser_value
+(
+    const cfg66_parser * p, const char * name,
+    const char ** value, size_t * length
+)
+{
+    bool result = not_nullptr(p) && not_nullptr_2(name, value);
+    if (result)
+    {
+        const cfg::options & opts = p->parser_object.option_set();
+        result = opts.option_exists(name);
+        if (result)
+        {
+            const std::string & v = opts.find_spec(name).option_value;
+            *value = v.c_str();
+            if (not_nullptr(length))
+                *length = v.length();
+        }
+    }
+    return result;
+}
+
+const char *
+cfg66_parser_help_text (cfg66_parser * p)
+{
+    if (is_nullptr(p))
+        return "";
+
+    p->help_buffer = p->parser_object.help_text();
+    return p->help_buffer.c_str();
+}
+
+const char *
+cfg66_parser_debug_text (cfg66_parser * p)
+{
+    if (is_nullptr(p))
+        return "";
+
+    p->debug_buffer = p->parser_object.debug_text();
+    return p->debug_buffer.c_str();
+}
+
+const char *
+cfg66_parser_error_msg (const cfg66_parser * p)
+{
+    return not_nullptr(p) ? p->parser_object.error_msg().c_str() : "" ;
+}
+
+bool
+cfg66_parser_help_request (const cfg66_parser * p)
+{
+    return not_nullptr(p) && p->parser_object.help_request();
+}
+
+bool
+cfg66_parser_version_request (const cfg66_parser * p)
+{
+    return not_nullptr(p) && p->parser_object.version_request();
+}
+
 /*
  * cliparser_c.cpp
  *
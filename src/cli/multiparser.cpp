@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-06-24
- * \updates       2024-07-27
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      The limitations of command-line options as implemented in cli::parser
@@ -36,8 +36,14 @@
  *      the option to the "config-type / sections-name / option-name" trio,
  *      and use those string to navigate to the desired option. In this case,
  *      we have to use a brute-force search to find the option code or name.
+ *
+ *      To avoid doing that search for every token, cli_mappings_add() also
+ *      resolves each option, once, to a "route": the target options object
+ *      and the option in it. Parsing then takes one lookup per token.
  */
 
+#include <algorithm>                    /* std::lower_bound()               */
+
 #include "c_macros.h"                   /* not_nullptr()                    */
 #include "cli/multiparser.hpp"          /* cli::multiparser class           */
 #include "cfg/inimanager.hpp"           /* cfg::inimanager & inisections    */
@@ -62,7 +68,9 @@ multiparser::multiparser (cfg::inimanager & mgr) :
     m_ini_manager       (mgr),
     m_current_options   (nullptr),
     m_code_mappings     (),
-    m_cli_mappings      ()
+    m_cli_mappings      (),
+    m_name_routes       (),
+    m_code_routes       ()
 {
     // no code; QUESTION: should we set m_current_options (null at this point)
     // to the current value of options_set()?
@@ -148,7 +156,10 @@ multiparser::cli_mappings_add (cfg::inisections::specification & spec)
  *      section. (A better name might be "global" options.) The default is
  *      an empty string.
  *
- *  In ini_set_test, this is the one called.
+ *  In ini_set_test, this is the one called. Adding an option again for the
+ *  same configuration type and section is not a conflict, and is ignored;
+ *  this lets an application map its options before adding their
+ *  inisections.
  */
 
 bool
@@ -179,7 +190,7 @@ multiparser::cli_mappings_add
                         printf("Inserted <'%c','%s'>\n", code, name.c_str());
 #endif
                     }
-                    else
+                    else if (r.first->second != name)   /* not a re-add     */
                     {
                         char tmp[64];
                         snprintf
@@ -204,8 +215,13 @@ multiparser::cli_mappings_add
                         configsection.c_str()
                     );
 #endif
+                    add_route(name, code, configtype, configsection);
                 }
-                else
+                else if
+                (
+                    r.first->second.config_type != configtype ||
+                    r.first->second.config_section != configsection
+                )
                 {
                     char tmp[64];
                     snprintf
@@ -223,6 +239,220 @@ multiparser::cli_mappings_add
     return result;
 }
 
+/**
+ *  Adds a route for the option to the routes sorted by name and, if the
+ *  option has a code, to the routes indexed by code. As with the code
+ *  mappings, the first option to claim a code keeps it.
+ *
+ *  The route is added even if the section of the option is not active
+ *  yet; it is resolved when the option is parsed. The inisections objects
+ *  are held in a std::map in the inimanager, and their inisection objects
+ *  do not change after creation, so the pointers remain valid.
+ */
+
+void
+multiparser::add_route
+(
+    const std::string & name,
+    char code,
+    const std::string & configtype,
+    const std::string & configsection
+)
+{
+    route rt{name, duo{configtype, configsection}, nullptr, nullptr, 0};
+    (void) resolve_route(rt);               /* if the section is active     */
+
+    auto rit = std::lower_bound
+    (
+        m_name_routes.begin(), m_name_routes.end(), name,
+        [] (const route & r, const std::string & n)
+        {
+            return r.route_name < n;
+        }
+    );
+    m_name_routes.insert(rit, rt);
+
+    unsigned char c = static_cast<unsigned char>(code);
+    if (c > ' ' && c < code_table_size)
+    {
+        if (m_code_routes.empty())
+            m_code_routes.assign(code_table_size, route{});
+
+        if (m_code_routes[c].route_name.empty())
+            m_code_routes[c] = rt;
+    }
+}
+
+/**
+ *  Looks up the route for an option code or long name.
+ *
+ * \param name
+ *      Points to the start of the name. It need not be null-terminated.
+ *      A one-character name is treated as an option code.
+ *
+ * \param len
+ *      The number of characters in the name.
+ *
+ * \return
+ *      Returns a pointer to the route, or a null pointer if not found.
+ */
+
+const multiparser::route *
+multiparser::find_route (const char * name, std::size_t len) const
+{
+    const route * result = nullptr;
+    if (len == 1)
+    {
+        unsigned char c = static_cast<unsigned char>(name[0]);
+        if (c < m_code_routes.size())
+        {
+            if (! m_code_routes[c].route_name.empty())
+                result = &m_code_routes[c];
+        }
+    }
+    else if (len > 1)
+    {
+        std::size_t lo = 0;
+        std::size_t hi = m_name_routes.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            const route & r = m_name_routes[mid];
+            int cmp = r.route_name.compare(0, std::string::npos, name, len);
+            if (cmp == 0)
+            {
+                result = &r;
+                break;
+            }
+            else if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+    }
+    return result;
+}
+
+multiparser::route *
+multiparser::find_route (const char * name, std::size_t len)
+{
+    return const_cast<route *>
+    (
+        static_cast<const multiparser &>(*this).find_route(name, len)
+    );
+}
+
+/**
+ *  Makes sure that a route points to its option. If the options object
+ *  found earlier has not gained or lost options since, nothing is done.
+ *  Otherwise the inisection is looked up again, and the option found in
+ *  it.
+ *
+ * \param rt
+ *      The route to update. It need not be one of the routes of this
+ *      multiparser.
+ *
+ * \return
+ *      Returns true if the option was found in an active section.
+ */
+
+bool
+multiparser::resolve_route (route & rt) const
+{
+    bool result = not_nullptr(rt.route_options) &&
+        rt.route_options->generation() == rt.route_generation;
+
+    if (! result)
+    {
+        cfg::inisection & ini = m_ini_manager.find_inisection
+        (
+            rt.route_duo.config_type, rt.route_duo.config_section
+        );
+        rt.route_options = nullptr;
+        rt.route_option = nullptr;
+        if (ini.active())
+        {
+            cfg::options & opts = ini.option_set();
+            const cfg::options & copts = opts;      /* do not bump the gen  */
+            auto oit = copts.option_pairs().find(rt.route_name);
+            result = oit != copts.option_pairs().end();
+            if (result)
+            {
+                rt.route_options = &opts;
+                rt.route_option = const_cast<lookup_entry>(&(*oit));
+                rt.route_generation = opts.generation();
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Looks up an option by code or long name, without changing which options
+ *  object is current.
+ *
+ * \return
+ *      Returns a pointer to the option (name/spec pair), or a null pointer if
+ *      not found or if its section is not active.
+ */
+
+multiparser::lookup_entry
+multiparser::lookup_name (const char * name, std::size_t len) const
+{
+    lookup_entry result = nullptr;
+    const route * rt = find_route(name, len);
+    if (not_nullptr(rt))
+    {
+        route temp = *rt;
+        if (resolve_route(temp))
+            result = temp.route_option;
+    }
+    return result;
+}
+
+/**
+ *  Looks up the route for an option code or long name, and makes the
+ *  options object holding the option the current option set, so that the
+ *  parser functions operate on it. If the section of the option is not
+ *  active, the option is to be skipped, as it cannot be set.
+ *
+ * \param [out] inactive
+ *      Set to true if the option has a route, but its section is not
+ *      active.
+ *
+ * \return
+ *      Returns a pointer to the option (name/spec pair), or a null pointer if
+ *      not found or inactive.
+ */
+
+multiparser::lookup_entry
+multiparser::select_option
+(
+    const char * name, std::size_t len, bool & inactive
+)
+{
+    lookup_entry result = nullptr;
+    route * rt = find_route(name, len);
+    inactive = false;
+    if (not_nullptr(rt))
+    {
+        if (resolve_route(*rt))
+        {
+            m_current_options = rt->route_options;
+            result = rt->route_option;
+        }
+        else
+        {
+            const cfg::inisection & ini = m_ini_manager.find_inisection
+            (
+                rt->route_duo.config_type, rt->route_duo.config_section
+            );
+            inactive = ini.inactive();
+        }
+    }
+    return result;
+}
+
 /**
  *
  */
@@ -290,11 +520,9 @@ multiparser::find_option_set
 /**
  *  Provides an override to look up the desired option set.
  *
- *  -#  If the token is a code (e.g. "-i"), then the corresponding long
- *      option name is looked up.
- *
- *  After that, essentially reimplements parser::parse(); will refine in the
- *  near future.
+ *  Each token is routed directly, via lookup_name(), to the options object
+ *  holding it, and then handled by the same code as the fast-lookup mode of
+ *  cli::parser. See cli::parser::fast_parse().
  */
 
 bool
@@ -303,70 +531,9 @@ multiparser::parse (int argc, char * argv [])
     bool result = not_nullptr(argv) && ! has_error();
     if (result && argc > 1)
     {
-        for (int i = 1; i < argc; ++i)      /* token 0 might be app name    */
-        {
-            std::string token = argv[i];
-            if (token == "--")              /* GNU end-of-options marker    */
-                break;
-
-            if (token == "-")               /* ill-formed token, bug out    */
-                break;
-
-            if (token[0] != '-')            /* probably a value, so skip    */
-                continue;
-
-            /*
-             *  1.  Look up the long name if needed.
-             */
-
-            std::string longname;
-            if (token.length() == 2)        /* format of a code: "-x"       */
-            {
-                char code = token[1];
-                auto it = code_mappings().find(code);
-                if (it != code_mappings().end())
-                    longname = it->second;
-            }
-            else if (token.length() > 2)
-            {
-                longname = token.substr(2);
-            }
-            if (token.empty())
-            {
-                result = false;
-                util::error_message("empty token");
-                break;
-            }
-
-            /*
-             *  2.  Look up the long name's configuration type and section.
-             *      Note that extract_value() separates the name and value
-             *      of a token like "name=value"; we currently need only
-             *      the name part. FIXME!
-             */
-
-            std::string value;
-            /* bool has_value = */ extract_value(longname, value);
-            auto dit = cli_mappings().find(longname);
-            if (dit != cli_mappings().end())
-            {
-                std::string configtype = dit->second.config_type;
-                std::string configsection = dit->second.config_section;
-
-                /*
-                 *  3.  Get the option-set from the INI section.
-                 */
-
-                m_current_options = & find_option_set(configtype, configsection);
-                if (m_current_options->active())
-                    result = parse_value(argc, argv, i, token);
-            }
-            else
-            {
-                result = false;
-                util::error_message("option lookup failed", token);
-            }
-        }
+        result = parse_tokens(argc, argv);
+        if (has_error())
+            util::error_message("option lookup failed", error_msg());
     }
     if (result)
     {
@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-07-24
+ * \updates       2026-10-18
  * \license       See above.
  *
  *      While this parser follows the basics of GNU getopt fairly well,
@@ -41,8 +41,14 @@
  *      -   Support for "overflow" options has been added.
  *      -   Callers can keep adding options to the set of options with
  *          no other additional code.
+ *      -   An optional fast-lookup mode resolves options through tables
+ *          built once, instead of a lookup (and string copies) per token.
+ *      -   Arguments can be read from "@argsfile" response files.
  */
 
+#include <cctype>                       /* std::isspace()                   */
+#include <cstring>                      /* std::strcmp(), std::strlen()     */
+#include <fstream>                      /* std::ifstream                    */
 #include <iostream>                     /* std::cout                        */
 #include <sstream>                      /* std::ostringstream               */
 
@@ -75,7 +81,14 @@ parser::parser () :
     m_investigate_request   (false),
     m_description_request   (false),
     m_use_log_file          (false),
-    m_log_file              ()
+    m_log_file              (),
+    m_fast_lookup           (false),
+    m_name_table            (),
+    m_code_table            (),
+    m_lookup_owner          (nullptr),
+    m_lookup_generation     (0),
+    m_value_scratch         (),
+    m_args_file_depth       (0)
 {
     // no code needed
 }
@@ -117,7 +130,14 @@ parser::parser
     m_investigate_request   (false),
     m_description_request   (false),
     m_use_log_file          (false),
-    m_log_file              ()
+    m_log_file              (),
+    m_fast_lookup           (false),
+    m_name_table            (),
+    m_code_table            (),
+    m_lookup_owner          (nullptr),
+    m_lookup_generation     (0),
+    m_value_scratch         (),
+    m_args_file_depth       (0)
 {
     // no code needed
 }
@@ -138,6 +158,42 @@ parser::parse (int argc, char * argv [])
 {
     bool result = not_nullptr(argv) && ! has_error();
     if (result && argc > 1)
+        result = parse_tokens(argc, argv);
+
+    if (result)
+    {
+        description_request(option_set().boolean_value("description"));
+        help_request(option_set().boolean_value("help"));
+        version_request(option_set().boolean_value("version"));
+        inspect_request(option_set().boolean_value("inspect"));
+        verbose_request(option_set().boolean_value("verbose"));
+        util::set_verbose(verbose_request());           /* see msgfunctions */
+        investigate_request(option_set().boolean_value("investigate"));
+        util::set_investigate(investigate_request());   /* see msgfunctions */
+        log_file(option_set().value("log"));
+        use_log_file(! log_file().empty());
+    }
+    return result;
+}
+
+/**
+ *  The main loop of parse(), also used for each line of an "@argsfile".
+ *  Token 0 is skipped, as it might be the application name.
+ *
+ * \return
+ *      Returns true if the last option was parsed successfully, or false
+ *      if parsing had to stop.
+ */
+
+bool
+parser::parse_tokens (int argc, char * argv [])
+{
+    bool result = true;
+    if (fast_lookup())
+    {
+        result = fast_parse(argc, argv);
+    }
+    else
     {
         for (int i = 1; i < argc; ++i)      /* token 0 might be app name    */
         {
@@ -148,11 +204,21 @@ parser::parse (int argc, char * argv [])
             if (token == "-")               /* ill-formed token, bug out    */
                 break;
 
+            if (token[0] == '@' && token.length() > 1)  /* an args file     */
+            {
+                result = parse_args_file(token.substr(1));
+                if (result)
+                    continue;
+                else
+                    break;
+            }
+
             if (token_match(token, "option"))
             {
-                if (argv[i + 1][0] != '-')  /* needs a non-option argument  */
+                bool more = (i + 1) < argc;
+                if (more && argv[i + 1][0] != '-')  /* needs non-option arg */
                 {
-                    std::string name;
+                    std::string name = argv[++i];
                     std::string value;
                     (void) extract_value(name, value);
                     bool good = parse_o_option(name, value);
@@ -161,8 +227,8 @@ parser::parse (int argc, char * argv [])
                         if (name == "log")
                         {
                             use_log_file(true);
-                            if (! name.empty())
-                                log_file(name);
+                            if (! value.empty())
+                                log_file(value);
                         }
                         continue;
                     }
@@ -180,22 +246,100 @@ parser::parse (int argc, char * argv [])
             result = parse_value(argc, argv, i, token);
         }
     }
+    return result;
+}
+
+/**
+ *  Handles an "@argsfile" token, as used by many compilers and linkers to
+ *  get around limits on the length of a command line.
+ *
+ *  The file is read one line at a time. Each line is split using
+ *  util::tokenize_quoted(), and its tokens are parsed as if they had
+ *  appeared on the command line at the location of the "@argsfile" token.
+ *  Only one line of tokens is held at a time, so an option and its value
+ *  must be on the same line. Empty lines and lines starting with "#" are
+ *  skipped. An args file can refer to other args files, up to a depth of
+ *  args_file_depth_max.
+ *
+ * \param filename
+ *      The name of the file, without the "@".
+ *
+ * \return
+ *      Returns true if the file was read and all of its lines parsed. If not,
+ *      the error message is prefixed with "filename:line: ".
+ */
+
+bool
+parser::parse_args_file (const std::string & filename)
+{
+    bool result = m_args_file_depth < args_file_depth_max;
     if (result)
     {
-        description_request(option_set().boolean_value("description"));
-        help_request(option_set().boolean_value("help"));
-        version_request(option_set().boolean_value("version"));
-        inspect_request(option_set().boolean_value("inspect"));
-        verbose_request(option_set().boolean_value("verbose"));
-        util::set_verbose(verbose_request());           /* see msgfunctions */
-        investigate_request(option_set().boolean_value("investigate"));
-        util::set_investigate(investigate_request());   /* see msgfunctions */
-        log_file(option_set().value("log"));
-        use_log_file(! log_file().empty());
+        std::ifstream file(filename);
+        result = file.is_open();
+        if (result)
+        {
+            std::string line;
+            std::vector<char *> lineargs;
+            int lineno = 0;
+            ++m_args_file_depth;
+            while (std::getline(file, line))
+            {
+                ++lineno;
+                lib66::tokenization tokens = util::tokenize_quoted(line);
+                if (tokens.empty() || tokens[0].empty() || tokens[0][0] == '#')
+                    continue;
+
+                lineargs.assign(1, nullptr);    /* no application name      */
+                for (auto & t : tokens)
+                    lineargs.push_back(&t[0]);
+
+                int count = int(lineargs.size());
+                lineargs.push_back(nullptr);    /* like argv[argc]          */
+                result = parse_tokens(count, lineargs.data());
+                if (! result)
+                {
+                    args_file_error(filename, lineno, error_msg());
+                    break;
+                }
+            }
+            --m_args_file_depth;
+        }
+        else
+            args_file_error(filename, 0, "cannot open args file");
     }
+    else
+        args_file_error(filename, 0, "args files nested too deeply");
+
     return result;
 }
 
+/**
+ *  Sets the error flag and an error message of the form "file:line: msg".
+ *  A line number of 0 is not shown.
+ */
+
+void
+parser::args_file_error
+(
+    const std::string & filename,
+    int lineno,
+    const std::string & msg
+)
+{
+    std::string errmsg = filename;
+    errmsg += ":";
+    if (lineno > 0)
+    {
+        errmsg += std::to_string(lineno);
+        errmsg += ":";
+    }
+    errmsg += " ";
+    errmsg += msg.empty() ? std::string("invalid arguments") : msg ;
+    m_has_error = true;
+    m_error_msg = errmsg;
+}
+
 /**
  *  Determine if an option name is present in the command-line.
  *
@@ -279,9 +423,11 @@ parser::check_option
  * \param argv
  *      Command-line argument array from main().
  *
- * \param index
+ * \param [inout] index
  *      The command-line index of the current option; the next string
- *      after that one might be a value for the option.
+ *      after that one might be a value for the option. If so, the index
+ *      is moved to the value, so that the caller does not treat the value
+ *      as an option or an "@argsfile".
  *
  * \param token
  *      The name of the current option. If it is an option (as opposed
@@ -295,7 +441,7 @@ parser::check_option
 bool
 parser::parse_value
 (
-    int argc, char * argv [], int index,
+    int argc, char * argv [], int & index,
     const std::string & token
 )
 {
@@ -329,7 +475,10 @@ parser::parse_value
             std::string code(1, name[i]);               /* a bit tricky     */
             result = change_value(code, "true", true);  /* set the "bit"    */
             if (! result)
+            {
+                value_error(code, "");
                 break;
+            }
         }
     }
     else
@@ -353,32 +502,41 @@ parser::parse_value
             else if (((index + 1) < argc))              /* more?            */
             {
                 if (argv[index + 1][0] != '-')          /* can't be option  */
-                    value = argv[index + 1];            /* too tricky       */
+                    value = argv[++index];              /* too tricky       */
 
             }
             result = change_value(name, value, true);
         }
         if (! result)
+            value_error(name, value);
+    }
+    return result;
+}
+
+/**
+ *  Sets the error flag and message for an option that could not be set,
+ *  preferring the error message of the options object, if any.
+ */
+
+void
+parser::value_error (const std::string & name, const std::string & value)
+{
+    m_has_error = true;
+    if (option_set().has_error())           /* use the options' error msg   */
+    {
+        m_error_msg = option_set().error_msg();
+    }
+    else                                    /* avoid replacing existing msg */
+    {
+        m_error_msg = "Option '";
+        m_error_msg += name;
+        if (! value.empty())
         {
-            m_has_error = true;
-            if (option_set().has_error())   /* use the options' error msg   */
-            {
-                m_error_msg = option_set().error_msg();
-            }
-            else                            /* avoid replacing existing msg */
-            {
-                m_error_msg = "Option '";
-                m_error_msg += name;
-                if (! value.empty())
-                {
-                    m_error_msg += "=";
-                    m_error_msg += value;
-                }
-                m_error_msg += "' not found";
-            }
+            m_error_msg += "=";
+            m_error_msg += value;
         }
+        m_error_msg += "' not found";
     }
-    return result;
 }
 
 /**
@@ -391,7 +549,8 @@ parser::parse_value
  *      -   --option name
  *      -   --option name=value
  *
- *  The first one is a boolean value, and the second one is a compound value.
+ *  The first one is a boolean value (set to "true"), and the second one is a
+ *  compound value.
  *
  *  These options are specified in the same was a regular options, except
  *  that the character code is null. Of course, all "o option" long names must
@@ -408,7 +567,10 @@ parser::parse_o_option
     const std::string & name,  const std::string & value
 )
 {
-    return change_value(name, value, true);
+    if (value.empty() && is_boolean(name))
+        return change_value(name, "true", true);
+    else
+        return change_value(name, value, true);
 }
 
 /**
@@ -501,6 +663,8 @@ parser::token_match
                     std::string tokpart = token.substr(1);
                     result = tokpart == opt;
                 }
+                else
+                    result = false;         /* e.g. "-xyz" is not a match   */
             }
             else
             {
@@ -512,6 +676,394 @@ parser::token_match
     return result;
 }
 
+/*--------------------------------------------------------------------------
+ * Fast lookup
+ *--------------------------------------------------------------------------*/
+
+/**
+ *  A std::isspace() that is safe for plain (possibly signed) characters.
+ */
+
+static bool
+is_space (char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+/**
+ *  Emulates util::tokenize(token, ":=") without making any strings. The
+ *  token is a compound token if it has exactly two non-empty runs of
+ *  non-separator characters. Each run is trimmed of white space, as
+ *  tokenize() does.
+ *
+ * \return
+ *      Returns true if the token is a "name=value" or "name:value" token.
+ *      In that case the name and value spans are filled in.
+ */
+
+static bool
+split_compound
+(
+    const char * token,
+    const char * & name, std::size_t & namelen,
+    const char * & value, std::size_t & valuelen
+)
+{
+    const char * starts[2] = { nullptr, nullptr };
+    std::size_t lengths[2] = { 0, 0 };
+    int runs = 0;
+    const char * p = token;
+    while (*p != 0)
+    {
+        if (*p == ':' || *p == '=')
+        {
+            ++p;
+            continue;
+        }
+
+        const char * start = p;
+        while (*p != 0 && *p != ':' && *p != '=')
+            ++p;
+
+        if (runs < 2)
+        {
+            std::size_t len = std::size_t(p - start);
+            while (len > 0 && is_space(start[0]))
+            {
+                ++start;
+                --len;
+            }
+            while (len > 0 && is_space(start[len - 1]))
+                --len;
+
+            starts[runs] = start;
+            lengths[runs] = len;
+        }
+        ++runs;
+    }
+    bool result = runs == 2;
+    if (result)
+    {
+        name = starts[0];
+        namelen = lengths[0];
+        value = starts[1];
+        valuelen = lengths[1];
+    }
+    return result;
+}
+
+/**
+ *  Builds the fast-lookup tables from the current option set. The
+ *  std::map of options is already sorted by name, so the name table needs
+ *  no sorting. If two options share a code, the first one wins, as in
+ *  cfg::options::long_name().
+ *
+ * \return
+ *      Returns true if there is at least one option in the table.
+ */
+
+bool
+parser::build_lookup ()
+{
+    cfg::options & opts = option_set();
+    m_name_table.clear();
+    m_name_table.reserve(opts.size());
+    m_code_table.assign(code_table_size, nullptr);
+    for (auto & op : opts.option_pairs())
+    {
+        unsigned char c = static_cast<unsigned char>(op.second.option_code);
+        m_name_table.push_back(&op);
+        if (c > ' ' && c < code_table_size && is_nullptr(m_code_table[c]))
+            m_code_table[c] = &op;
+    }
+    m_lookup_owner = &opts;
+    m_lookup_generation = opts.generation();
+    return ! m_name_table.empty();
+}
+
+/**
+ *  Indicates if the fast-lookup tables were built from the current option
+ *  set, and no option has been added to or erased from that set since.
+ */
+
+bool
+parser::lookup_ready () const
+{
+    const cfg::options & opts = option_set();
+    return m_lookup_owner == &opts &&
+        m_lookup_generation == opts.generation();
+}
+
+/**
+ *  Looks up an option by long name or by code, without creating a string.
+ *  As in cfg::options::find_match(), a one-character name is treated as an
+ *  option code.
+ *
+ * \param name
+ *      Points to the start of the name. It need not be null-terminated.
+ *
+ * \param len
+ *      The number of characters in the name.
+ *
+ * \return
+ *      Returns a pointer to the name/spec pair, or a null pointer if not
+ *      found.
+ */
+
+parser::lookup_entry
+parser::lookup_name (const char * name, std::size_t len) const
+{
+    lookup_entry result = nullptr;
+    if (len == 1)
+    {
+        unsigned char c = static_cast<unsigned char>(name[0]);
+        if (c < m_code_table.size())
+            result = m_code_table[c];
+    }
+    else if (len > 1)
+    {
+        std::size_t lo = 0;
+        std::size_t hi = m_name_table.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            lookup_entry e = m_name_table[mid];
+            int cmp = e->first.compare(0, std::string::npos, name, len);
+            if (cmp == 0)
+            {
+                result = e;
+                break;
+            }
+            else if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Looks up an option for the fast-lookup parse, and prepares to change
+ *  it. This base version is just lookup_name(); cli::multiparser
+ *  overrides it to make the options object holding the option current.
+ *
+ * \param [out] inactive
+ *      Set to true if the option is known, but cannot be set now, so that
+ *      the caller can skip it. The base version always sets it to false.
+ *
+ * \return
+ *      Returns a pointer to the option, or a null pointer if not found or
+ *      inactive.
+ */
+
+parser::lookup_entry
+parser::select_option (const char * name, std::size_t len, bool & inactive)
+{
+    inactive = false;
+    return lookup_name(name, len);
+}
+
+/**
+ *  The fast-lookup version of the loop in parse(). It follows the same
+ *  rules, but reads argv[] in place and sets each option found directly
+ *  through its table entry.
+ */
+
+bool
+parser::fast_parse (int argc, char * argv [])
+{
+    bool result = true;
+    if (! lookup_ready())
+        (void) build_lookup();
+
+    for (int i = 1; i < argc; ++i)          /* token 0 might be app name    */
+    {
+        const char * token = argv[i];
+        if (is_nullptr(token))
+            break;
+
+        if (token[0] == '-')
+        {
+            if (token[1] == 0)              /* ill-formed token, bug out    */
+                break;
+
+            if (token[1] == '-' && token[2] == 0)   /* GNU end-of-options   */
+                break;
+        }
+        else if (token[0] == '@' && token[1] != 0)  /* an args file         */
+        {
+            result = parse_args_file(&token[1]);
+            if (result)
+                continue;
+            else
+                break;
+        }
+        else
+            continue;                       /* probably a value, so skip    */
+
+        const char * longpart = nullptr;
+        if (token[1] == '-')
+            longpart = &token[2];
+        else if (m_alternative)
+            longpart = &token[1];
+
+        if (not_nullptr(longpart) && std::strcmp(longpart, "option") == 0)
+        {
+            bool more = (i + 1) < argc;
+            if (more && argv[i + 1][0] != '-')  /* needs non-option arg     */
+            {
+                const char * arg = argv[++i];
+                const char * name = arg;
+                std::size_t namelen = std::strlen(arg);
+                const char * value = nullptr;
+                std::size_t valuelen = 0;
+                if (! split_compound(arg, name, namelen, value, valuelen))
+                {
+                    name = arg;
+                    namelen = std::strlen(arg);
+                }
+
+                bool inactive;
+                lookup_entry e = select_option(name, namelen, inactive);
+                if (inactive)
+                    continue;
+
+                result = not_nullptr(e);
+                if (result)
+                {
+                    cfg::options::spec & sp = e->second;
+                    if (not_nullptr(value))
+                        m_value_scratch.assign(value, valuelen);
+                    else if (option_set().option_is_boolean(sp))
+                        m_value_scratch = "true";
+                    else
+                        m_value_scratch.clear();
+
+                    result = option_set().change_spec_value
+                    (
+                        e->first, sp, m_value_scratch, true
+                    );
+                }
+                if (! result)
+                    break;
+            }
+            continue;
+        }
+        result = fast_parse_value(argc, argv, i);
+    }
+    return result;
+}
+
+/**
+ *  The fast-lookup version of parse_value(). See that function for the
+ *  rules, including the moving of \a index past a value.
+ */
+
+bool
+parser::fast_parse_value (int argc, char * argv [], int & index)
+{
+    bool result = false;
+    const char * token = argv[index];
+    const char * name = &token[1];          /* count the first hyphen       */
+    bool boolvalue = true;                  /* used for boolean options     */
+    bool singledash = true;
+    if (std::strncmp(token, "--no-", 5) == 0)
+    {
+        boolvalue = false;
+        name = &token[5];
+        singledash = false;
+    }
+    else if (token[1] == '-')
+    {
+        ++name;
+        singledash = false;
+    }
+
+    std::size_t namelen = std::strlen(name);
+    if (singledash && namelen > 1)          /* an argument like "-xyz"      */
+    {
+        for (std::size_t c = 0; c < namelen; ++c)
+        {
+            bool inactive;
+            lookup_entry e = select_option(&name[c], 1, inactive);
+            if (inactive)
+            {
+                result = true;
+                continue;
+            }
+            result = not_nullptr(e);
+            if (result)
+            {
+                m_value_scratch = "true";
+                result = option_set().change_spec_value
+                (
+                    e->first, e->second, m_value_scratch, true
+                );
+            }
+            if (! result)
+            {
+                value_error(std::string(1, name[c]), "");
+                break;
+            }
+        }
+    }
+    else
+    {
+        const char * key = name;
+        std::size_t keylen = namelen;
+        const char * value = nullptr;
+        std::size_t valuelen = 0;
+        bool compound = split_compound(name, key, keylen, value, valuelen);
+        if (! compound)
+        {
+            key = name;
+            keylen = namelen;
+        }
+
+        bool inactive;
+        lookup_entry e = select_option(key, keylen, inactive);
+        if (inactive)
+        {
+            result = true;                  /* skip it, and any value       */
+            if (! compound && (index + 1) < argc && argv[index + 1][0] != '-')
+                ++index;
+        }
+        else
+        {
+            if (compound)
+            {
+                m_value_scratch.assign(value, valuelen);
+            }
+            else if
+            (
+                not_nullptr(e) && option_set().option_is_boolean(e->second)
+            )
+            {
+                m_value_scratch = boolvalue ? "true" : "false" ;
+            }
+            else if ((index + 1) < argc && argv[index + 1][0] != '-')
+            {
+                m_value_scratch = argv[++index];
+            }
+            else
+                m_value_scratch.clear();
+
+            result = not_nullptr(e);
+            if (result)
+            {
+                result = option_set().change_spec_value
+                (
+                    e->first, e->second, m_value_scratch, true
+                );
+            }
+            if (! result)
+                value_error(std::string(key, keylen), m_value_scratch);
+        }
+    }
+    return result;
+}
+
 /**
  *  Provides default handling for informational options.
  *
@@ -0,0 +1,661 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          bytestream.cpp
+ *
+ *  This module declares/defines a class for reading big-endian data from a
+ *  file too large to be read into memory.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  bytevector, even in mapped mode, needs the whole file in its address
+ *  space. A bytestream holds only a window of the file, about two blocks:
+ *
+\verbatim
+        util::bytestream s;
+        if (s.open("recording.log"))
+        {
+            while (! s.done())
+            {
+                util::ulong tag = s.get_long();
+                util::ulong len = s.get_varinum();
+                util::byteview record = s.peek_view(len);
+                ... parse the record in place ...
+                s.skip(len);
+            }
+        }
+\endverbatim
+ *
+ *  The window is double-buffered. While the caller parses one block, a
+ *  background thread reads the next one into the other buffer. When the
+ *  caller runs out of bytes, the buffers are swapped, and the few unread
+ *  bytes of the old block are copied to just in front of the new one, so
+ *  that a value can straddle the two blocks. Nothing else is copied.
+ *
+ *  That room in front of each block is peek_max bytes, which is thus the
+ *  most that can be required, or peeked at, at once. A pointer or view
+ *  from peek() or peek_view() is good until the next call that can move
+ *  the window: any get, skip, require, or peek for more bytes than are
+ *  available().
+ *
+ *  If the thread cannot be started, each block is read when needed, so
+ *  the results are the same, only slower.
+ *
+ *  As in bytevector, a read past the end of the file yields 0 and sets
+ *  the error, which is reported once.
+ */
+
+#include <condition_variable>           /* std::condition_variable          */
+#include <cstdio>                       /* std::fopen(), std::fread()       */
+#include <cstring>                      /* std::memcpy()                    */
+#include <mutex>                        /* std::mutex, std::unique_lock     */
+#include <system_error>                 /* std::system_error                */
+#include <thread>                       /* std::thread                      */
+
+#include "util/bytestream.hpp"          /* util::bytestream class           */
+#include "util/msgfunctions.hpp"        /* util::errprint()                 */
+
+#if defined PLATFORM_LINUX
+#include <fcntl.h>                      /* ::posix_fadvise()                */
+#endif
+
+namespace util
+{
+
+/*-------------------------------------------------------------------------
+ * bytestream::reader
+ *-------------------------------------------------------------------------*/
+
+/**
+ *  Owns the file and the back buffer, and reads the next block into the
+ *  back buffer on its own thread. The block is read at an offset of
+ *  margin bytes, leaving room for the tail of the current block.
+ *
+ *  The back buffer belongs to the thread from request() until take()
+ *  returns, and to the caller the rest of the time.
+ */
+
+class bytestream::reader
+{
+
+private:
+
+    std::FILE * m_file;
+    util::bytes m_back;
+    size_t m_margin;
+    size_t m_block_size;
+    size_t m_count;
+    bool m_failed;
+    bool m_requested;
+    bool m_ready;
+    bool m_stop;
+    std::mutex m_lock;
+    std::condition_variable m_signal;
+    std::thread m_thread;
+
+public:
+
+    reader (std::FILE * f, size_t margin, size_t blocksize);
+    reader (const reader &) = delete;
+    reader & operator = (const reader &) = delete;
+    ~reader ();
+
+    void request ();
+    bool take (util::bytes & front, size_t & count);
+
+private:
+
+    void read_block ();
+    void run ();
+
+};
+
+bytestream::reader::reader (std::FILE * f, size_t margin, size_t blocksize) :
+    m_file          (f),
+    m_back          (margin + blocksize),
+    m_margin        (margin),
+    m_block_size    (blocksize),
+    m_count         (0),
+    m_failed        (false),
+    m_requested     (false),
+    m_ready         (false),
+    m_stop          (false),
+    m_lock          (),
+    m_signal        (),
+    m_thread        ()
+{
+    try
+    {
+        m_thread = std::thread(&reader::run, this);
+    }
+    catch (const std::system_error &)
+    {
+        // no thread, request() will read the block itself
+    }
+}
+
+bytestream::reader::~reader ()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stop = true;
+        }
+        m_signal.notify_all();
+        m_thread.join();
+    }
+    (void) std::fclose(m_file);
+}
+
+void
+bytestream::reader::read_block ()
+{
+    m_count = std::fread(m_back.data() + m_margin, 1, m_block_size, m_file);
+    m_failed = std::ferror(m_file) != 0;
+}
+
+/**
+ *  Starts the read of the next block.
+ */
+
+void
+bytestream::reader::request ()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_requested = true;
+        }
+        m_signal.notify_all();
+    }
+    else
+    {
+        read_block();
+        m_ready = true;
+    }
+}
+
+/**
+ *  Waits for the requested block, then swaps buffers with the caller.
+ *
+ * \param [inout] front
+ *      The caller's buffer, the same size as the back buffer. On return it
+ *      holds the new block, and the back buffer holds the old one.
+ *
+ * \param [out] count
+ *      The number of bytes read into the block; 0 at the end of the file.
+ *
+ * \return
+ *      Returns false if the read failed.
+ */
+
+bool
+bytestream::reader::take (util::bytes & front, size_t & count)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_signal.wait(guard, [this] { return m_ready; });
+    m_ready = false;
+    front.swap(m_back);
+    count = m_count;
+    return ! m_failed;
+}
+
+void
+bytestream::reader::run ()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    for (;;)
+    {
+        m_signal.wait(guard, [this] { return m_requested || m_stop; });
+        if (m_stop)
+            break;
+
+        m_requested = false;
+        guard.unlock();
+        read_block();                           /* the slow part, unlocked  */
+        guard.lock();
+        m_ready = true;
+        m_signal.notify_all();
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * bytestream
+ *-------------------------------------------------------------------------*/
+
+bytestream::bytestream () :
+    m_reader        (),
+    m_file_name     (),
+    m_buffer        (),
+    m_block_size    (0),
+    m_peek_max      (0),
+    m_window        (nullptr),
+    m_window_size   (0),
+    m_window_offset (0),
+    m_position      (0),
+    m_end_of_file   (true),
+    m_error_message (),
+    m_error_is_fatal(false)
+{
+    // no code
+}
+
+bytestream::~bytestream ()
+{
+    close();
+}
+
+/**
+ *  Opens a file and starts reading its first block.
+ *
+ * \param infilename
+ *      The file to read.
+ *
+ * \param blocksize
+ *      The size of each read. Two buffers of about this size are used. It
+ *      is made at least \a peekmax.
+ *
+ * \param peekmax
+ *      The most bytes that can be peeked at, or required, at once.
+ *
+ * \return
+ *      Returns true if the file was opened.
+ */
+
+bool
+bytestream::open
+(
+    const std::string & infilename,
+    size_t blocksize,
+    size_t peekmax
+)
+{
+    close();
+    m_error_message.clear();
+    m_error_is_fatal = false;
+    m_file_name = infilename;
+    if (peekmax == 0)
+        peekmax = 1;
+
+    if (blocksize < peekmax)
+        blocksize = peekmax;
+
+    std::FILE * f = std::fopen(infilename.c_str(), "rb");
+    bool result = not_nullptr(f);
+    if (result)
+    {
+        (void) std::setvbuf(f, nullptr, _IONBF, 0);     /* we read blocks   */
+#if defined PLATFORM_LINUX
+        (void) ::posix_fadvise(::fileno(f), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        m_block_size = blocksize;
+        m_peek_max = peekmax;
+        m_buffer.resize(peekmax + blocksize);
+        m_window = m_buffer.data() + peekmax;
+        m_end_of_file = false;
+        m_reader.reset(new reader(f, peekmax, blocksize));
+        m_reader->request();
+    }
+    else
+        (void) set_error("Failed to open file for reading");
+
+    return result;
+}
+
+/**
+ *  Stops the read-ahead thread, closes the file, and frees the buffers.
+ */
+
+void
+bytestream::close ()
+{
+    m_reader.reset();
+    util::bytes().swap(m_buffer);
+    m_window = nullptr;
+    m_window_size = m_window_offset = m_position = 0;
+    m_end_of_file = true;
+}
+
+/**
+ *  Moves the window to the next block. The unread bytes of the current
+ *  block, fewer than m_peek_max, go in front of the new block.
+ *
+ * \return
+ *      Returns false at the end of the file, or on a read error.
+ */
+
+bool
+bytestream::next_block ()
+{
+    bool result = ! m_end_of_file;
+    if (result)
+    {
+        size_t tail = available();
+        size_t tailoffset = position();
+        util::bytes & front = m_buffer;
+        size_t count = 0;
+        result = m_reader->take(front, count);
+        if (tail > 0)
+        {
+            /*
+             * take() swapped the buffers, so the tail is now in the back
+             * buffer, which the thread leaves alone until request().
+             */
+
+            util::byte * dest = front.data() + m_peek_max - tail;
+            std::memcpy(dest, m_window + m_position, tail);
+        }
+        m_window = front.data() + m_peek_max - tail;
+        m_window_size = tail + count;
+        m_window_offset = tailoffset;
+        m_position = 0;
+        if (! result)
+        {
+            m_end_of_file = true;
+            (void) set_error("Error reading");
+        }
+        else if (count == 0)
+        {
+            m_end_of_file = true;
+            result = false;
+        }
+        else
+            m_reader->request();
+    }
+    return result;
+}
+
+/**
+ *  Brings at least \a sz bytes into the window, if the file has them.
+ *  Running out of file is not an error here; asking for more than the
+ *  window can hold is.
+ */
+
+bool
+bytestream::fill (size_t sz)
+{
+    bool result = sz <= m_peek_max;
+    if (result)
+    {
+        while (available() < sz)
+        {
+            if (! next_block())
+                break;
+        }
+        result = available() >= sz;
+    }
+    else
+        (void) set_error("Request larger than the stream window");
+
+    return result;
+}
+
+/**
+ *  Moves ahead by any number of bytes, a block at a time if need be.
+ *
+ * \return
+ *      Returns false if the file ended first.
+ */
+
+bool
+bytestream::skip (size_t sz)
+{
+    bool result = true;
+    while (sz > available())
+    {
+        sz -= available();
+        m_position = m_window_size;
+        if (! next_block())
+        {
+            result = set_error("End of data skipping");
+            break;
+        }
+    }
+    if (result)
+        m_position += sz;
+
+    return result;
+}
+
+template <typename T>
+T
+bytestream::get_big ()
+{
+    T result = 0;
+    if (require(sizeof(T)))
+    {
+        result = load_big<T>(m_window + m_position);
+        m_position += sizeof(T);
+    }
+    else
+    {
+        m_position = m_window_size;             /* the rest is consumed     */
+        (void) set_error("End of data encountered");
+    }
+    return result;
+}
+
+util::byte
+bytestream::get_byte ()
+{
+    util::byte result = 0;
+    if (require(1))
+        result = m_window[m_position++];
+    else
+        (void) set_error("End of data encountered");
+
+    return result;
+}
+
+util::ushort
+bytestream::get_short ()
+{
+    return get_big<util::ushort>();
+}
+
+util::ulong
+bytestream::get_triple ()
+{
+    util::ulong result = 0;
+    if (require(3))
+    {
+        const util::byte * p = m_window + m_position;
+        result = (util::ulong(p[0]) << 16) | (util::ulong(p[1]) << 8) | p[2];
+        m_position += 3;
+    }
+    else
+    {
+        m_position = m_window_size;
+        (void) set_error("End of data encountered");
+    }
+    return result;
+}
+
+util::ulong
+bytestream::get_long ()
+{
+    return get_big<util::ulong>();
+}
+
+util::ulonglong
+bytestream::get_longlong ()
+{
+    return get_big<util::ulonglong>();
+}
+
+/**
+ *  Reads a MIDI Variable-Length Value, as bytevector::get_varinum() does.
+ */
+
+util::ulong
+bytestream::get_varinum ()
+{
+    util::ulong result = 0;
+    util::byte c;
+    while (((c = get_byte()) & 0x80) != 0x00)
+    {
+        result <<= 7;
+        result += c & 0x7F;
+    }
+    result <<= 7;
+    result += c & 0x7F;
+    return result;
+}
+
+/**
+ *  Copies bytes into a string. The length is not limited by the window.
+ *
+ * \return
+ *      Returns the string, cut short if the file ends first.
+ */
+
+std::string
+bytestream::get_string (size_t len)
+{
+    std::string result;
+    while (len > 0)
+    {
+        if (available() == 0 && ! next_block())
+        {
+            (void) set_error("End of data reading string");
+            break;
+        }
+        size_t count = available() < len ? available() : len ;
+        const char * p = reinterpret_cast<const char *>(m_window + m_position);
+        result.append(p, count);
+        m_position += count;
+        len -= count;
+    }
+    return result;
+}
+
+util::byte
+bytestream::peek_byte ()
+{
+    return peek_byte(0);
+}
+
+/**
+ *  Gets a byte ahead of the read position, without moving it.
+ *
+ * \param offset
+ *      The distance ahead; it must be less than the peek_max of open().
+ */
+
+util::byte
+bytestream::peek_byte (size_t offset)
+{
+    const util::byte * p = peek(offset + 1);
+    return not_nullptr(p) ? p[offset] : 0 ;
+}
+
+util::ushort
+bytestream::peek_short ()
+{
+    const util::byte * p = peek(2);
+    return not_nullptr(p) ? load_big<util::ushort>(p) : 0 ;
+}
+
+util::ulong
+bytestream::peek_long ()
+{
+    const util::byte * p = peek(4);
+    return not_nullptr(p) ? load_big<util::ulong>(p) : 0 ;
+}
+
+util::ulonglong
+bytestream::peek_longlong ()
+{
+    const util::byte * p = peek(8);
+    return not_nullptr(p) ? load_big<util::ulonglong>(p) : 0 ;
+}
+
+/**
+ *  Gets the address of the next \a sz bytes in the window, without copying
+ *  them or moving the read position.
+ *
+ * \return
+ *      Returns null if the file does not have \a sz more bytes, or \a sz is
+ *      more than the peek_max of open().
+ */
+
+const util::byte *
+bytestream::peek (size_t sz)
+{
+    return require(sz) ? m_window + m_position : nullptr ;
+}
+
+/**
+ *  Gets the next \a sz bytes as a byteview, without copying them or moving
+ *  the read position. The view's offset is the file position.
+ *
+ * \return
+ *      Returns an empty view if peek() would return null.
+ */
+
+byteview
+bytestream::peek_view (size_t sz)
+{
+    byteview result;
+    const util::byte * p = peek(sz);
+    if (not_nullptr(p))
+        result = byteview(p, sz, position());
+
+    return result;
+}
+
+/**
+ *  Sets the error message, the first time only, and reports it.
+ *
+ * \return
+ *      Always returns false.
+ */
+
+bool
+bytestream::set_error (const std::string & msg)
+{
+    if (! m_error_is_fatal)
+    {
+        char temp[64];
+        (void) snprintf(temp, sizeof temp, " at offset 0x%zx", position());
+        m_error_message = msg;
+        m_error_message += " '";
+        m_error_message += m_file_name;
+        m_error_message += "'";
+        m_error_message += temp;
+        m_error_is_fatal = true;
+        errprint(m_error_message.c_str());
+    }
+    return false;
+}
+
+}           // namespace util
+
+/*
+ * bytestream.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-05-16
- * \updates       2024-05-21
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  The bytevector class is meant to handle big-endian data in a byte-by-byte
@@ -34,23 +34,34 @@
  *  One usage for this class is to extract datad from MIDI files. MIDI files,
  *  like network data, are big-endian. (Intel processors are little endian,
  *  Motorola processors are big-endian).
+ *
+ *  The multi-byte get and peek functions check the bounds once, then use
+ *  load_big(), an unaligned load plus a byte-swap. Only a read that runs
+ *  off the end of the data falls back to reading byte-by-byte, so that
+ *  the error is reported as before.
  */
 
-#include <fstream>                      /* std::ifstream & std::ofstream    */
+#include <cstdio>                       /* std::fopen(), std::fwrite()      */
+#include <fstream>                      /* std::ifstream                    */
+#include <utility>                      /* std::move()                      */
 
 #include "util/bytevector.hpp"          /* util::bytevector class           */
+#include "util/hash64.hpp"              /* util::hash_bytes()               */
 #include "util/msgfunctions.hpp"        /* msglevel & util::msgfunctions    */
+#include "util/varinum.hpp"             /* util::decode_varinums(), etc.    */
+
+#if defined PLATFORM_UNIX
+#include <cerrno>                       /* errno, EINTR                     */
+#include <fcntl.h>                      /* ::open(), ::posix_fallocate()    */
+#include <sys/mman.h>                   /* ::mmap(), ::munmap()             */
+#include <sys/stat.h>                   /* ::fstat()                        */
+#include <sys/uio.h>                    /* ::writev(), struct iovec         */
+#include <unistd.h>                     /* ::close(), ::write()             */
+#endif
 
 namespace util
 {
 
-/**
- *  A manifest constant for controlling the length of the stream buffering
- *  array in a file.
- */
-
-static const int c_util_line_max = 1024;
-
 /**
  *  Principal constructor.
  *
@@ -74,6 +85,9 @@ bytevector::bytevector () :
     m_error_is_fatal    (false),
     m_disable_reported  (false),
     m_data              (),                 /* vector of bytes              */
+    m_mapping           (),                 /* not mapped                   */
+    m_map_data          (nullptr),
+    m_map_size          (0),
     m_position          (0)                 /* byte position in vector      */
 {
     // no other code needed
@@ -93,6 +107,9 @@ bytevector::bytevector (const std::string & s) :
     m_error_is_fatal    (false),
     m_disable_reported  (false),
     m_data              (),                 /* vector of bytes              */
+    m_mapping           (),                 /* not mapped                   */
+    m_map_data          (nullptr),
+    m_map_size          (0),
     m_position          (0)                 /* byte position in vector      */
 {
     assign(s, 0, 0);                        /* use the whole string         */
@@ -125,6 +142,9 @@ bytevector::bytevector
     m_error_is_fatal    (false),
     m_disable_reported  (false),
     m_data              (),                 /* vector of bytes              */
+    m_mapping           (),                 /* not mapped                   */
+    m_map_data          (nullptr),
+    m_map_size          (0),
     m_position          (0)                 /* byte position in vector      */
 {
     if (offset == 0 && amount == 0)
@@ -136,6 +156,46 @@ bytevector::bytevector
         assign(data, offset, amount);
 }
 
+/**
+ *  The move constructor and move assignment leave the source unmapped, so
+ *  that it does not keep the address of a mapping it no longer shares.
+ */
+
+bytevector::bytevector (bytevector && source) :
+    m_nominal_size      (source.m_nominal_size),
+    m_offset            (source.m_offset),
+    m_error_message     (std::move(source.m_error_message)),
+    m_error_is_fatal    (source.m_error_is_fatal),
+    m_disable_reported  (source.m_disable_reported),
+    m_data              (std::move(source.m_data)),
+    m_mapping           (std::move(source.m_mapping)),
+    m_map_data          (source.m_map_data),
+    m_map_size          (source.m_map_size),
+    m_position          (source.m_position)
+{
+    source.release_mapping();
+}
+
+bytevector &
+bytevector::operator = (bytevector && source)
+{
+    if (this != &source)
+    {
+        m_nominal_size      = source.m_nominal_size;
+        m_offset            = source.m_offset;
+        m_error_message     = std::move(source.m_error_message);
+        m_error_is_fatal    = source.m_error_is_fatal;
+        m_disable_reported  = source.m_disable_reported;
+        m_data              = std::move(source.m_data);
+        m_mapping           = std::move(source.m_mapping);
+        m_map_data          = source.m_map_data;
+        m_map_size          = source.m_map_size;
+        m_position          = source.m_position;
+        source.release_mapping();
+    }
+    return *this;
+}
+
 /**
  *  Passes an std::initializer_list<> to std::vector<>::operator =() to
  *  assign part of the data vector to m_data.
@@ -156,6 +216,7 @@ bytevector::assign
     bool ok = offset < data.size() && high < data.size();
     if (ok)
     {
+        release_mapping();
         m_data = {data.begin() + offset, data.begin() + high + 1};
         m_nominal_size = m_data.size();
         m_offset = offset;
@@ -170,8 +231,26 @@ bytevector::assign
     size_t amount
 )
 {
-    const auto & dvec = data.byte_list();       /* const bytes & */
-    assign(dvec, offset, amount);
+    if (data.mapped())
+    {
+        size_t high = offset + amount - 1;
+        if (offset == 0 && amount == 0)
+            high = data.size() - 1;
+
+        bool ok = offset < data.size() && high < data.size();
+        if (ok)
+        {
+            release_mapping();
+            m_data.assign(data.data() + offset, data.data() + high + 1);
+            m_nominal_size = m_data.size();
+            m_offset = offset;
+        }
+    }
+    else
+    {
+        const auto & dvec = data.byte_list();   /* const bytes &            */
+        assign(dvec, offset, amount);
+    }
 }
 
 void
@@ -192,6 +271,7 @@ bytevector::assign
         if (ok)
         {
             size_t index = 0;
+            release_mapping();
             m_data.clear();
             for (auto c : s)
             {
@@ -233,12 +313,25 @@ bytevector::real_position () const
     return position() + offset();
 }
 
+/**
+ *  Hashes all of the data, mapped or not, whatever the position. Two
+ *  bytevectors with the same data have the same fingerprint, so that, for
+ *  example, a MIDI file need not be written again if its fingerprint is
+ *  that of the file on disk (see util::hash_file()).
+ */
+
+std::uint64_t
+bytevector::fingerprint () const
+{
+    return hash_bytes(data(), size());
+}
+
 /*-------------------------------------------------------------------------
  * get() functions
  *-------------------------------------------------------------------------*/
 
 /**
- *  Reads 1 byte of data directly from the m_data vector, incrementing
+ *  Reads 1 byte of data directly from the data, incrementing
  *  m_position after doing so.
  *
  * \return
@@ -250,9 +343,9 @@ bytevector::real_position () const
 util::byte
 bytevector::get_byte () const
 {
-    if (m_position < m_data.size())
+    if (m_position < size())
     {
-        return m_data[m_position++];
+        return data()[m_position++];
     }
     else if (! m_disable_reported)
     {
@@ -262,7 +355,7 @@ bytevector::get_byte () const
 }
 
 /**
- *  Reads 2 bytes of data using get_byte().
+ *  Reads 2 bytes of data.
  *
  * \return
  *      Returns the two bytes, shifted appropriately and added together,
@@ -272,8 +365,17 @@ bytevector::get_byte () const
 util::ushort
 bytevector::get_short () const
 {
-    util::ushort result = get_byte() << 8;
-    result += get_byte();
+    util::ushort result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ushort>(data() + m_position);
+        m_position += sizeof result;
+    }
+    else
+    {
+        result = get_byte() << 8;
+        result += get_byte();
+    }
     return result;
 }
 
@@ -288,14 +390,24 @@ bytevector::get_short () const
 util::ulong
 bytevector::get_triple () const
 {
-    util::ulong result = get_byte() << 16;
-    result += get_byte() << 8;
-    result += get_byte();
+    util::ulong result;
+    if (remainder() >= 3)
+    {
+        const util::byte * p = data() + m_position;
+        result = (util::ulong(p[0]) << 16) | (util::ulong(p[1]) << 8) | p[2];
+        m_position += 3;
+    }
+    else
+    {
+        result = get_byte() << 16;
+        result += get_byte() << 8;
+        result += get_byte();
+    }
     return result;
 }
 
 /**
- *  Reads 4 bytes of data using get_byte().
+ *  Reads 4 bytes of data.
  *
  * \return
  *      Returns the four bytes, shifted appropriately and added together,
@@ -305,15 +417,24 @@ bytevector::get_triple () const
 util::ulong
 bytevector::get_long () const
 {
-    util::ulong result = get_byte() << 24;
-    result += get_byte() << 16;
-    result += get_byte() << 8;
-    result += get_byte();
+    util::ulong result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ulong>(data() + m_position);
+        m_position += sizeof result;
+    }
+    else
+    {
+        result = get_byte() << 24;
+        result += get_byte() << 16;
+        result += get_byte() << 8;
+        result += get_byte();
+    }
     return result;
 }
 
 /**
- *  Reads 8 bytes of data using get_byte().
+ *  Reads 8 bytes of data.
  *
  * \return
  *      Returns the eight bytes, shifted appropriately and added together,
@@ -323,14 +444,23 @@ bytevector::get_long () const
 util::ulonglong
 bytevector::get_longlong () const
 {
-    util::ulonglong result = util::ulonglong(get_byte()) << 56;
-    result += util::ulonglong(get_byte()) << 48;
-    result += util::ulonglong(get_byte()) << 40;
-    result += util::ulonglong(get_byte()) << 32;
-    result += util::ulonglong(get_byte()) << 24;
-    result += util::ulonglong(get_byte()) << 16;
-    result += util::ulonglong(get_byte()) << 8;
-    result += util::ulonglong(get_byte());
+    util::ulonglong result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ulonglong>(data() + m_position);
+        m_position += sizeof result;
+    }
+    else
+    {
+        result = util::ulonglong(get_byte()) << 56;
+        result += util::ulonglong(get_byte()) << 48;
+        result += util::ulonglong(get_byte()) << 40;
+        result += util::ulonglong(get_byte()) << 32;
+        result += util::ulonglong(get_byte()) << 24;
+        result += util::ulonglong(get_byte()) << 16;
+        result += util::ulonglong(get_byte()) << 8;
+        result += util::ulonglong(get_byte());
+    }
     return result;
 }
 
@@ -362,6 +492,36 @@ bytevector::get_varinum ()
     return result;
 }
 
+/**
+ *  Reads a run of varinums, such as the delta-times of a packed list, with
+ *  the batch decoder.
+ *
+ * \param destination
+ *      Receives the values. It must hold \a count values.
+ *
+ * \param count
+ *      The most values to read.
+ *
+ * \return
+ *      Returns the number of values read. If a malformed varinum is found,
+ *      the position is left at its start and an error is set.
+ */
+
+size_t
+bytevector::get_varinums (util::ulong * destination, size_t count)
+{
+    size_t consumed = 0;
+    bool ok = decode_varinums
+    (
+        data() + m_position, remainder(), destination, count, consumed
+    );
+    m_position += consumed;
+    if (! ok && ! m_disable_reported)
+        (void) set_error_dump("Malformed varinum");
+
+    return count;
+}
+
 /**
  *  A function to simplify reading data from a file, starting from the
  *  current position in getting the data. It uses a standard
@@ -385,11 +545,11 @@ bytevector::get_string (size_t sz)
     if (sz == 0)
     {
         reset();
-        sz = m_data.size();
+        sz = size();
     }
     for (size_t i = 0; i < sz; ++i)
     {
-        if (m_position < m_data.size())
+        if (m_position < size())
         {
             result.push_back(char(get_byte()));
         }
@@ -409,8 +569,8 @@ bytevector::get_string (size_t sz)
 util::byte
 bytevector::peek_byte () const
 {
-    if (m_position < m_data.size())
-        return m_data[m_position];
+    if (m_position < size())
+        return data()[m_position];
     else if (! m_disable_reported)
         (void) set_error_dump("'End-of-vector', further reading disabled");
 
@@ -420,8 +580,8 @@ bytevector::peek_byte () const
 util::byte
 bytevector::peek_byte (size_t offset) const
 {
-    if ((m_position + offset) < m_data.size())
-        return m_data[m_position + offset];
+    if ((m_position + offset) < size())
+        return data()[m_position + offset];
     else
         util::msgprintf(lib66::msglevel::warn, "Peeking past data!");
 
@@ -431,8 +591,8 @@ bytevector::peek_byte (size_t offset) const
 util::byte
 bytevector::peek_byte_at (size_t offset) const
 {
-    if (offset < m_data.size())
-        return m_data[offset];
+    if (offset < size())
+        return data()[offset];
     else
         util::msgprintf(lib66::msglevel::warn, "Peeking past data!");
 
@@ -442,33 +602,57 @@ bytevector::peek_byte_at (size_t offset) const
 util::ushort
 bytevector::peek_short () const
 {
-    util::ushort result = peek_byte() << 8;
-    result += peek_byte(1);
+    util::ushort result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ushort>(data() + m_position);
+    }
+    else
+    {
+        result = peek_byte() << 8;
+        result += peek_byte(1);
+    }
     return result;
 }
 
 util::ulong
 bytevector::peek_long () const
 {
-    util::ulong result = peek_byte();
-    result <<= 24;
-    result += peek_byte(1) << 16;
-    result += peek_byte(2) << 8;
-    result += peek_byte(3);
+    util::ulong result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ulong>(data() + m_position);
+    }
+    else
+    {
+        result = peek_byte();
+        result <<= 24;
+        result += peek_byte(1) << 16;
+        result += peek_byte(2) << 8;
+        result += peek_byte(3);
+    }
     return result;
 }
 
 util::ulonglong
 bytevector::peek_longlong () const
 {
-    util::ulonglong result = util::ulonglong(peek_byte()) << 56;
-    result += util::ulonglong(peek_byte(1)) << 48;
-    result += util::ulonglong(peek_byte(2)) << 40;
-    result += util::ulonglong(peek_byte(3)) << 32;
-    result += util::ulonglong(peek_byte(4)) << 24;
-    result += util::ulonglong(peek_byte(5)) << 16;
-    result += util::ulonglong(peek_byte(6)) << 8;
-    result += util::ulonglong(peek_byte(7));
+    util::ulonglong result;
+    if (remainder() >= sizeof result)
+    {
+        result = load_big<util::ulonglong>(data() + m_position);
+    }
+    else
+    {
+        result = util::ulonglong(peek_byte()) << 56;
+        result += util::ulonglong(peek_byte(1)) << 48;
+        result += util::ulonglong(peek_byte(2)) << 40;
+        result += util::ulonglong(peek_byte(3)) << 32;
+        result += util::ulonglong(peek_byte(4)) << 24;
+        result += util::ulonglong(peek_byte(5)) << 16;
+        result += util::ulonglong(peek_byte(6)) << 8;
+        result += util::ulonglong(peek_byte(7));
+    }
     return result;
 }
 
@@ -482,14 +666,14 @@ bytevector::peek_string (size_t offset, size_t amount)
     std::string result;
     size_t high = offset + amount - 1;
     if (offset == 0 && amount == 0)
-        high = m_data.size() - 1;
+        high = size() - 1;
 
-    bool ok = offset < m_data.size() && high < m_data.size();
+    bool ok = offset < size() && high < size();
     if (ok)
     {
         for (size_t index = offset; index <= high; ++index)
         {
-            char c = static_cast<char>(m_data[index]);
+            char c = static_cast<char>(data()[index]);
             result.push_back(c);
         }
     }
@@ -501,11 +685,7 @@ bytevector::peek_string (size_t offset, size_t amount)
  *-------------------------------------------------------------------------*/
 
 /**
- *  Writes 2 bytes, each extracted from the long value and shifted rightward
- *  down to byte size, using the put() function.
- *
- * \warning
- *      This code looks endian-dependent.
+ *  Writes 2 bytes, most-significant byte first.
  *
  * \param x
  *      The short value to be written to the MIDI bytevector.
@@ -514,13 +694,12 @@ bytevector::peek_string (size_t offset, size_t amount)
 void
 bytevector::put_short (util::ushort x)
 {
-    put_byte((x & 0xFF00) >> 8);
-    put_byte((x & 0x00FF));
+    put_big<util::ushort>(x);
 }
 
 /**
  *  Writes 3 bytes, each extracted from the long value and shifted rightward
- *  down to byte size, using the put_byte() function.
+ *  down to byte size.
  *
  *  This function is kind of the reverse of tempo_us_to_bytes() defined in the
  *  calculations.cpp module of the rtl66 MIDI library.
@@ -532,14 +711,17 @@ bytevector::put_short (util::ushort x)
 void
 bytevector::put_triple (util::ulong x)
 {
-    put_byte((x & 0x00FF0000) >> 16);
-    put_byte((x & 0x0000FF00) >> 8);
-    put_byte((x & 0x000000FF));
+    unmap();
+    size_t sz = m_data.size();
+    m_data.resize(sz + 3);
+    m_data[sz] = util::byte((x & 0x00FF0000) >> 16);
+    m_data[sz + 1] = util::byte((x & 0x0000FF00) >> 8);
+    m_data[sz + 2] = util::byte(x & 0x000000FF);
+    m_position += 3;
 }
 
 /**
- *  Writes 4 bytes, each extracted from the long value and shifted rightward
- *  down to byte size, using the put_byte() function.
+ *  Writes 4 bytes, most-significant byte first.
  *
  * \param x
  *      The long value to be written to the MIDI bytevector.
@@ -548,15 +730,11 @@ bytevector::put_triple (util::ulong x)
 void
 bytevector::put_long (util::ulong x)
 {
-    put_byte((x & 0xFF000000) >> 24);
-    put_byte((x & 0x00FF0000) >> 16);
-    put_byte((x & 0x0000FF00) >> 8);
-    put_byte((x & 0x000000FF));
+    put_big<util::ulong>(x);
 }
 
 /**
- *  Writes 8 bytes, each extracted from the longlong value and shifted
- *  rightward down to byte size, using the put_byte() function.
+ *  Writes 8 bytes, most-significant byte first.
  *
  * \param x
  *      The long value to be written to the MIDI bytevector.
@@ -565,14 +743,7 @@ bytevector::put_long (util::ulong x)
 void
 bytevector::put_longlong (util::ulonglong x)
 {
-    put_byte((x & 0xFF00000000000000) >> 56);
-    put_byte((x & 0x00FF000000000000) >> 48);
-    put_byte((x & 0x0000FF0000000000) >> 40);
-    put_byte((x & 0x000000FF00000000) >> 32);
-    put_byte((x & 0x00000000FF000000) >> 24);
-    put_byte((x & 0x0000000000FF0000) >> 16);
-    put_byte((x & 0x000000000000FF00) >> 8);
-    put_byte(x & 0x00000000000000FF);
+    put_big<util::ulonglong>(x);
 }
 
 /**
@@ -587,6 +758,8 @@ bytevector::put_longlong (util::ulonglong x)
 void
 bytevector::put_varinum (util::ulong v)
 {
+    unmap();
+
     util::ulong buffer = v & 0x7F;                  /* mask a no-sign byte  */
     while (v >>= 7)                                 /* shift right, test    */
     {
@@ -603,6 +776,163 @@ bytevector::put_varinum (util::ulong v)
     }
 }
 
+/**
+ *  Writes a run of varinums with the batch encoder. The vector is grown
+ *  once for the whole run. Like put_varinum(), this does not move the
+ *  position.
+ */
+
+void
+bytevector::put_varinums (const util::ulong * values, size_t count)
+{
+    if (not_nullptr(values) && count > 0)
+    {
+        unmap();
+        size_t start = m_data.size();
+        m_data.resize(start + count * c_varinum_encode_max);
+        size_t sz = encode_varinums(values, count, m_data.data() + start);
+        m_data.resize(start + sz);
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * Buffer pooling
+ *-------------------------------------------------------------------------*/
+
+/**
+ *  Replaces the data with an empty buffer from this thread's pool, with
+ *  room reserved for the expected output.
+ *
+ * \param estimate
+ *      The expected size. If 0, the pool's estimate is used.
+ */
+
+void
+bytevector::acquire (size_t estimate)
+{
+    clear();
+    m_data = bytepool::acquire(estimate);
+}
+
+/**
+ *  Gives the data buffer back to this thread's pool, when the output is
+ *  done with (usually after write()). The bytevector is left empty.
+ */
+
+void
+bytevector::recycle ()
+{
+    if (! mapped())
+        bytepool::release(m_data);
+
+    clear();
+}
+
+/**
+ *  The state of the pool of one thread.
+ */
+
+class pool_state
+{
+public:
+
+    std::vector<util::bytes> ps_buffers;
+    size_t ps_average {0};
+    bytepool::estimator ps_estimator {nullptr};
+};
+
+static pool_state &
+local_pool ()
+{
+    static thread_local pool_state s_pool;
+    return s_pool;
+}
+
+/**
+ *  Gets an empty buffer, recycled if possible, with room reserved.
+ *
+ * \param estimate
+ *      The size to reserve. If 0, the running average of the sizes of the
+ *      buffers released in this thread is used, as adjusted by the
+ *      estimator hook, if one is set.
+ */
+
+util::bytes
+bytepool::acquire (size_t estimate)
+{
+    pool_state & pool = local_pool();
+    util::bytes result;
+    if (! pool.ps_buffers.empty())
+    {
+        result.swap(pool.ps_buffers.back());
+        pool.ps_buffers.pop_back();
+    }
+    if (estimate == 0)
+    {
+        estimate = pool.ps_average;
+        if (not_nullptr(pool.ps_estimator))
+            estimate = pool.ps_estimator(estimate);
+    }
+    if (estimate > 0)
+        result.reserve(estimate);
+
+    return result;
+}
+
+/**
+ *  Takes a buffer back into the pool, leaving \a b empty. The size it
+ *  reached updates the running average. Buffers beyond max_buffers, or
+ *  larger than max_capacity, are freed instead.
+ */
+
+void
+bytepool::release (util::bytes & b)
+{
+    pool_state & pool = local_pool();
+    size_t sz = b.size();
+    if (sz > 0)
+    {
+        pool.ps_average = pool.ps_average == 0 ?
+            sz : (pool.ps_average * 7 + sz) / 8 ;
+    }
+    if (pool.ps_buffers.size() < max_buffers && b.capacity() <= max_capacity)
+    {
+        b.clear();
+        pool.ps_buffers.push_back(util::bytes());
+        pool.ps_buffers.back().swap(b);
+    }
+    else
+        util::bytes().swap(b);
+}
+
+size_t
+bytepool::available ()
+{
+    return local_pool().ps_buffers.size();
+}
+
+size_t
+bytepool::estimate ()
+{
+    return local_pool().ps_average;
+}
+
+void
+bytepool::set_estimator (estimator e)
+{
+    local_pool().ps_estimator = e;
+}
+
+/**
+ *  Frees all of this thread's pooled buffers.
+ */
+
+void
+bytepool::drain ()
+{
+    local_pool().ps_buffers.clear();
+}
+
 /*-------------------------------------------------------------------------
  * poke() functions
  *-------------------------------------------------------------------------*/
@@ -686,7 +1016,115 @@ bytevector::read (const std::string & infilename)
 }
 
 /**
- *  Write the whole data out to the bytevector.
+ *  The mapping of a file. It is unmapped when the last bytevector using it
+ *  goes away, or stops using it.
+ */
+
+class bytevector::mapping
+{
+
+public:
+
+    const util::byte * map_data;
+    size_t map_size;
+
+    mapping (const util::byte * d, size_t sz) : map_data (d), map_size (sz)
+    {
+        // no code
+    }
+
+    mapping (const mapping &) = delete;
+    mapping & operator = (const mapping &) = delete;
+
+    ~mapping ()
+    {
+#if defined PLATFORM_UNIX
+        (void) ::munmap(const_cast<util::byte *>(map_data), map_size);
+#endif
+    }
+
+};
+
+/**
+ *  Maps a file into memory, read-only, instead of reading it into the data
+ *  vector. This avoids both the copy and holding two copies of a large
+ *  file at once. The kernel is told that the file will be read
+ *  sequentially, and soon, so that it reads ahead.
+ *
+ *  All of the get and peek functions work on the mapping. The first put or
+ *  poke, or call to the non-const byte_list(), copies the bytes into the
+ *  data vector, and the mapping is released (copy-on-write).
+ *
+ *  If mapping is not supported, or fails, or the file is empty, this
+ *  function falls back to read().
+ *
+ * \param infilename
+ *      The file to map.
+ *
+ * \return
+ *      Returns true if the file was mapped or read.
+ */
+
+bool
+bytevector::read_mapped (const std::string & infilename)
+{
+    bool result = false;
+#if defined PLATFORM_UNIX
+    if (! infilename.empty())
+    {
+        int fd = ::open(infilename.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                size_t sz = size_t(st.st_size);
+                void * p = ::mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    (void) ::madvise(p, sz, MADV_SEQUENTIAL);
+                    (void) ::madvise(p, sz, MADV_WILLNEED);
+                    clear();
+                    m_map_data = static_cast<const util::byte *>(p);
+                    m_map_size = sz;
+                    m_mapping = std::make_shared<const mapping>(m_map_data, sz);
+                    m_nominal_size = sz;
+                    result = true;
+                }
+            }
+            (void) ::close(fd);                 /* the mapping stays valid  */
+        }
+    }
+#endif
+    if (! result)
+        result = read(infilename);
+
+    return result;
+}
+
+/**
+ *  Leaves mapped mode by copying the mapped bytes into the data vector.
+ */
+
+void
+bytevector::copy_mapping ()
+{
+    m_data.assign(m_map_data, m_map_data + m_map_size);
+    release_mapping();
+}
+
+void
+bytevector::release_mapping ()
+{
+    m_mapping.reset();
+    m_map_data = nullptr;
+    m_map_size = 0;
+}
+
+/**
+ *  Writes the whole data out to a file, using a bytewriter, so that the
+ *  bytes go out in a few large write calls. The file space is reserved
+ *  first, where supported.
  *
  * \return
  *      Returns true if the write operations succeeded.  If false is returned,
@@ -696,42 +1134,440 @@ bytevector::read (const std::string & infilename)
 bool
 bytevector::write (const std::string & outfilename)
 {
-    bool result = m_data.size() > 0;
+    bool result = size() > 0;
     if (result)
     {
-        std::ofstream file
+        bytewriter writer;
+        result = writer.open(outfilename, size());
+        if (result)
+            result = writer.write(data(), size());
+
+        if (result)
+            result = writer.close();
+
+        if (! result)
+            m_error_message = writer.error_message();
+    }
+    else
+        m_error_message = "No data write.";
+
+    return result;
+}
+
+/*-------------------------------------------------------------------------
+ * bytetransaction
+ *-------------------------------------------------------------------------*/
+
+/**
+ *  Starts a transaction at the current position of a bytevector.
+ *
+ *  The rules:
+ *
+ *      -   require(n) checks, once, that n more bytes are there. The
+ *          get functions that follow do no checking at all, so each must
+ *          be covered by a successful require(). Reading without one is a
+ *          bug in the caller.
+ *      -   get_varinum() is the exception. Its length is not known ahead
+ *          of time, so it checks each byte, and fails the transaction if
+ *          the varinum is too long or runs off the end.
+ *      -   The first failure is kept: its offset, the bytes needed, and a
+ *          description, which must be a string literal or other static
+ *          string. Nothing is formatted, and nothing is reported, until
+ *          error_message() or commit() is called. Later failures are
+ *          ignored, and require() keeps failing, so a parser can run to
+ *          the end of a block and check once.
+ *      -   commit() moves the bytevector's position to the end of the
+ *          reads, if all went well. Otherwise it leaves the position
+ *          alone and sets the bytevector's error, as set_error_dump()
+ *          would have.
+ */
+
+bytetransaction::bytetransaction (bytevector & source) :
+    m_source        (source),
+    m_data          (source.data()),
+    m_size          (source.size()),
+    m_position      (source.position()),
+    m_start         (source.position()),
+    m_failed        (false),
+    m_error_offset  (0),
+    m_error_needed  (0),
+    m_error_what    (nullptr)
+{
+    // no code
+}
+
+/**
+ *  Fails the transaction, if it has not failed already. The caller can use
+ *  this for its own checks, such as a bad chunk tag.
+ *
+ * \param what
+ *      A static description of what was being read.
+ *
+ * \param needed
+ *      The number of bytes needed, if that is the problem.
+ *
+ * \return
+ *      Always returns false.
+ */
+
+bool
+bytetransaction::fail (const char * what, size_t needed)
+{
+    if (! m_failed)
+    {
+        m_failed = true;
+        m_error_offset = m_position;
+        m_error_needed = needed;
+        m_error_what = what;
+    }
+    return false;
+}
+
+/**
+ *  Reads a checked varinum of at most 4 bytes.
+ *
+ * \return
+ *      Returns the value, or 0 if the transaction fails here or failed
+ *      earlier.
+ */
+
+util::ulong
+bytetransaction::get_varinum ()
+{
+    util::ulong result = 0;
+    if (! m_failed)
+    {
+        size_t start = m_position;
+        size_t len = 0;
+        for (;;)
+        {
+            if (m_position >= m_size || len == 4)
+            {
+                m_position = start;
+                (void) fail("Malformed varinum", len + 1);
+                result = 0;
+                break;
+            }
+            util::byte c = m_data[m_position++];
+            ++len;
+            result = (result << 7) | (c & 0x7F);
+            if ((c & 0x80) == 0)
+                break;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Ends the transaction.
+ *
+ * \return
+ *      Returns true if there was no failure, in which case the bytevector's
+ *      position is moved past the bytes read.
+ */
+
+bool
+bytetransaction::commit ()
+{
+    if (m_failed)
+        (void) m_source.set_error(error_message());
+    else
+        m_source.m_position = m_position;
+
+    return ! m_failed;
+}
+
+/**
+ *  Starts the transaction over, from where it began, with no error.
+ */
+
+void
+bytetransaction::rollback ()
+{
+    m_position = m_start;
+    m_failed = false;
+    m_error_offset = m_error_needed = 0;
+    m_error_what = nullptr;
+}
+
+/**
+ *  Formats the error. This is the only place the formatting is done.
+ *
+ * \return
+ *      Returns an empty string if there was no failure.
+ */
+
+std::string
+bytetransaction::error_message () const
+{
+    std::string result;
+    if (m_failed)
+    {
+        char temp[96];
+        (void) snprintf
         (
-            outfilename.c_str(),
-            std::ios::out | std::ios::binary | std::ios::trunc
+            temp, sizeof temp, "At 0x%zx of 0x%zx (real 0x%zx): ",
+            m_error_offset, m_size, m_error_offset + m_source.offset()
         );
-        if (file.is_open())
+        result = temp;
+        result += not_nullptr(m_error_what) ? m_error_what : "Read failed" ;
+        if (m_error_needed > 0)
         {
-            char file_buffer[c_util_line_max];  /* enable bufferization */
-            file.rdbuf()->pubsetbuf(file_buffer, sizeof file_buffer);
-            for (auto c : m_data)
+            (void) snprintf
+            (
+                temp, sizeof temp, "; needed %zu byte(s), %zu left",
+                m_error_needed, m_size - m_error_offset
+            );
+            result += temp;
+        }
+    }
+    return result;
+}
+
+/*-------------------------------------------------------------------------
+ * bytewriter
+ *-------------------------------------------------------------------------*/
+
+/**
+ *  The largest number of segments handed to one writev() call, and the
+ *  largest single write() call.
+ */
+
+static const int c_iov_max = 64;
+static const size_t c_write_chunk_max = size_t(1) << 30;
+
+bytewriter::bytewriter (size_t segmentsize) :
+    m_file_name     (),
+    m_file          (nullptr),
+    m_segments      (),
+    m_pending       (0),
+    m_segment_size  (segmentsize),
+    m_written       (0),
+    m_preallocated  (false),
+    m_error_message ()
+{
+    // no code
+}
+
+bytewriter::~bytewriter ()
+{
+    (void) close();
+}
+
+/**
+ *  Creates (or truncates) a file for writing.
+ *
+ * \param outfilename
+ *      The name of the file.
+ *
+ * \param expected
+ *      If not 0, the expected size of the file. On Linux the space is
+ *      reserved with posix_fallocate(), which keeps a large file from being
+ *      fragmented and reports a full disk up front. If fewer bytes are
+ *      written, close() trims the file.
+ *
+ * \return
+ *      Returns true if the file was opened.
+ */
+
+bool
+bytewriter::open (const std::string & outfilename, size_t expected)
+{
+    (void) close();
+    m_error_message.clear();
+    m_written = 0;
+    m_preallocated = false;
+    m_file = std::fopen(outfilename.c_str(), "wb");
+    bool result = not_nullptr(m_file);
+    if (result)
+    {
+        m_file_name = outfilename;
+        (void) std::setvbuf(m_file, nullptr, _IONBF, 0);    /* we batch     */
+#if defined PLATFORM_LINUX
+        if (expected > 0)
+        {
+            int rc = ::posix_fallocate(::fileno(m_file), 0, off_t(expected));
+            m_preallocated = rc == 0;
+        }
+#else
+        (void) expected;
+#endif
+    }
+    else
+        m_error_message = "Failed to open file for writing.";
+
+    return result;
+}
+
+/**
+ *  Writes a block of bytes at once, after any queued segments.
+ */
+
+bool
+bytewriter::write (const util::byte * data, size_t sz)
+{
+    bool result = is_open() && (sz == 0 || not_nullptr(data));
+    if (result)
+        result = write_pending();
+
+    while (result && sz > 0)
+    {
+        size_t chunk = sz < c_write_chunk_max ? sz : c_write_chunk_max ;
+#if defined PLATFORM_UNIX
+        ssize_t count = ::write(::fileno(m_file), data, chunk);
+        if (count < 0)
+        {
+            if (errno != EINTR)
+                result = set_error("Error writing bytes.");
+
+            count = 0;
+        }
+#else
+        size_t count = std::fwrite(data, 1, chunk, m_file);
+        if (count == 0)
+            result = set_error("Error writing bytes.");
+#endif
+        data += count;
+        sz -= size_t(count);
+        m_written += size_t(count);
+    }
+    return result;
+}
+
+/**
+ *  Hands the bytes built up in a bytevector to the writer, and empties the
+ *  bytevector so that it can be filled with the next segment. The bytes
+ *  are moved, not copied. They are queued until there is at least a
+ *  segment's worth, then written with one writev() call.
+ *
+ *  The bytevector's read position and errors are reset.
+ */
+
+bool
+bytewriter::flush (bytevector & bv)
+{
+    bool result = is_open();
+    if (result && bv.size() > 0)
+    {
+        util::bytes segment;
+        segment.swap(bv.byte_list());
+        m_pending += segment.size();
+        m_segments.push_back(std::move(segment));
+        bv.clear();
+        if (m_pending >= m_segment_size)
+            result = write_pending();
+    }
+    return result;
+}
+
+/**
+ *  Writes the queued segments, gathering them into as few writev() calls
+ *  as possible, and allowing for partial writes.
+ */
+
+bool
+bytewriter::write_pending ()
+{
+    bool result = true;
+#if defined PLATFORM_UNIX
+    size_t first = 0;                           /* first unwritten segment  */
+    size_t done = 0;                            /* bytes done of that one   */
+    while (result && first < m_segments.size())
+    {
+        struct iovec iov[c_iov_max];
+        int count = 0;
+        for (size_t i = first; i < m_segments.size() && count < c_iov_max; ++i)
+        {
+            size_t skip = i == first ? done : 0 ;
+            iov[count].iov_base = m_segments[i].data() + skip;
+            iov[count].iov_len = m_segments[i].size() - skip;
+            ++count;
+        }
+        ssize_t written = ::writev(::fileno(m_file), iov, count);
+        if (written < 0)
+        {
+            if (errno != EINTR)
+                result = set_error("Error writing segments.");
+        }
+        else
+        {
+            size_t left = size_t(written);
+            m_written += left;
+            while (left > 0)
             {
-                char kc = char(c);
-                file.write(&kc, 1);
-                if (file.fail())
+                size_t segleft = m_segments[first].size() - done;
+                if (left >= segleft)
+                {
+                    left -= segleft;
+                    ++first;
+                    done = 0;
+                }
+                else
                 {
-                    m_error_message = "Error writing byte.";
-                    result = false;
-                    break;
+                    done += left;
+                    left = 0;
                 }
             }
         }
-        else
+    }
+#else
+    for (const auto & segment : m_segments)
+    {
+        size_t count = std::fwrite(segment.data(), 1, segment.size(), m_file);
+        m_written += count;
+        if (count != segment.size())
         {
-            m_error_message = "Failed to open file for writing.";
-            result = false;
+            result = set_error("Error writing segments.");
+            break;
         }
     }
-    else
-        m_error_message = "No data write.";
+#endif
+    m_segments.clear();
+    m_pending = 0;
+    return result;
+}
+
+/**
+ *  Writes anything queued, trims any unused preallocated space, and closes
+ *  the file.
+ *
+ * \return
+ *      Returns false if there was an error now or earlier. It also returns
+ *      false if the file was not open.
+ */
+
+bool
+bytewriter::close ()
+{
+    bool result = is_open();
+    if (result)
+    {
+        result = write_pending() && m_error_message.empty();
+#if defined PLATFORM_LINUX
+        if (m_preallocated)
+        {
+            if (::ftruncate(::fileno(m_file), off_t(m_written)) != 0)
+                result = set_error("Error trimming file.");
+        }
+#endif
+        if (std::fclose(m_file) != 0)
+            result = set_error("Error closing file.");
 
+        m_file = nullptr;
+    }
     return result;
 }
 
+bool
+bytewriter::set_error (const std::string & msg)
+{
+    m_error_message = msg;
+    m_error_message += " '";
+    m_error_message += m_file_name;
+    m_error_message += "'";
+    return false;
+}
+
 /**
  *  A function that just sets the fatal-error status and the error message.
  *
@@ -775,7 +1611,7 @@ bytevector::set_error_dump (const std::string & msg) const
     snprintf
     (
         temp, sizeof temp, "At 0x%zx of 0x%zx (real 0x%zx): ",
-        position(), m_data.size(), real_position()
+        position(), size(), real_position()
     );
     std::string result = temp;
     result += msg;
@@ -0,0 +1,261 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          byteview.cpp
+ *
+ *  This module declares/defines a class for reading big-endian data from
+ *  a range of bytes owned by something else.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A bytevector owns its bytes, so taking part of one, with assign() or
+ *  peek_string(), copies them. A byteview is just a pointer, a size, and a
+ *  read position. Slicing a view makes another view of the same bytes:
+ *
+\verbatim
+        util::bytevector file;
+        file.read_mapped("song.midi");
+        util::byteview all{file};
+        util::byteview header = all.get_view(14);
+        util::byteview track = all.slice(22, 309);
+\endverbatim
+ *
+ *  Each view has its own position, so the chunks of a file can be handed
+ *  to different threads, each with its own view, with no copying and no
+ *  locking. The bytes are never changed through a view.
+ *
+ *  The caller must keep the bytes alive, and unchanged, while any view of
+ *  them exists. In particular, a put or poke on a mapped bytevector moves
+ *  its bytes into its vector, and appending to a bytevector can move its
+ *  vector. Views taken before that are left dangling.
+ *
+ *  Reading past the end of a view yields 0 and sets the sticky overrun()
+ *  flag, rather than formatting an error message for each failed read.
+ */
+
+#include "util/byteview.hpp"            /* util::byteview class             */
+
+namespace util
+{
+
+byteview::byteview () :
+    m_data      (nullptr),
+    m_size      (0),
+    m_offset    (0),
+    m_position  (0),
+    m_overrun   (false)
+{
+    // no code
+}
+
+byteview::byteview (const util::byte * data, size_t sz, size_t offset) :
+    m_data      (data),
+    m_size      (is_nullptr(data) ? 0 : sz),
+    m_offset    (offset),
+    m_position  (0),
+    m_overrun   (false)
+{
+    // no code
+}
+
+/**
+ *  Views all of the bytes of a bytevector, mapped or not.
+ */
+
+byteview::byteview (const bytevector & bv) :
+    m_data      (bv.data()),
+    m_size      (bv.size()),
+    m_offset    (bv.offset()),
+    m_position  (0),
+    m_overrun   (false)
+{
+    // no code
+}
+
+/**
+ *  Views part of a bytevector. A range that runs past the end of the data
+ *  is cut short.
+ */
+
+byteview::byteview (const bytevector & bv, size_t offset, size_t amount) :
+    m_data      (nullptr),
+    m_size      (0),
+    m_offset    (0),
+    m_position  (0),
+    m_overrun   (false)
+{
+    *this = byteview(bv).slice(offset, amount);
+}
+
+bool
+byteview::skip (size_t sz)
+{
+    bool result = sz <= remainder();
+    if (result)
+        m_position += sz;
+    else
+    {
+        m_position = m_size;
+        m_overrun = true;
+    }
+    return result;
+}
+
+util::ulong
+byteview::get_triple ()
+{
+    util::ulong result = 0;
+    if (remainder() >= 3)
+    {
+        const util::byte * p = m_data + m_position;
+        result = (util::ulong(p[0]) << 16) | (util::ulong(p[1]) << 8) | p[2];
+        m_position += 3;
+    }
+    else
+    {
+        m_position = m_size;
+        m_overrun = true;
+    }
+    return result;
+}
+
+/**
+ *  Reads a MIDI Variable-Length Value, as bytevector::get_varinum() does.
+ *  If the data ends before a byte with bit 7 clear, the overrun flag is
+ *  set.
+ */
+
+util::ulong
+byteview::get_varinum ()
+{
+    util::ulong result = 0;
+    for (;;)
+    {
+        if (m_position < m_size)
+        {
+            util::byte c = m_data[m_position++];
+            result = (result << 7) + (c & 0x7F);
+            if ((c & 0x80) == 0x00)
+                break;
+        }
+        else
+        {
+            m_overrun = true;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Copies bytes into a string. Unlike bytevector::get_string(), a length of
+ *  0 yields an empty string.
+ *
+ * \return
+ *      Returns the string, empty if there are not enough bytes left.
+ */
+
+std::string
+byteview::get_string (size_t len)
+{
+    std::string result;
+    if (len <= remainder())
+    {
+        const char * p = reinterpret_cast<const char *>(m_data + m_position);
+        result.assign(p, len);
+        m_position += len;
+    }
+    else
+    {
+        m_position = m_size;
+        m_overrun = true;
+    }
+    return result;
+}
+
+/**
+ *  Gets the next \a len bytes as a view of their own, and moves past them.
+ *
+ * \return
+ *      Returns the view. If there are not enough bytes left, the view holds
+ *      what is left, and the overrun flag is set.
+ */
+
+byteview
+byteview::get_view (size_t len)
+{
+    if (len > remainder())
+    {
+        len = remainder();
+        m_overrun = true;
+    }
+    byteview result{m_data + m_position, len, m_offset + m_position};
+    m_position += len;
+    return result;
+}
+
+/**
+ *  Makes a view of part of this view, ignoring the read position.
+ *
+ * \param offset
+ *      The start of the slice, relative to the start of this view.
+ *
+ * \param amount
+ *      The size of the slice. If it runs past the end of this view, it is
+ *      cut short. If 0, the slice runs to the end of this view.
+ */
+
+byteview
+byteview::slice (size_t offset, size_t amount) const
+{
+    byteview result;
+    if (offset <= m_size)
+    {
+        size_t avail = m_size - offset;
+        if (amount == 0 || amount > avail)
+            amount = avail;
+
+        result = byteview(m_data + offset, amount, m_offset + offset);
+    }
+    return result;
+}
+
+/**
+ *  Copies the whole view into a string, for when a copy is wanted.
+ */
+
+std::string
+byteview::to_string () const
+{
+    return is_nullptr(m_data) ? std::string() :
+        std::string(reinterpret_cast<const char *>(m_data), m_size) ;
+}
+
+}           // namespace util
+
+/*
+ * byteview.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,741 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          charconv.cpp
+ *
+ *  This module declares/defines conversions between numbers and text that
+ *  do not depend on the locale and do not allocate.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  These are much like the C++17 std::from_chars() and std::to_chars(),
+ *  which cfg66 cannot yet require. std::stod(), std::strtod(), and
+ *  "%g" use the decimal point of the C locale, so that an application that
+ *  calls setlocale() for a German user would read "0.5" as 0, and write
+ *  0.5 as "0,5". std::stol() and its ilk throw, and need a std::string.
+ *
+ *  from_chars() parses a strview: an optional sign, then the number, up to
+ *  the first character that is not part of it. Leading white space is not
+ *  skipped. The result gives the offset where the number ended, or where
+ *  it went wrong:
+ *
+\verbatim
+        "12 apples"     value 12, ok, position 2
+        "-x"            invalid, position 1
+        "1e999"         out_of_range, position 5, value is infinity
+\endverbatim
+ *
+ *  Integers can have a base from 2 to 36, or 0 to pick decimal, octal
+ *  ("0" prefix), or hexadecimal ("0x" prefix) as std::strtol() does. A value
+ *  that is too large is reported, but unlike std::from_chars() the value
+ *  is also set, clamped to the limit of the type.
+ *
+ *  Floating values are parsed here, not by the C library. Most values in
+ *  configuration files have few digits and small exponents, and are made
+ *  exactly from the digits and a power of ten with a single multiply or
+ *  divide (Clinger's fast path), which rounds correctly. Others are handed
+ *  to std::strtod() as digits and an exponent, with no decimal point, so
+ *  the locale cannot matter, and the result is still correctly rounded.
+ *
+ *  to_chars() writes the shortest text that from_chars() reads back as the
+ *  same value: the digits of "%.15g" for a double (or "%.6g" for a float),
+ *  with more digits only if those are not enough, and a '.' whatever the
+ *  locale. It writes no terminating null.
+ */
+
+#include <cerrno>                       /* errno, ERANGE                    */
+#include <cfloat>                       /* DBL_DIG, FLT_EVAL_METHOD         */
+#include <climits>                      /* LONG_MAX, ULONG_MAX, INT_MAX     */
+#include <clocale>                      /* std::localeconv()                */
+#include <cmath>                        /* std::isnan(), std::isinf()       */
+#include <cstdio>                       /* std::snprintf()                  */
+#include <cstdlib>                      /* std::strtod(), std::strtof()     */
+#include <cstring>                      /* std::memcpy(), std::strstr()     */
+#include <limits>                       /* std::numeric_limits<>            */
+
+#include "util/charconv.hpp"            /* util::from_chars(), to_chars()   */
+
+namespace util
+{
+
+/**
+ *  The value of a digit in any base up to 36, or 36 if it is not a digit.
+ */
+
+static int
+digit_value (char c)
+{
+    int result = 36;
+    if (c >= '0' && c <= '9')
+        result = c - '0';
+    else if (c >= 'a' && c <= 'z')
+        result = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'Z')
+        result = c - 'A' + 10;
+
+    return result;
+}
+
+static bool
+is_digit (char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ *  Checks for a word such as "inf" at \a pos, ignoring case.
+ */
+
+static bool
+matches_word (strview s, std::size_t pos, const char * word)
+{
+    bool result = true;
+    for ( ; *word != 0; ++word, ++pos)
+    {
+        char c = pos < s.size() ? s[pos] : 0 ;
+        if (c >= 'A' && c <= 'Z')
+            c = char(c - 'A' + 'a');
+
+        if (c != *word)
+        {
+            result = false;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Checks for a "0x" prefix followed by a hexadecimal digit at \a pos.
+ */
+
+static bool
+hex_prefix (strview s, std::size_t pos)
+{
+    return pos + 2 < s.size() && s[pos] == '0' &&
+        (s[pos + 1] == 'x' || s[pos + 1] == 'X') &&
+        digit_value(s[pos + 2]) < 16;
+}
+
+/**
+ *  Scans the digits of an integer, starting after any sign.
+ *
+ * \param [out] magnitude
+ *      The value without its sign, ULONG_MAX if it is too large. Not set
+ *      if there are no digits.
+ *
+ * \return
+ *      Returns the position after the digits, or of the character that is
+ *      not a digit if there are none.
+ */
+
+static convert_result
+scan_magnitude
+(
+    strview s, std::size_t pos, int base, unsigned long & magnitude
+)
+{
+    convert_result result{pos, convert_error::invalid};
+    if (base == 0 || base == 16)
+    {
+        if (hex_prefix(s, pos))
+        {
+            base = 16;
+            pos += 2;
+        }
+        else if (base == 0)
+            base = pos < s.size() && s[pos] == '0' ? 8 : 10 ;
+    }
+    if (base >= 2 && base <= 36)
+    {
+        const unsigned long ubase = (unsigned long)(base);
+        std::size_t start = pos;
+        bool overflow = false;
+        unsigned long value = 0;
+        for ( ; pos < s.size(); ++pos)
+        {
+            int d = digit_value(s[pos]);
+            if (d >= base)
+                break;
+
+            unsigned long ud = (unsigned long)(d);
+            if (value > (ULONG_MAX - ud) / ubase)
+                overflow = true;
+            else
+                value = value * ubase + ud;
+        }
+        if (pos > start)
+        {
+            magnitude = overflow ? ULONG_MAX : value ;
+            result.error = overflow ?
+                convert_error::out_of_range : convert_error::none ;
+        }
+        result.position = pos;
+    }
+    return result;
+}
+
+/**
+ *  Scans a signed integer, and clamps it to the range of a signed type
+ *  whose largest value is \a limit.
+ */
+
+static convert_result
+scan_signed (strview s, int base, unsigned long limit, long & value)
+{
+    std::size_t pos = 0;
+    bool negative = false;
+    if (! s.empty() && (s[0] == '-' || s[0] == '+'))
+    {
+        negative = s[0] == '-';
+        pos = 1;
+    }
+
+    unsigned long magnitude = 0;
+    convert_result result = scan_magnitude(s, pos, base, magnitude);
+    if (result.error != convert_error::invalid)
+    {
+        if (negative)
+            ++limit;                    /* e.g. LONG_MIN is -LONG_MAX - 1   */
+
+        if (magnitude > limit)
+        {
+            magnitude = limit;
+            result.error = convert_error::out_of_range;
+        }
+        if (negative)
+            value = magnitude == 0 ? 0L : -long(magnitude - 1) - 1 ;
+        else
+            value = long(magnitude);
+    }
+    return result;
+}
+
+/**
+ *  Parses a long integer.
+ *
+ * \param s
+ *      The text, which must start with the number or its sign.
+ *
+ * \param [out] value
+ *      Set to the number, or to LONG_MAX or LONG_MIN if it is too large.
+ *      Not changed if the text is invalid.
+ *
+ * \param base
+ *      The base from 2 to 36, or 0 to pick 8, 10, or 16 by the prefix.
+ *
+ * \return
+ *      Returns the error, if any, and the position where parsing stopped.
+ */
+
+convert_result
+from_chars (strview s, long & value, int base)
+{
+    return scan_signed(s, base, (unsigned long)(LONG_MAX), value);
+}
+
+convert_result
+from_chars (strview s, int & value, int base)
+{
+    long v;
+    convert_result result = scan_signed(s, base, (unsigned long)(INT_MAX), v);
+    if (result.error != convert_error::invalid)
+        value = int(v);
+
+    return result;
+}
+
+/**
+ *  Parses an unsigned long integer. A '+' is allowed, but a '-' is
+ *  invalid.
+ */
+
+convert_result
+from_chars (strview s, unsigned long & value, int base)
+{
+    std::size_t pos = ! s.empty() && s[0] == '+' ? 1 : 0 ;
+    return scan_magnitude(s, pos, base, value);
+}
+
+/**
+ *  The parts of a floating value. The number is its digits times ten to
+ *  the power of the exponent. Leading and trailing zeros are dropped, and
+ *  digits past digits_max are summarized by a sticky flag, enough to
+ *  round the value correctly. The digits have room for the sticky digit
+ *  and the exponent, for decimal_text().
+ */
+
+struct decimal_number
+{
+    enum class kind { finite, hex, infinity, nan };
+
+    static const int digits_max = 768;
+
+    kind number_kind;
+    bool negative;
+    bool sticky;
+    int count;
+    long exponent;
+    unsigned long long mantissa;
+    char digits[digits_max + number_chars_max + 3];
+};
+
+/**
+ *  Scans the text of a floating value: a sign, then "inf", "infinity", or
+ *  "nan", or a hexadecimal integer, or decimal digits with an optional
+ *  point and exponent.
+ */
+
+static convert_result
+scan_decimal (strview s, decimal_number & d)
+{
+    const long exponent_max = 100000;
+    convert_result result{0, convert_error::none};
+    std::size_t n = s.size();
+    std::size_t pos = 0;
+    d.number_kind = decimal_number::kind::finite;
+    d.negative = false;
+    d.sticky = false;
+    d.count = 0;
+    d.exponent = 0;
+    d.mantissa = 0;
+    if (pos < n && (s[pos] == '-' || s[pos] == '+'))
+        d.negative = s[pos++] == '-';
+
+    if (matches_word(s, pos, "inf"))
+    {
+        d.number_kind = decimal_number::kind::infinity;
+        pos += matches_word(s, pos, "infinity") ? 8 : 3 ;
+    }
+    else if (matches_word(s, pos, "nan"))
+    {
+        d.number_kind = decimal_number::kind::nan;
+        pos += 3;
+    }
+    else if (hex_prefix(s, pos))
+    {
+        unsigned long magnitude = 0;
+        d.number_kind = decimal_number::kind::hex;
+        result = scan_magnitude(s, pos, 16, magnitude);
+        d.mantissa = magnitude;
+        pos = result.position;
+    }
+    else
+    {
+        bool any = false;
+        bool point = false;
+        for ( ; pos < n; ++pos)
+        {
+            char c = s[pos];
+            if (is_digit(c))
+            {
+                any = true;
+                if (c != '0' || d.count > 0 || d.sticky)
+                {
+                    if (d.count < decimal_number::digits_max)
+                        d.digits[d.count++] = c;
+                    else
+                    {
+                        if (c != '0')
+                            d.sticky = true;
+
+                        ++d.exponent;
+                    }
+                }
+                if (point)
+                    --d.exponent;
+            }
+            else if (c == '.' && ! point)
+                point = true;
+            else
+                break;
+        }
+        if (any)
+        {
+            if (pos < n && (s[pos] == 'e' || s[pos] == 'E'))
+            {
+                std::size_t epos = pos + 1;
+                bool eneg = false;
+                if (epos < n && (s[epos] == '-' || s[epos] == '+'))
+                    eneg = s[epos++] == '-';
+
+                if (epos < n && is_digit(s[epos]))
+                {
+                    long e = 0;
+                    for ( ; epos < n && is_digit(s[epos]); ++epos)
+                    {
+                        if (e < exponent_max)
+                            e = e * 10 + (s[epos] - '0');
+                    }
+                    d.exponent += eneg ? -e : e ;
+                    pos = epos;
+                }
+            }
+            while (d.count > 0 && ! d.sticky && d.digits[d.count - 1] == '0')
+            {
+                --d.count;
+                ++d.exponent;
+            }
+            if (d.count <= 19)
+            {
+                for (int i = 0; i < d.count; ++i)
+                    d.mantissa = d.mantissa * 10 + (d.digits[i] - '0');
+            }
+        }
+        else
+            result.error = convert_error::invalid;
+    }
+    result.position = pos;
+    return result;
+}
+
+/**
+ *  Ends the digits of a decimal number with its exponent, as a C string
+ *  with no decimal point, for std::strtod() or std::strtof().
+ */
+
+static const char *
+decimal_text (decimal_number & d)
+{
+    long exponent = d.exponent;
+    if (d.sticky)
+    {
+        d.digits[d.count++] = '1';
+        --exponent;
+    }
+
+    char * e = d.digits + d.count;
+    *e++ = 'e';
+
+    convert_result cr = to_chars(e, number_chars_max, exponent);
+    e[cr.position] = 0;
+    return d.digits;
+}
+
+/**
+ *  Parses a double value. The text can be as for std::strtod(), except
+ *  that a hexadecimal value must be an integer.
+ *
+ * \param [out] value
+ *      Set to the value correctly rounded, or to plus or minus infinity if
+ *      it is too large. A value too small to represent becomes 0 or a
+ *      denormal, without error. Not changed if the text is invalid.
+ */
+
+convert_result
+from_chars (strview s, double & value)
+{
+    static const double s_powers [] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+    decimal_number d;
+    convert_result result = scan_decimal(s, d);
+    if (result.error != convert_error::invalid)
+    {
+        double v = 0.0;
+        if (d.number_kind == decimal_number::kind::infinity)
+            v = std::numeric_limits<double>::infinity();
+        else if (d.number_kind == decimal_number::kind::nan)
+            v = std::numeric_limits<double>::quiet_NaN();
+        else if (d.number_kind == decimal_number::kind::hex)
+            v = double(d.mantissa);
+        else if (d.count > 0)
+        {
+            bool fast = FLT_EVAL_METHOD == 0 && d.count <= 19 &&
+                d.mantissa <= (1ULL << 53) &&
+                d.exponent >= -22 && d.exponent <= 22;
+
+            if (fast)
+            {
+                v = double(d.mantissa);
+                if (d.exponent < 0)
+                    v /= s_powers[-d.exponent];
+                else
+                    v *= s_powers[d.exponent];
+            }
+            else
+            {
+                errno = 0;
+                v = std::strtod(decimal_text(d), nullptr);
+                if (errno == ERANGE && std::isinf(v))
+                    result.error = convert_error::out_of_range;
+            }
+        }
+        value = d.negative ? -v : v ;
+    }
+    return result;
+}
+
+/**
+ *  Parses a float value. The value is rounded once, from the text to a
+ *  float, not from the text to a double and then to a float.
+ */
+
+convert_result
+from_chars (strview s, float & value)
+{
+    static const float s_powers [] =
+    {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+    decimal_number d;
+    convert_result result = scan_decimal(s, d);
+    if (result.error != convert_error::invalid)
+    {
+        float v = 0.0f;
+        if (d.number_kind == decimal_number::kind::infinity)
+            v = std::numeric_limits<float>::infinity();
+        else if (d.number_kind == decimal_number::kind::nan)
+            v = std::numeric_limits<float>::quiet_NaN();
+        else if (d.number_kind == decimal_number::kind::hex)
+            v = float(d.mantissa);
+        else if (d.count > 0)
+        {
+            bool fast = FLT_EVAL_METHOD == 0 && d.count <= 19 &&
+                d.mantissa <= (1ULL << 24) &&
+                d.exponent >= -10 && d.exponent <= 10;
+
+            if (fast)
+            {
+                v = float(d.mantissa);
+                if (d.exponent < 0)
+                    v /= s_powers[-d.exponent];
+                else
+                    v *= s_powers[d.exponent];
+            }
+            else
+            {
+                errno = 0;
+                v = std::strtof(decimal_text(d), nullptr);
+                if (errno == ERANGE && std::isinf(v))
+                    result.error = convert_error::out_of_range;
+            }
+        }
+        value = d.negative ? -v : v ;
+    }
+    return result;
+}
+
+/**
+ *  Copies converted text to the destination, if it fits.
+ */
+
+static convert_result
+copy_out (char * dest, std::size_t sz, const char * text, std::size_t len)
+{
+    convert_result result{0, convert_error::out_of_range};
+    if (not_nullptr(dest) && len <= sz)
+    {
+        std::memcpy(dest, text, len);
+        result.position = len;
+        result.error = convert_error::none;
+    }
+    return result;
+}
+
+/**
+ *  Writes an integer from its magnitude and sign.
+ */
+
+static convert_result
+format_integer
+(
+    char * dest, std::size_t sz, unsigned long magnitude, bool negative
+)
+{
+    char temp[number_chars_max];
+    char * p = temp + sizeof temp;
+    do
+    {
+        *--p = char('0' + magnitude % 10);
+        magnitude /= 10;
+
+    } while (magnitude > 0);
+
+    if (negative)
+        *--p = '-';
+
+    return copy_out(dest, sz, p, std::size_t(temp + sizeof temp - p));
+}
+
+/**
+ *  Writes an integer in decimal.
+ *
+ * \return
+ *      Returns the number of characters written, or out_of_range (and
+ *      nothing written) if they do not fit in \a sz characters.
+ */
+
+convert_result
+to_chars (char * dest, std::size_t sz, long value)
+{
+    unsigned long magnitude = value < 0 ?
+        0UL - (unsigned long)(value) : (unsigned long)(value) ;
+
+    return format_integer(dest, sz, magnitude, value < 0);
+}
+
+convert_result
+to_chars (char * dest, std::size_t sz, unsigned long value)
+{
+    return format_integer(dest, sz, value, false);
+}
+
+convert_result
+to_chars (char * dest, std::size_t sz, int value)
+{
+    return to_chars(dest, sz, long(value));
+}
+
+/**
+ *  Formats a value with "%.*g", and puts back a '.' if the locale uses
+ *  something else.
+ */
+
+static std::size_t
+format_general (char * temp, std::size_t tempsz, double value, int digits)
+{
+    int n = std::snprintf(temp, tempsz, "%.*g", digits, value);
+    std::size_t result = n > 0 ? std::size_t(n) : 0 ;
+    if (result >= tempsz)
+        result = tempsz - 1;
+
+    const char * point = std::localeconv()->decimal_point;
+    bool c_point = is_nullptr(point) || point[0] == 0 ||
+        (point[0] == '.' && point[1] == 0);
+
+    if (! c_point)
+    {
+        char * p = std::strstr(temp, point);
+        if (not_nullptr(p))
+        {
+            std::size_t plen = std::strlen(point);
+            std::size_t tail = result - std::size_t(p - temp) - plen;
+            *p = '.';
+            std::memmove(p + 1, p + plen, tail + 1);
+            result -= plen - 1;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Writes "inf", "-inf", or "nan", if the value is one of them.
+ */
+
+static const char *
+special_text (double value)
+{
+    const char * result = nullptr;
+    if (std::isnan(value))
+        result = "nan";
+    else if (std::isinf(value))
+        result = value < 0 ? "-inf" : "inf" ;
+
+    return result;
+}
+
+/**
+ *  Writes a double value.
+ *
+ * \param precision
+ *      If greater than 0, the number of significant digits, as for "%.*g",
+ *      up to 40. Otherwise the fewest digits that read back as the same
+ *      value, at most 17.
+ */
+
+convert_result
+to_chars (char * dest, std::size_t sz, double value, int precision)
+{
+    char temp[64];
+    std::size_t len = 0;
+    const char * special = special_text(value);
+    if (not_nullptr(special))
+    {
+        len = std::strlen(special);
+        std::memcpy(temp, special, len);
+    }
+    else if (precision > 0)
+    {
+        int digits = precision < 40 ? precision : 40 ;
+        len = format_general(temp, sizeof temp, value, digits);
+    }
+    else
+    {
+        for (int digits = DBL_DIG; digits <= 17; ++digits)
+        {
+            double back;
+            len = format_general(temp, sizeof temp, value, digits);
+            if (from_chars(strview(temp, len), back).ok() && back == value)
+                break;
+        }
+    }
+    return copy_out(dest, sz, temp, len);
+}
+
+/**
+ *  Writes a float value. Without a precision, this is the fewest digits
+ *  that read back as the same float, at most 9, so that 0.1f is "0.1"
+ *  rather than the "0.100000001490116" of the double it widens to.
+ */
+
+convert_result
+to_chars (char * dest, std::size_t sz, float value, int precision)
+{
+    char temp[64];
+    std::size_t len = 0;
+    const char * special = special_text(value);
+    if (not_nullptr(special))
+    {
+        len = std::strlen(special);
+        std::memcpy(temp, special, len);
+    }
+    else if (precision > 0)
+    {
+        int digits = precision < 40 ? precision : 40 ;
+        len = format_general(temp, sizeof temp, double(value), digits);
+    }
+    else
+    {
+        for (int digits = FLT_DIG; digits <= 9; ++digits)
+        {
+            float back;
+            len = format_general(temp, sizeof temp, double(value), digits);
+            if (from_chars(strview(temp, len), back).ok() && back == value)
+                break;
+        }
+    }
+    return copy_out(dest, sz, temp, len);
+}
+
+}           // namespace util
+
+/*
+ * charconv.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
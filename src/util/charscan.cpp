@@ -0,0 +1,376 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          charscan.cpp
+ *
+ *  This module declares/defines a small set of characters that can be
+ *  searched for many bytes at a time.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The tokenizers look for the first of a few delimiters: white space,
+ *  quotes, "=", or brackets. std::string::find_first_of() checks each
+ *  byte against each delimiter. Here a block of bytes is compared to each
+ *  delimiter at once, the results are OR'ed, and the first match is the
+ *  lowest set bit of the mask of the block:
+ *
+\verbatim
+        hits = (block == ' ') | (block == '\t') | (block == '=') ...
+        first = count_trailing_zeros(movemask(hits))
+\endverbatim
+ *
+ *  For find_first_not_of() the mask is inverted. The block is 32 bytes
+ *  with AVX2, 16 bytes with SSE2 or NEON. SSE2 is always present on
+ *  x86-64, and NEON on 64-bit ARM, but AVX2 is not, so the code for it is
+ *  compiled for AVX2 alone, and is picked at run time if the processor has
+ *  it. Other processors, sets of more than charset::simd_max characters,
+ *  and the last few bytes, use a bitmap of the set, one byte at a time.
+ *
+ *  The work per block grows with the size of the set, which is why the
+ *  vector code is used only for small sets. The delimiter sets in cfg66
+ *  have at most 8 characters.
+ */
+
+#include "util/charscan.hpp"            /* util::charset class              */
+
+#include "platform_macros.h"            /* PLATFORM_GNU, etc.               */
+
+#if defined __SSE2__ || defined _M_X64
+#define CFG66_CHARSCAN_SSE2
+#include <emmintrin.h>                  /* _mm_cmpeq_epi8(), etc.           */
+#if (defined __x86_64__ || defined __i386__) && \
+    (defined PLATFORM_GNU || defined PLATFORM_CLANG)
+#define CFG66_CHARSCAN_AVX2
+#include <immintrin.h>                  /* _mm256_cmpeq_epi8(), etc.        */
+#endif
+#elif defined __ARM_NEON && defined __aarch64__
+#define CFG66_CHARSCAN_NEON
+#include <arm_neon.h>                   /* vceqq_u8(), etc.                 */
+#endif
+
+namespace util
+{
+
+/**
+ *  A scanner function. It returns the offset of the first byte in the set,
+ *  or not in the set if \a negate is true, or \a sz if there is none.
+ */
+
+using scanner = std::size_t (*)
+(
+    const charset & cs,
+    const char * data,
+    std::size_t sz,
+    bool negate
+);
+
+/**
+ *  Counts the trailing zero bits of a non-zero mask.
+ */
+
+static inline int
+trailing_zeros (unsigned long long x)
+{
+#if defined PLATFORM_GNU || defined PLATFORM_CLANG
+    return __builtin_ctzll(x);
+#else
+    int result = 0;
+    while ((x & 1) == 0)
+    {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+/**
+ *  The byte-at-a-time search, for the tail of the data and for any
+ *  processor or set the vector code does not handle.
+ */
+
+static std::size_t
+scan_scalar
+(
+    const charset & cs,
+    const char * data,
+    std::size_t sz,
+    bool negate
+)
+{
+    std::size_t i = 0;
+    for ( ; i < sz; ++i)
+    {
+        if (cs.contains(data[i]) != negate)
+            break;
+    }
+    return i;
+}
+
+#if defined CFG66_CHARSCAN_SSE2
+
+static std::size_t
+scan_sse2
+(
+    const charset & cs,
+    const char * data,
+    std::size_t sz,
+    bool negate
+)
+{
+    __m128i sets[charset::simd_max];
+    int n = cs.count();
+    for (int k = 0; k < n; ++k)
+        sets[k] = _mm_set1_epi8(char(cs.chars()[k]));
+
+    unsigned flip = negate ? 0xFFFFu : 0u ;
+    bool found = false;
+    std::size_t i = 0;
+    for ( ; sz - i >= 16; i += 16)
+    {
+        __m128i block = _mm_loadu_si128
+        (
+            reinterpret_cast<const __m128i *>(data + i)
+        );
+        __m128i hits = _mm_cmpeq_epi8(block, sets[0]);
+        for (int k = 1; k < n; ++k)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, sets[k]));
+
+        unsigned mask = unsigned(_mm_movemask_epi8(hits)) ^ flip;
+        if (mask != 0)
+        {
+            found = true;
+            i += std::size_t(trailing_zeros(mask));
+            break;
+        }
+    }
+    return found ? i : i + scan_scalar(cs, data + i, sz - i, negate) ;
+}
+
+#endif  // defined CFG66_CHARSCAN_SSE2
+
+#if defined CFG66_CHARSCAN_AVX2
+
+__attribute__((target("avx2")))
+static std::size_t
+scan_avx2
+(
+    const charset & cs,
+    const char * data,
+    std::size_t sz,
+    bool negate
+)
+{
+    __m256i sets[charset::simd_max];
+    int n = cs.count();
+    for (int k = 0; k < n; ++k)
+        sets[k] = _mm256_set1_epi8(char(cs.chars()[k]));
+
+    unsigned flip = negate ? 0xFFFFFFFFu : 0u ;
+    bool found = false;
+    std::size_t i = 0;
+    for ( ; sz - i >= 32; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256
+        (
+            reinterpret_cast<const __m256i *>(data + i)
+        );
+        __m256i hits = _mm256_cmpeq_epi8(block, sets[0]);
+        for (int k = 1; k < n; ++k)
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, sets[k]));
+
+        unsigned mask = unsigned(_mm256_movemask_epi8(hits)) ^ flip;
+        if (mask != 0)
+        {
+            found = true;
+            i += std::size_t(trailing_zeros(mask));
+            break;
+        }
+    }
+    return found ? i : i + scan_sse2(cs, data + i, sz - i, negate) ;
+}
+
+#endif  // defined CFG66_CHARSCAN_AVX2
+
+#if defined CFG66_CHARSCAN_NEON
+
+/**
+ *  NEON has no movemask. Narrowing each 16-bit lane of the compare result
+ *  by 4 bits gives a 64-bit word with 4 bits per byte, so the first hit is
+ *  the trailing zero count divided by 4.
+ */
+
+static std::size_t
+scan_neon
+(
+    const charset & cs,
+    const char * data,
+    std::size_t sz,
+    bool negate
+)
+{
+    uint8x16_t sets[charset::simd_max];
+    int n = cs.count();
+    for (int k = 0; k < n; ++k)
+        sets[k] = vdupq_n_u8(cs.chars()[k]);
+
+    bool found = false;
+    std::size_t i = 0;
+    for ( ; sz - i >= 16; i += 16)
+    {
+        uint8x16_t block = vld1q_u8
+        (
+            reinterpret_cast<const uint8_t *>(data + i)
+        );
+        uint8x16_t hits = vceqq_u8(block, sets[0]);
+        for (int k = 1; k < n; ++k)
+            hits = vorrq_u8(hits, vceqq_u8(block, sets[k]));
+
+        if (negate)
+            hits = vmvnq_u8(hits);
+
+        uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(hits), 4);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrow), 0);
+        if (mask != 0)
+        {
+            found = true;
+            i += std::size_t(trailing_zeros(mask) / 4);
+            break;
+        }
+    }
+    return found ? i : i + scan_scalar(cs, data + i, sz - i, negate) ;
+}
+
+#endif  // defined CFG66_CHARSCAN_NEON
+
+/**
+ *  Picks the best scanner for this processor, once.
+ */
+
+static scanner
+select_scanner (const char * & name)
+{
+    scanner result = scan_scalar;
+    name = "scalar";
+#if defined CFG66_CHARSCAN_SSE2
+    result = scan_sse2;
+    name = "sse2";
+#if defined CFG66_CHARSCAN_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        result = scan_avx2;
+        name = "avx2";
+    }
+#endif
+#elif defined CFG66_CHARSCAN_NEON
+    result = scan_neon;
+    name = "neon";
+#endif
+    return result;
+}
+
+/**
+ *  The scanner in use, and its name, for diagnostics and tests.
+ */
+
+static const char * s_scanner_name = nullptr;
+
+static scanner
+vector_scanner ()
+{
+    static const scanner s_scanner = select_scanner(s_scanner_name);
+    return s_scanner;
+}
+
+const char *
+charscan_method ()
+{
+    (void) vector_scanner();
+    return s_scanner_name;
+}
+
+/**
+ *  Makes a set from a list of characters. Repeated characters are dropped.
+ */
+
+charset::charset (const char * chars, std::size_t count) :
+    m_chars (),
+    m_count (0),
+    m_bits  ()
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        char c = chars[i];
+        if (! contains(c))
+        {
+            unsigned char b = static_cast<unsigned char>(c);
+            m_bits[b >> 6] |= 1ULL << (b & 63);
+            if (m_count < simd_max)
+                m_chars[m_count] = b;
+
+            ++m_count;
+        }
+    }
+}
+
+/**
+ *  Finds the first byte that is in the set.
+ *
+ * \return
+ *      Returns the offset of the byte, or \a sz if there is none.
+ */
+
+std::size_t
+charset::find_first_of (const char * data, std::size_t sz) const
+{
+    bool vector = sz >= 16 && m_count > 0 && m_count <= simd_max;
+    return vector ?
+        vector_scanner()(*this, data, sz, false) :
+        scan_scalar(*this, data, sz, false) ;
+}
+
+/**
+ *  Finds the first byte that is not in the set.
+ *
+ * \return
+ *      Returns the offset of the byte, or \a sz if there is none.
+ */
+
+std::size_t
+charset::find_first_not_of (const char * data, std::size_t sz) const
+{
+    bool vector = sz >= 16 && m_count > 0 && m_count <= simd_max;
+    return vector ?
+        vector_scanner()(*this, data, sz, true) :
+        scan_scalar(*this, data, sz, true) ;
+}
+
+}           // namespace util
+
+/*
+ * charscan.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,213 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          chunkindex.cpp
+ *
+ *  This module declares/defines an index of the chunks of a tagged-length
+ *  container, such as a MIDI file.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A Standard MIDI File is a series of chunks, each with a 4-byte tag
+ *  ("MThd", "MTrk"), a 4-byte big-endian length, and then the data. Finding
+ *  the fifth track with get_long() and skip() means walking the first four.
+ *  Instead, scan() walks the headers once, reading only 8 bytes per chunk,
+ *  and records the tag, offset, and length of each:
+ *
+\verbatim
+        util::bytevector file;
+        file.read_mapped("song.midi");
+        util::chunkindex index;
+        index.scan(file);
+        util::byteview header = index.view("MThd");
+        util::byteview track5 = index.view("MTrk", 4);
+\endverbatim
+ *
+ *  The views share the scanned bytes, so each track can be handed to its
+ *  own parser, or thread, without copying. As with byteview, the bytes
+ *  must outlive the index and its views.
+ *
+ *  IFF files pad each odd-length chunk with a byte; pass padeven = true to
+ *  scan() for those. RIFF files use little-endian lengths and are not
+ *  handled.
+ */
+
+#include "util/chunkindex.hpp"          /* util::chunkindex class           */
+
+namespace util
+{
+
+/**
+ *  The size of a chunk header: the tag and the length.
+ */
+
+static const size_t c_chunk_header_size = 8;
+
+chunkindex::chunkindex () :
+    m_data      (),
+    m_chunks    (),
+    m_truncated (false)
+{
+    // no code
+}
+
+/**
+ *  Converts a 4-character tag such as "MTrk" to the big-endian value read
+ *  from a file. Shorter tags are padded with spaces, as IFF does.
+ */
+
+util::ulong
+chunkindex::make_tag (const std::string & tag)
+{
+    util::ulong result = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        util::byte c = i < tag.size() ? util::byte(tag[i]) : util::byte(' ');
+        result = (result << 8) | c;
+    }
+    return result;
+}
+
+std::string
+chunkindex::tag_name (util::ulong tag)
+{
+    std::string result;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        result.push_back(char((tag >> shift) & 0xFF));
+
+    return result;
+}
+
+/**
+ *  Builds the index in one pass over the chunk headers.
+ *
+ * \param data
+ *      The bytes of the container. The whole view is scanned, regardless
+ *      of its position.
+ *
+ * \param padeven
+ *      If true, odd-length chunks are followed by a pad byte, as in IFF.
+ *
+ * \return
+ *      Returns true if at least one chunk was found and the container was
+ *      not truncated.
+ */
+
+bool
+chunkindex::scan (const byteview & data, bool padeven)
+{
+    m_data = data;
+    m_chunks.clear();
+    m_truncated = false;
+
+    const util::byte * base = data.data();
+    size_t sz = data.size();
+    size_t pos = 0;
+    while (sz - pos >= c_chunk_header_size)
+    {
+        chunk c;
+        c.chunk_tag = load_big<util::ulong>(base + pos);
+        c.chunk_length = size_t(load_big<util::ulong>(base + pos + 4));
+        c.chunk_offset = pos + c_chunk_header_size;
+
+        size_t avail = sz - c.chunk_offset;
+        if (c.chunk_length > avail)
+        {
+            c.chunk_length = avail;
+            m_truncated = true;
+        }
+        m_chunks.push_back(c);
+        pos = c.chunk_offset + c.chunk_length;
+        if (padeven && (c.chunk_length % 2) != 0 && pos < sz)
+            ++pos;
+    }
+    if (pos < sz)
+        m_truncated = true;                     /* stray bytes at the end   */
+
+    return ! m_chunks.empty() && ! m_truncated;
+}
+
+/**
+ *  Finds a chunk by tag.
+ *
+ * \param tag
+ *      The tag value, as made by make_tag().
+ *
+ * \param nth
+ *      Which of the chunks with that tag to find, counting from 0.
+ *
+ * \return
+ *      Returns the index of the chunk, or -1 if not found.
+ */
+
+int
+chunkindex::find (util::ulong tag, int nth) const
+{
+    int result = -1;
+    int found = 0;
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        if (m_chunks[i].chunk_tag == tag)
+        {
+            if (found == nth)
+            {
+                result = int(i);
+                break;
+            }
+            ++found;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Gets the data of a chunk, without its header, as a view.
+ *
+ * \return
+ *      Returns an empty view if the index is out of range.
+ */
+
+byteview
+chunkindex::view (int index) const
+{
+    byteview result;
+    if (index >= 0 && size_t(index) < m_chunks.size())
+    {
+        const chunk & c = m_chunks[size_t(index)];
+        result = byteview
+        (
+            m_data.data() + c.chunk_offset, c.chunk_length,
+            m_data.offset() + c.chunk_offset
+        );
+    }
+    return result;
+}
+
+}           // namespace util
+
+/*
+ * chunkindex.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,364 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          hash64.cpp
+ *
+ *  This module declares/defines a fast 64-bit hash of data, files, and
+ *  strings, for detecting changes.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  util::simple_hash() makes a short string from a name, for NSM; it has
+ *  only 16 bits and takes a byte at a time. To tell whether a file, a
+ *  bytevector, or the options of a section have changed since they were
+ *  last saved, it is enough to keep a 64-bit hash of them and compare it to
+ *  a new one, rather than keeping and comparing the text.
+ *
+ *  The hash is XXH64, from Yann Collet's xxHash, whose digests are
+ *  published, so other tools can check them:
+ *
+\verbatim
+        hash_string("")     ef46db3751d8e999
+        hash_string("abc")  44bc2cf5ad770999
+\endverbatim
+ *
+ *  It reads 32 bytes at a time into four independent lanes of multiply and
+ *  rotate, which keeps the processor busy, then folds the lanes and the
+ *  tail together. It is not a cryptographic hash: it detects changes, but
+ *  cannot tell whether a file was altered on purpose.
+ */
+
+#include <cstdio>                       /* std::fopen(), std::fread()       */
+#include <cstring>                      /* std::memcpy()                    */
+#include <vector>                       /* std::vector<> buffer             */
+
+#include "util/hash64.hpp"              /* util::hash64 class               */
+
+namespace util
+{
+
+/**
+ *  The XXH64 primes.
+ */
+
+static const std::uint64_t c_prime_1 = 0x9E3779B185EBCA87ULL;
+static const std::uint64_t c_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+static const std::uint64_t c_prime_3 = 0x165667B19E3779F9ULL;
+static const std::uint64_t c_prime_4 = 0x85EBCA77C2B2AE63ULL;
+static const std::uint64_t c_prime_5 = 0x27D4EB2F165667C5ULL;
+
+/**
+ *  The size of the blocks read by hash_file().
+ */
+
+static const std::size_t c_file_block = 64 * 1024;
+
+static inline std::uint64_t
+rotate_left (std::uint64_t x, int bits)
+{
+    return (x << bits) | (x >> (64 - bits));
+}
+
+/**
+ *  Reads little-endian words, whatever the byte order of the processor,
+ *  so that a digest is the same everywhere.
+ */
+
+static inline std::uint64_t
+read_64 (const unsigned char * p)
+{
+    std::uint64_t result;
+    std::memcpy(&result, p, sizeof result);
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+static inline std::uint64_t
+read_32 (const unsigned char * p)
+{
+    std::uint32_t result;
+    std::memcpy(&result, p, sizeof result);
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap32(result);
+#endif
+    return std::uint64_t(result);
+}
+
+static inline std::uint64_t
+mix_lane (std::uint64_t lane, std::uint64_t input)
+{
+    lane += input * c_prime_2;
+    lane = rotate_left(lane, 31);
+    return lane * c_prime_1;
+}
+
+static inline std::uint64_t
+merge_lane (std::uint64_t h, std::uint64_t lane)
+{
+    h ^= mix_lane(0, lane);
+    return h * c_prime_1 + c_prime_4;
+}
+
+/**
+ *  Mixes whole stripes into the lanes.
+ *
+ * \return
+ *      Returns the number of bytes used, a multiple of the stripe size.
+ */
+
+static std::size_t
+mix_stripes (std::uint64_t * lanes, const unsigned char * p, std::size_t sz)
+{
+    std::uint64_t v1 = lanes[0];
+    std::uint64_t v2 = lanes[1];
+    std::uint64_t v3 = lanes[2];
+    std::uint64_t v4 = lanes[3];
+    std::size_t result = 0;
+    for ( ; sz - result >= hash64::stripe_size; result += hash64::stripe_size)
+    {
+        const unsigned char * s = p + result;
+        v1 = mix_lane(v1, read_64(s));
+        v2 = mix_lane(v2, read_64(s + 8));
+        v3 = mix_lane(v3, read_64(s + 16));
+        v4 = mix_lane(v4, read_64(s + 24));
+    }
+    lanes[0] = v1;
+    lanes[1] = v2;
+    lanes[2] = v3;
+    lanes[3] = v4;
+    return result;
+}
+
+hash64::hash64 (value_type seed) :
+    m_lanes     (),
+    m_buffer    (),
+    m_buffered  (0),
+    m_total     (0),
+    m_seed      (seed)
+{
+    reset(seed);
+}
+
+/**
+ *  Starts a new digest.
+ */
+
+void
+hash64::reset (value_type seed)
+{
+    m_lanes[0] = seed + c_prime_1 + c_prime_2;
+    m_lanes[1] = seed + c_prime_2;
+    m_lanes[2] = seed;
+    m_lanes[3] = seed - c_prime_1;
+    m_buffered = 0;
+    m_total = 0;
+    m_seed = seed;
+}
+
+/**
+ *  Adds bytes to the digest. Whole stripes are mixed in place; only a
+ *  partial stripe at either end is copied to the buffer.
+ */
+
+void
+hash64::update (const void * data, std::size_t sz)
+{
+    const unsigned char * p = static_cast<const unsigned char *>(data);
+    m_total += sz;
+    if (m_buffered > 0)
+    {
+        std::size_t fill = stripe_size - m_buffered;
+        if (fill > sz)
+            fill = sz;
+
+        std::memcpy(m_buffer + m_buffered, p, fill);
+        m_buffered += fill;
+        p += fill;
+        sz -= fill;
+        if (m_buffered == stripe_size)
+        {
+            (void) mix_stripes(m_lanes, m_buffer, stripe_size);
+            m_buffered = 0;
+        }
+    }
+    if (sz > 0)
+    {
+        std::size_t used = mix_stripes(m_lanes, p, sz);
+        std::memcpy(m_buffer, p + used, sz - used);
+        m_buffered = sz - used;
+    }
+}
+
+/**
+ *  Adds a string preceded by its length, so that a list of fields, such as
+ *  option names and values, cannot give the same digest as a different
+ *  list with the same characters: "ab", "c" is not "a", "bc".
+ */
+
+void
+hash64::update_field (strview s)
+{
+    unsigned char length[8];
+    std::uint64_t n = s.size();
+    for (int i = 0; i < 8; ++i)
+        length[i] = static_cast<unsigned char>(n >> (8 * i));
+
+    update(length, sizeof length);
+    update(s);
+}
+
+/**
+ *  Gets the digest of the bytes so far. More bytes can still be added
+ *  afterward.
+ */
+
+hash64::value_type
+hash64::digest () const
+{
+    value_type h;
+    if (m_total >= stripe_size)
+    {
+        h = rotate_left(m_lanes[0], 1) + rotate_left(m_lanes[1], 7) +
+            rotate_left(m_lanes[2], 12) + rotate_left(m_lanes[3], 18);
+
+        for (int i = 0; i < 4; ++i)
+            h = merge_lane(h, m_lanes[i]);
+    }
+    else
+        h = m_seed + c_prime_5;
+
+    h += m_total;
+
+    const unsigned char * p = m_buffer;
+    std::size_t remaining = m_buffered;
+    for ( ; remaining >= 8; remaining -= 8, p += 8)
+    {
+        h ^= mix_lane(0, read_64(p));
+        h = rotate_left(h, 27) * c_prime_1 + c_prime_4;
+    }
+    if (remaining >= 4)
+    {
+        h ^= read_32(p) * c_prime_1;
+        h = rotate_left(h, 23) * c_prime_2 + c_prime_3;
+        remaining -= 4;
+        p += 4;
+    }
+    for ( ; remaining > 0; --remaining, ++p)
+    {
+        h ^= *p * c_prime_5;
+        h = rotate_left(h, 11) * c_prime_1;
+    }
+    h ^= h >> 33;
+    h *= c_prime_2;
+    h ^= h >> 29;
+    h *= c_prime_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ *  Hashes a block of bytes, such as the data of a bytevector.
+ */
+
+std::uint64_t
+hash_bytes (const void * data, std::size_t sz, std::uint64_t seed)
+{
+    hash64 h(seed);
+    h.update(data, sz);
+    return h.digest();
+}
+
+std::uint64_t
+hash_string (strview s, std::uint64_t seed)
+{
+    return hash_bytes(s.data(), s.size(), seed);
+}
+
+/**
+ *  Hashes the contents of a file, a block at a time, so that the file need
+ *  not fit in memory.
+ *
+ * \param filename
+ *      The file to read.
+ *
+ * \param [out] result
+ *      Set to the digest if the whole file could be read.
+ *
+ * \return
+ *      Returns false if the file could not be opened or read.
+ */
+
+bool
+hash_file (const std::string & filename, std::uint64_t & result)
+{
+    std::FILE * fp = std::fopen(filename.c_str(), "rb");
+    bool ok = not_nullptr(fp);
+    if (ok)
+    {
+        std::vector<unsigned char> block(c_file_block);
+        hash64 h;
+        for (;;)
+        {
+            std::size_t count = std::fread(block.data(), 1, block.size(), fp);
+            if (count > 0)
+                h.update(block.data(), count);
+
+            if (count < block.size())
+                break;
+        }
+        ok = std::ferror(fp) == 0;
+        (void) std::fclose(fp);
+        if (ok)
+            result = h.digest();
+    }
+    return ok;
+}
+
+/**
+ *  Writes a digest as 16 hexadecimal digits, for logs and for files that
+ *  store fingerprints.
+ */
+
+std::string
+hash_to_string (std::uint64_t h)
+{
+    static const char s_digits [] = "0123456789abcdef";
+    char temp[16];
+    for (int i = 15; i >= 0; --i)
+    {
+        temp[i] = s_digits[h & 0x0F];
+        h >>= 4;
+    }
+    return std::string(temp, sizeof temp);
+}
+
+}           // namespace util
+
+/*
+ * hash64.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,13 +25,14 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2018-11-10
- * \updates       2025-02-12
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
  *  One of the big features of some of these functions is writing the name
  *  of the application in color before each message that is put out.
  */
 
+#include <atomic>                       /* std::atomic<bool> for the flags  */
 #include <cstring>                      /* std::strlen(3), std::strerror(3) */
 #include <cstdarg>                      /* see "man stdarg(3)"              */
 #include <iostream>
@@ -81,9 +82,9 @@ static std::string formatted (const std::string & fmt, va_list args);
  *  also set these options.
  */
 
-static bool s_is_quiet = false;
-static bool s_is_verbose = false;
-static bool s_is_investigate = false;
+static std::atomic<bool> s_is_quiet{false};
+static std::atomic<bool> s_is_verbose{false};
+static std::atomic<bool> s_is_investigate{false};
 
 void
 set_quiet (bool flag)
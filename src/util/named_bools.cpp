@@ -19,18 +19,30 @@
 /**
  * \file          named_bools.cpp
  *
- *  This module declares/defines items for an abstract representation of the
- *  color of a sequence or panel item.  Colors are, of course, part of using a
- *  GUI, but here we are not tied to a GUI.
+ *  This module provides a map of booleans using a string as a key value,
+ *  and a lock-free variant for flags checked often and across threads.
  *
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2021-09-13
- * \updates       2022-07-01
+ * \updates       2026-10-18
  * \license       GNU GPLv2 or above
  *
- *  This module is inspired by MidiPerformance::getSequenceColor() in
- *  Kepler34.
+ *  The named_bools class is all inline. The atomic_named_bools class
+ *  splits the work into two parts:
+ *
+ *      -   Registration. add() interns a name, giving it the next free
+ *          bit, and returns that index as a handle. This takes a mutex,
+ *          and is meant to be done at start-up.
+ *      -   Use. get() and set() by handle are each one atomic load or
+ *          read-modify-write of a 64-bit word, so threads can check and
+ *          change flags without locking. Many flags can be tested at once
+ *          with a mask: all() and any() do one load and one AND per word
+ *          of the mask that has bits in it, which is usually one word.
+ *
+ *  A snapshot() is exact for the flags within one word. Flags in different
+ *  words are read one word at a time, so a snapshot of more than 64 flags
+ *  is not a single atomic view.
  */
 
 #include "util/named_bools.hpp"         /* util::named_bools class          */
@@ -41,11 +53,231 @@
 
 namespace util
 {
-    /*
-     * All code is in the header file.
-     */
+
+/*--------------------------------------------------------------------------
+ * atomic_named_bools
+ *--------------------------------------------------------------------------*/
+
+atomic_named_bools::atomic_named_bools () :
+    m_words     (),
+    m_handles   (),
+    m_names     (),
+    m_name_lock ()
+{
+    for (auto & w : m_words)
+        w.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Registers a name, and sets its initial value.
+ *
+ * \param name
+ *      The name of the flag.
+ *
+ * \param value
+ *      The initial value. Ignored if the name is already registered.
+ *
+ * \return
+ *      Returns the handle of the flag. If the name is already registered,
+ *      its existing handle is returned. If all of the bits are in use,
+ *      invalid (-1) is returned.
+ */
+
+atomic_named_bools::handle
+atomic_named_bools::add (const std::string & name, bool value)
+{
+    handle result = invalid;
+    bool added = false;
+    {
+        std::lock_guard<std::mutex> guard(m_name_lock);
+        auto it = m_handles.find(name);
+        if (it != m_handles.end())
+        {
+            result = it->second;
+        }
+        else if (int(m_names.size()) < capacity)
+        {
+            result = handle(m_names.size());
+            m_names.push_back(name);
+            (void) m_handles.insert(std::make_pair(name, result));
+            added = true;
+        }
+    }
+    if (added)
+        (void) set(result, value);
+
+    return result;
+}
+
+/**
+ *  Looks up the handle of a name.
+ *
+ * \return
+ *      Returns invalid (-1) if the name is not registered.
+ */
+
+atomic_named_bools::handle
+atomic_named_bools::find (const std::string & name) const
+{
+    std::lock_guard<std::mutex> guard(m_name_lock);
+    auto it = m_handles.find(name);
+    return it != m_handles.end() ? it->second : invalid ;
+}
+
+std::string
+atomic_named_bools::name (handle h) const
+{
+    std::lock_guard<std::mutex> guard(m_name_lock);
+    return h >= 0 && h < int(m_names.size()) ?
+        m_names[size_t(h)] : std::string() ;
+}
+
+int
+atomic_named_bools::count () const
+{
+    std::lock_guard<std::mutex> guard(m_name_lock);
+    return int(m_names.size());
+}
+
+/**
+ *  Removes all of the names and clears all of the flags. Handles obtained
+ *  earlier become meaningless, so no other thread should be using them.
+ */
+
+void
+atomic_named_bools::clear ()
+{
+    std::lock_guard<std::mutex> guard(m_name_lock);
+    m_handles.clear();
+    m_names.clear();
+    for (auto & w : m_words)
+        w.store(0, std::memory_order_release);
+}
+
+/**
+ *  Sets a flag by name, registering the name if needed, as named_bools
+ *  does. If another thread registers the same name first, add() returns
+ *  that handle and ignores \a value, so the value is set afterward in any
+ *  case.
+ *
+ * \return
+ *      Returns false if the name could not be registered.
+ */
+
+bool
+atomic_named_bools::set (const std::string & name, bool value)
+{
+    handle h = find(name);
+    if (h == invalid)
+        h = add(name, value);
+
+    if (h != invalid)
+        (void) set(h, value);           /* add() may have lost a race       */
+
+    return h != invalid;
+}
+
+/**
+ *  Makes a mask of several flags, for use with all(), any(), and
+ *  set(bits). Invalid handles are ignored.
+ */
+
+atomic_named_bools::bits
+atomic_named_bools::mask (std::initializer_list<handle> handles) const
+{
+    bits result;
+    for (auto h : handles)
+        result.set(h);
+
+    return result;
+}
+
+/**
+ *  Copies all of the flags.
+ */
+
+atomic_named_bools::bits
+atomic_named_bools::snapshot () const
+{
+    bits result;
+    for (int i = 0; i < word_count; ++i)
+        result.m_words[i] = m_words[i].load(std::memory_order_acquire);
+
+    return result;
+}
+
+/**
+ *  Indicates if all of the flags in the mask are set. An empty mask
+ *  yields true.
+ */
+
+bool
+atomic_named_bools::all (const bits & m) const
+{
+    bool result = true;
+    for (int i = 0; i < word_count; ++i)
+    {
+        word mw = m.m_words[i];
+        if (mw != 0)
+        {
+            word w = m_words[i].load(std::memory_order_acquire);
+            if ((w & mw) != mw)
+            {
+                result = false;
+                break;
+            }
+        }
+    }
+    return result;
 }
 
+/**
+ *  Indicates if any of the flags in the mask are set.
+ */
+
+bool
+atomic_named_bools::any (const bits & m) const
+{
+    bool result = false;
+    for (int i = 0; i < word_count; ++i)
+    {
+        word mw = m.m_words[i];
+        if (mw != 0)
+        {
+            word w = m_words[i].load(std::memory_order_acquire);
+            if ((w & mw) != 0)
+            {
+                result = true;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Sets or clears all of the flags in the mask, one atomic operation per
+ *  word of the mask.
+ */
+
+void
+atomic_named_bools::set (const bits & m, bool value)
+{
+    for (int i = 0; i < word_count; ++i)
+    {
+        word mw = m.m_words[i];
+        if (mw != 0)
+        {
+            if (value)
+                (void) m_words[i].fetch_or(mw, std::memory_order_acq_rel);
+            else
+                (void) m_words[i].fetch_and(~mw, std::memory_order_acq_rel);
+        }
+    }
+}
+
+}           // namespace util
+
 /*
  * named_bools.cpp
  *
@@ -25,12 +25,17 @@
  * \library       cfg66 application
  * \author        Chris Ahlstrom
  * \date          2018-11-24
- * \updates       2025-02-11
+ * \updates       2026-10-18
  * \version       $Revision$
  *
  *    We basically include only the functions we need for Seq66, not
  *    much more than that.  These functions are adapted from our xpc_basic
  *    project.
+ *
+ *    Many functions also have an overload taking util::strview, which
+ *    returns views of the caller's characters instead of new strings. See
+ *    the strview module. Where the two would do the same thing, the
+ *    std::string version calls the strview version.
  */
 
 #include <algorithm>                    /* std::find_if() function          */
@@ -38,8 +43,8 @@
 #include <climits>                      /* INT_MAX and its ilk              */
 #include <cmath>                        /* std::floor(), std::pow()         */
 #include <cstring>                      /* std::memcmp() function           */
-#include <stdexcept>                    /* std::invalid_argument            */
 
+#include "util/charconv.hpp"            /* util::from_chars(), to_chars()   */
 #include "util/strfunctions.hpp"        /* free functions in util n'space   */
 
 #if defined PLATFORM_WINDOWS
@@ -87,6 +92,12 @@ is_empty_string (const std::string & item)
     return item.empty() || item == double_quotes();
 }
 
+bool
+is_empty_string (strview item)
+{
+    return item.empty() || item == strview(double_quotes());
+}
+
 const std::string &
 questionable_string ()
 {
@@ -142,16 +153,19 @@ contains (const std::string & original, char c)
 std::string
 strip_comments (const std::string & item)
 {
-    std::string result = item;
-    auto hashpos = result.find_first_of("#");
+    return strip_comments(strview(item)).to_string();
+}
+
+strview
+strip_comments (strview item)
+{
+    strview result = item;
+    auto hashpos = result.find('#');
     auto qpos = result.find_first_of("\"'");
-    if (qpos != std::string::npos)
+    if (qpos != strview::npos)
     {
-        char quotechar[2] = { 'x', 0 };
-        quotechar[0] = result[qpos];
-
-        auto qpos2 = result.find_first_of(quotechar, qpos + 1);
-        if (qpos2 != std::string::npos)
+        auto qpos2 = result.find(result[qpos], qpos + 1);
+        if (qpos2 != strview::npos)
         {
             if (hashpos > qpos2)
                 result = result.substr(0, hashpos);
@@ -161,11 +175,10 @@ strip_comments (const std::string & item)
     }
     else
     {
-        if (hashpos != std::string::npos)
+        if (hashpos != strview::npos)
             result = result.substr(0, hashpos);
     }
-    result = trim(result, CFG66_TRIM_CHARS);
-    return result;
+    return trim(result, CFG66_TRIM_CHARS);
 }
 
 /**
@@ -235,28 +248,20 @@ next_bracketed_string
 std::string
 strip_quotes (const std::string & item)
 {
-    std::string result;
+    return strip_quotes(strview(item)).to_string();
+}
+
+strview
+strip_quotes (strview item)
+{
+    strview result = item;
     if (! item.empty())
     {
-        result = item;
-        auto fpos = result.find_first_of("\"");
-        if (fpos == 0)
+        char q = item.front();
+        if (q == '"' || q == '\'')
         {
-            auto lpos = result.find_last_of("\"");
-            auto end_index = result.length() - 1;
-            if (lpos != std::string::npos && lpos == end_index)
-                result = result.substr(1, end_index - 1);
-        }
-        else
-        {
-            fpos = result.find_first_of("'");
-            if (fpos == 0)
-            {
-                auto lpos = result.find_last_of("'");
-                auto end_index = result.length() - 1;
-                if (lpos != std::string::npos && lpos == end_index)
-                    result = result.substr(1, end_index - 1);
-            }
+            if (item.back() == q)
+                result = item.substr(1, item.length() - 2);
         }
     }
     return result;
@@ -306,6 +311,12 @@ add_quotes (const std::string & item)
 
 bool
 strcompare (const std::string & a, const std::string & b)
+{
+    return strcompare(strview(a), strview(b));
+}
+
+bool
+strcompare (strview a, strview b)
 {
     bool result = ! a.empty() && ! b.empty();
     if (result)
@@ -346,6 +357,12 @@ strcompare (const std::string & a, const std::string & b)
 
 bool
 strncompare (const std::string & a, const std::string & b, size_t n)
+{
+    return strncompare(strview(a), strview(b), n);
+}
+
+bool
+strncompare (strview a, strview b, size_t n)
 {
     bool result = ! a.empty() && ! b.empty();
     if (result)
@@ -401,6 +418,12 @@ casecompare (char a, char b)
 
 bool
 strcasecompare (const std::string & a, const std::string & b)
+{
+    return strcasecompare(strview(a), strview(b));
+}
+
+bool
+strcasecompare (strview a, strview b)
 {
     return
     (
@@ -479,9 +502,31 @@ rtrim (std::string & str, const std::string & chars)
 std::string
 trim (const std::string & str, const std::string & chars)
 {
-    std::string result = str;
-    (void) ltrim(rtrim(result, chars), chars);
-    return result;
+    return trim(strview(str), strview(chars)).to_string();
+}
+
+/**
+ *  Left-trims a view. The view is simply moved past the characters.
+ */
+
+strview
+ltrim (strview str, strview chars)
+{
+    auto pos = str.find_first_not_of(chars);
+    return pos == strview::npos ? str.substr(str.size()) : str.substr(pos) ;
+}
+
+strview
+rtrim (strview str, strview chars)
+{
+    auto pos = str.find_last_not_of(chars);
+    return pos == strview::npos ? str.substr(0, 0) : str.substr(0, pos + 1) ;
+}
+
+strview
+trim (strview str, strview chars)
+{
+    return ltrim(rtrim(str, chars), chars);
 }
 
 /**
@@ -718,6 +763,12 @@ midi_bytes_to_string (const std::string & s)
 
 bool
 string_to_bool (const std::string & s, bool defalt)
+{
+    return string_to_bool(strview(s), defalt);
+}
+
+bool
+string_to_bool (strview s, bool defalt)
 {
     return s.empty() ? defalt :
     (
@@ -751,6 +802,90 @@ string_to_int_pair
     return result;
 }
 
+/**
+ *  Gets the next token from a view, as tokenize() does: skips delimiters,
+ *  takes the characters up to the next delimiter, and trims white space
+ *  from them.
+ *
+ * \param [inout] pos
+ *      The position at which to start. On return, the position just past
+ *      the token, or npos.
+ *
+ * \param [out] token
+ *      The token, a view of the source.
+ *
+ * \return
+ *      Returns false if there are no more tokens.
+ */
+
+static bool
+next_token
+(
+    strview source,
+    const charset & delimiters,
+    strview::size_type & pos,
+    strview & token
+)
+{
+    pos = source.find_first_not_of(delimiters, pos);
+    bool result = pos != strview::npos;
+    if (result)
+    {
+        auto current = source.find_first_of(delimiters, pos);
+        if (current == strview::npos)
+            token = trim(source.substr(pos));
+        else
+            token = trim(source.substr(pos, current - pos));
+
+        pos = current;
+    }
+    return result;
+}
+
+/**
+ *  The strview version of string_to_int_pair(). It finds the tokens in
+ *  place, stopping if there are more than two.
+ */
+
+bool
+string_to_int_pair
+(
+    strview s,
+    int & v1, int & v2,
+    strview delimiter
+)
+{
+    bool result = s.find_first_of(delimiter) != strview::npos;
+    if (result)
+    {
+        charset delims{delimiter.data(), delimiter.size()};
+        strview numbers[2];
+        strview token;
+        strview::size_type pos = 0;
+        int count = 0;
+        while (count <= 2 && next_token(s, delims, pos, token))
+        {
+            if (count < 2)
+                numbers[count] = token;
+
+            ++count;
+        }
+        result = count == 2;
+        if (result)
+        {
+            result = ! numbers[0].empty() && ! numbers[1].empty() &&
+                std::isdigit(numbers[0][0]) && std::isdigit(numbers[1][0]);
+
+            if (result)
+            {
+                v1 = string_to_int(numbers[0]);
+                v2 = string_to_int(numbers[1]);
+            }
+        }
+    }
+    return result;
+}
+
 bool
 string_to_time_signature (const std::string & s, int & beats, int & width)
 {
@@ -771,17 +906,15 @@ time_signature_string (int beats, int width)
 }
 
 /**
- *  Converts a string to a double value.  This function bypasses characters
- *  until it finds a digit (whether part of the number or a "0x" construct),
- *  and then converts it.  The strtol() function is used with a base of 0 so
- *  that decimal, hexadecimal, and octal values can all be parsed.
- *
- *  This function is the base implementation for string_to_int() as well.
+ *  Converts a string to a double value. Leading white space is skipped,
+ *  and the number ends at the first character that cannot be part of it.
+ *  The conversion is done by util::from_chars(), so that the decimal point
+ *  is always '.', whatever the locale.
  *
  * \param s
  *      Provides the string to convert to a double value. Integers, numbers
- *      with a decimal point, and simple, but strictly formatted, fractions
- *      (e.g. "1/4") are supported.
+ *      with a decimal point or exponent, hexadecimal integers, and simple,
+ *      but strictly formatted, fractions (e.g. "1/4") are supported.
  *
  * \param defalt
  *      The desired default for an empty string.  The default \a defalt value
@@ -793,41 +926,15 @@ time_signature_string (int beats, int width)
  *      decimal.
  *
  * \return
- *      Returns the signed long integer value represented by the string.
- *      If the string is empty or has no digits, then 0.0 is returned.
+ *      Returns the double value represented by the string. If the string
+ *      is empty or has no digits, then the default is returned. A value
+ *      too large for a double is returned as infinity.
  */
 
 double
 string_to_double (const std::string & s, double defalt, int rounding)
 {
-    double result = defalt;
-    if (! s.empty())
-    {
-        try
-        {
-            int beats, width;
-            bool is_time_sig = string_to_time_signature(s, beats, width);
-            if (is_time_sig)
-            {
-                double numerator = double(beats);
-                double denominator = double(width);
-                result = numerator / denominator;
-            }
-            else
-                result = std::stod(s, nullptr);
-
-            if (rounding > 0)
-            {
-                double power = std::pow(10.0, rounding);
-                result = std::floor(result * power) / power;
-            }
-        }
-        catch (std::invalid_argument const &)
-        {
-            // no code
-        }
-    }
-    return result;
+    return string_to_double(strview(s), defalt, rounding);
 }
 
 /**
@@ -866,15 +973,18 @@ is_floating_string (const std::string & value)
 
 /**
  *  Converts a floating point value to a string. The function std::to_string()
- *  always puts six digits after the decimal point, which is not neat.
+ *  always puts six digits after the decimal point, which is not neat, and
+ *  "%g" keeps only six significant digits, and uses the decimal point of
+ *  the locale.
  *
  * \param value
  *      The floating point value to convert to a string
  *
  * \param precision
- *      If not zero, then the number of digits emitted is given by this
- *      number. If 0 (or less than 0), then the "%g" format specifier is
- *      used.
+ *      If not zero, then the number of significant digits emitted is given
+ *      by this number. If 0 (or less than 0), then the fewest digits that
+ *      convert back to the same value are used, so that writing a value to
+ *      a configuration file and reading it back does not change it.
  *
  * \return
  *      Returns the value as a string.
@@ -883,27 +993,94 @@ is_floating_string (const std::string & value)
 std::string
 double_to_string (double value, int precision)
 {
-    char temp[32];
-    if (precision == 0)
-        (void) snprintf(temp, sizeof temp, "%g", value);
-    else
-        (void) snprintf(temp, sizeof temp, "%*g", precision, value);
+    char temp[64];
+    convert_result cr = to_chars(temp, sizeof temp, value, precision);
+    return std::string(temp, cr.position);
+}
 
-    return std::string(temp);
+/**
+ *  As double_to_string(), but the fewest digits are those that convert
+ *  back to the same float. A float passed to double_to_string() would
+ *  come out with the digits of the double it widens to, such as
+ *  "0.100000001490116" for 0.1f.
+ */
+
+std::string
+float_to_string (float value, int precision)
+{
+    char temp[64];
+    convert_result cr = to_chars(temp, sizeof temp, value, precision);
+    return std::string(temp, cr.position);
 }
 
 float
 string_to_float (const std::string & s, float defalt, int rounding)
 {
-    return float(string_to_double(s, double(defalt), rounding));
+    return string_to_float(strview(s), defalt, rounding);
 }
 
 /**
- *  Converts a string to a signed long value.  This function bypasses
- *  characters until it finds a digit (whether part of the number or a "0x"
- *  construct), and then converts it.  The strtol() function is used with a
- *  base of 0 so that decimal, hexadecimal, and octal values can all be
- *  parsed.
+ *  The strview version of string_to_double().
+ */
+
+double
+string_to_double (strview s, double defalt, int rounding)
+{
+    double result = defalt;
+    if (! s.empty())
+    {
+        int beats, width;
+        bool converted = string_to_int_pair(s, beats, width, "/");
+        if (converted)
+        {
+            result = double(beats) / double(width);
+        }
+        else
+        {
+            double value;
+            convert_result cr = from_chars(ltrim(s), value);
+            converted = cr.error != convert_error::invalid;
+            if (converted)
+                result = value;
+        }
+        if (converted && rounding > 0)
+        {
+            double power = std::pow(10.0, rounding);
+            result = std::floor(result * power) / power;
+        }
+    }
+    return result;
+}
+
+/**
+ *  The strview version of string_to_float(). Unless it is a fraction or is
+ *  to be rounded, the value is converted straight to a float, which can
+ *  differ in the last bit from converting it to a double and then to a
+ *  float.
+ */
+
+float
+string_to_float (strview s, float defalt, int rounding)
+{
+    float result = defalt;
+    if (rounding > 0 || s.find('/') != strview::npos)
+    {
+        result = float(string_to_double(s, double(defalt), rounding));
+    }
+    else
+    {
+        float value;
+        convert_result cr = from_chars(ltrim(s), value);
+        if (cr.error != convert_error::invalid)
+            result = value;
+    }
+    return result;
+}
+
+/**
+ *  Converts a string to a signed long value. Leading white space is
+ *  skipped, and decimal, hexadecimal ("0x" prefix), and octal ("0" prefix)
+ *  values can all be parsed, as by std::strtol() with a base of 0.
  *
  *  This function is the base implementation for string_to_int() as well.
  *
@@ -917,33 +1094,22 @@ string_to_float (const std::string & s, float defalt, int rounding)
  * \return
  *      Returns the signed long integer value represented by the string.
  *      If the string is empty or has no digits, then the default value is
- *      returned.
+ *      returned. A value that is too large is clamped to LONG_MAX or
+ *      LONG_MIN.
  */
 
 long
 string_to_long (const std::string & s, long defalt)
 {
-    long result = defalt;
-    if (! s.empty())
-    {
-        try
-        {
-            result = std::stol(s, nullptr, 0);
-        }
-        catch (std::invalid_argument const &)
-        {
-            // no code
-        }
-    }
-    return result;
+    return string_to_long(strview(s), defalt);
 }
 
 std::string
 long_to_string (long value)
 {
-    char temp[32];
-    (void) snprintf(temp, sizeof temp, "%ld", value);
-    return std::string(temp);
+    char temp[number_chars_max];
+    convert_result cr = to_chars(temp, sizeof temp, value);
+    return std::string(temp, cr.position);
 }
 
 /**
@@ -953,16 +1119,7 @@ long_to_string (long value)
 unsigned long
 string_to_unsigned_long (const std::string & s, unsigned long defalt)
 {
-    double result = defalt;
-    try
-    {
-        result = std::stoul(s, nullptr, 0);
-    }
-    catch (std::invalid_argument const &)
-    {
-        // no code
-    }
-    return result;
+    return string_to_unsigned_long(strview(s), defalt);
 }
 
 /**
@@ -976,27 +1133,94 @@ string_to_unsigned (const std::string & s, unsigned defalt)
 }
 
 /**
- *  Converts a string to an integer.  Simply calls string_to_long().
+ *  The strview version of string_to_long().
+ */
+
+long
+string_to_long (strview s, long defalt)
+{
+    long result = defalt;
+    long value;
+    convert_result cr = from_chars(ltrim(s), value, 0);
+    if (cr.error != convert_error::invalid)
+        result = value;
+
+    return result;
+}
+
+/**
+ *  The strview version of string_to_unsigned_long(). As with std::stoul(),
+ *  a minus sign negates the value as an unsigned long.
+ */
+
+unsigned long
+string_to_unsigned_long (strview s, unsigned long defalt)
+{
+    unsigned long result = defalt;
+    strview v = ltrim(s);
+    bool negative = ! v.empty() && v.front() == '-';
+    if (negative)
+        v.remove_prefix(1);
+
+    bool signed_twice = negative && ! v.empty() &&
+        (v.front() == '-' || v.front() == '+');
+
+    if (! signed_twice)
+    {
+        unsigned long value;
+        convert_result cr = from_chars(v, value, 0);
+        if (cr.error != convert_error::invalid)
+            result = negative ? 0UL - value : value ;
+    }
+    return result;
+}
+
+unsigned
+string_to_unsigned (strview s, unsigned defalt)
+{
+    return unsigned(string_to_unsigned_long(s, (unsigned long)(defalt)));
+}
+
+/**
+ *  The strview version of string_to_int(). A value that is too large is
+ *  clamped to INT_MAX or INT_MIN.
+ */
+
+int
+string_to_int (strview s, int defalt)
+{
+    int result = defalt;
+    int value;
+    convert_result cr = from_chars(ltrim(s), value, 0);
+    if (cr.error != convert_error::invalid)
+        result = value;
+
+    return result;
+}
+
+/**
+ *  Converts a string to an integer, as string_to_long() does.
  *
  * \param s
  *      Provides the string to convert to an integer.
  *
  * \return
- *      Returns the integer value represented by the string.
+ *      Returns the integer value represented by the string, clamped to
+ *      INT_MAX or INT_MIN if it is too large.
  */
 
 int
 string_to_int (const std::string & s, int defalt)
 {
-    return int(string_to_long(s, long(defalt)));
+    return string_to_int(strview(s), defalt);
 }
 
 std::string
 int_to_string (int value)
 {
-    char temp[32];
-    (void) snprintf(temp, sizeof temp, "%d", value);
-    return std::string(temp);
+    char temp[number_chars_max];
+    convert_result cr = to_chars(temp, sizeof temp, value);
+    return std::string(temp, cr.position);
 }
 
 /**
@@ -1015,6 +1239,12 @@ int_to_string (int value)
 
 bool
 string_not_void (const std::string & s)
+{
+    return string_not_void(strview(s));
+}
+
+bool
+string_not_void (strview s)
 {
    bool result = false;
    if (! s.empty())
@@ -1050,6 +1280,12 @@ string_not_void (const std::string & s)
 
 bool
 string_is_void (const std::string & s)
+{
+    return string_is_void(strview(s));
+}
+
+bool
+string_is_void (strview s)
 {
    bool result = s.empty();
    if (! result)
@@ -1083,6 +1319,12 @@ string_is_void (const std::string & s)
 
 bool
 strings_match (const std::string & target, const std::string & x)
+{
+    return strings_match(strview(target), strview(x));
+}
+
+bool
+strings_match (strview target, strview x)
 {
     bool result = ! target.empty();
     if (result)
@@ -1236,55 +1478,16 @@ tokenize_stanzas
     const std::string & brackets
 )
 {
-    static std::string s_delims = CFG66_TRIM_CHARS;
-    std::string BL = "[";
-    std::string BR = "]";
-    char CBR = ']';
-    if (brackets.size() >= 2)
-    {
-        BL = brackets[0];
-        BR = brackets[1];
-        CBR = brackets[1];
-    }
+    strviews views;
+    int result = tokenize_stanzas
+    (
+        views, strview(source), bleft, strview(brackets)
+    );
     tokens.clear();
-    bleft = source.find_first_of(BL, bleft);
-    if (bleft != std::string::npos)
-    {
-        auto bright = source.find_first_of(BR, bleft + 1);
-        if (bright != std::string::npos && bright > bleft)
-        {
-            tokens.push_back(BL);
-            ++bleft;
-            if (std::isspace(source[bleft]))
-                bleft = source.find_first_not_of(s_delims, bleft);
+    for (const auto & v : views)
+        tokens.push_back(v.to_string());
 
-            if (source[bleft] != CBR)
-            {
-                for (;;)
-                {
-                    auto last = source.find_first_of(s_delims, bleft);
-                    if (last == std::string::npos)
-                    {
-                        if (bright > bleft)
-                        {
-                            tokens.push_back
-                            (
-                                source.substr(bleft, bright - bleft)
-                            );
-                        }
-                        break;
-                    }
-                    else
-                    {
-                        tokens.push_back(source.substr(bleft, last - bleft));
-                        bleft = source.find_first_not_of(s_delims, last);
-                    }
-                }
-            }
-            tokens.push_back(BR);
-        }
-    }
-    return int(tokens.size());
+    return result;
 }
 
 /**
@@ -1318,23 +1521,12 @@ tokenize
 )
 {
     lib66::tokenization result;
-    std::size_t previous = source.find_first_not_of(delimiters);
-    while (previous != std::string::npos)
-    {
-        std::size_t current = source.find_first_of(delimiters, previous);
-        if (current == std::string::npos)
-        {
-            std::string temp = trim(source.substr(previous));
-            result.push_back(temp);
-            break;
-        }
-        else
-        {
-            std::string temp = trim(source.substr(previous, current-previous));
-            result.push_back(temp);
-            previous = source.find_first_not_of(delimiters, current);
-        }
-    }
+    charset delims{delimiters.data(), delimiters.size()};
+    strview token;
+    strview::size_type pos = 0;
+    while (next_token(strview(source), delims, pos, token))
+        result.push_back(token.to_string());
+
     return result;
 }
 
@@ -1408,6 +1600,150 @@ tokenize_quoted (const std::string & source)
     return result;
 }
 
+/**
+ *  The strview version of tokenize_stanzas(). The tokens, including the
+ *  brackets, are views of \a source and \a brackets.
+ */
+
+int
+tokenize_stanzas
+(
+    strviews & tokens,
+    strview source,
+    strview::size_type bleft,
+    strview brackets
+)
+{
+    static const charset s_delims
+    {
+        CFG66_TRIM_CHARS.data(), CFG66_TRIM_CHARS.size()
+    };
+    const charset & delims = s_delims;
+    strview BL{"[", 1};
+    strview BR{"]", 1};
+    char CBR = ']';
+    if (brackets.size() >= 2)
+    {
+        BL = brackets.substr(0, 1);
+        BR = brackets.substr(1, 1);
+        CBR = brackets[1];
+    }
+    tokens.clear();
+    bleft = source.find_first_of(BL, bleft);
+    if (bleft != strview::npos)
+    {
+        auto bright = source.find_first_of(BR, bleft + 1);
+        if (bright != strview::npos && bright > bleft)
+        {
+            tokens.push_back(BL);
+            ++bleft;
+            if (std::isspace(static_cast<unsigned char>(source[bleft])))
+                bleft = source.find_first_not_of(delims, bleft);
+
+            if (source[bleft] != CBR)
+            {
+                for (;;)
+                {
+                    auto last = source.find_first_of(delims, bleft);
+                    if (last == strview::npos)
+                    {
+                        if (bright > bleft && bleft != strview::npos)
+                        {
+                            tokens.push_back
+                            (
+                                source.substr(bleft, bright - bleft)
+                            );
+                        }
+                        break;
+                    }
+                    else
+                    {
+                        tokens.push_back(source.substr(bleft, last - bleft));
+                        bleft = source.find_first_not_of(delims, last);
+                    }
+                }
+            }
+            tokens.push_back(BR);
+        }
+    }
+    return int(tokens.size());
+}
+
+/**
+ *  The strview version of tokenize(). The tokens are views of \a source,
+ *  and replace the contents of \a tokens, so a list reused from line to
+ *  line stops allocating once it is long enough.
+ *
+ * \return
+ *      Returns the number of tokens.
+ */
+
+size_t
+tokenize (strviews & tokens, strview source, strview delimiters)
+{
+    charset delims{delimiters.data(), delimiters.size()};
+    strview token;
+    strview::size_type pos = 0;
+    tokens.clear();
+    while (next_token(source, delims, pos, token))
+        tokens.push_back(token);
+
+    return tokens.size();
+}
+
+/**
+ *  The strview version of tokenize_quoted(). Text in double quotes is one
+ *  token, without the quotes. Unlike the std::string version, which splits
+ *  the text first and then joins the quoted words with single spaces, the
+ *  token is the text between the quotes exactly as it is in \a source.
+ *  A quote with no closing quote runs to the end. Empty quotes are
+ *  dropped.
+ */
+
+size_t
+tokenize_quoted (strviews & tokens, strview source)
+{
+    static const charset s_spaces{" \t", 2};
+    const charset & spaces = s_spaces;
+    strview::size_type pos = 0;
+    tokens.clear();
+    for (;;)
+    {
+        pos = source.find_first_not_of(spaces, pos);
+        if (pos == strview::npos)
+            break;
+
+        strview token;
+        if (source[pos] == '"')
+        {
+            auto qpos = source.find('"', pos + 1);
+            if (qpos == strview::npos)
+            {
+                token = source.substr(pos + 1);
+                pos = qpos;
+            }
+            else
+            {
+                token = source.substr(pos + 1, qpos - pos - 1);
+                pos = qpos + 1;
+            }
+        }
+        else
+        {
+            auto current = source.find_first_of(spaces, pos);
+            if (current == strview::npos)
+                token = trim(source.substr(pos));
+            else
+                token = trim(source.substr(pos, current - pos));
+
+            pos = current;
+        }
+        if (! token.empty())
+            tokens.push_back(token);
+    }
+    return tokens.size();
+}
+
 /**
  *  Simplifies a string by tokenizing it based on spaces, and dropping tokens
  *  that have some special characters and don't start with a letter, then
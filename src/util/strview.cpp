@@ -0,0 +1,221 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          strview.cpp
+ *
+ *  This module declares/defines a read-only view of characters owned by a
+ *  string or a buffer.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  The string functions in the strfunctions module take and return
+ *  std::string, so trimming a line, stripping its comment, and splitting
+ *  it into tokens makes a string for each step. A strview is just a
+ *  pointer and a length, so a part of a line is a view of the same
+ *  characters:
+ *
+\verbatim
+        util::strviews tokens;                  // reused for each line
+        while (std::getline(file, line))
+        {
+            util::strview v = util::strip_comments(util::strview(line));
+            (void) util::tokenize(tokens, v);
+            int n = util::string_to_int(tokens[1]);
+        }
+\endverbatim
+ *
+ *  Once the token list has grown to the longest line, nothing above
+ *  allocates.
+ *
+ *  A view can be made from a std::string, a C string, or a pointer and a
+ *  length. The strfunctions that take a strview are overloads of the ones
+ *  that take a std::string; passing a std::string still picks the old one.
+ *  The view is not null-terminated, so it cannot be handed to C functions
+ *  that expect a C string.
+ */
+
+#include "util/strview.hpp"             /* util::strview class              */
+
+namespace util
+{
+
+/**
+ *  Gets part of the view. Unlike std::string::substr(), a \a pos past the
+ *  end yields an empty view rather than an exception.
+ */
+
+strview
+strview::substr (size_type pos, size_type n) const
+{
+    strview result;
+    if (pos <= m_size)
+    {
+        size_type avail = m_size - pos;
+        result = strview(m_data + pos, n < avail ? n : avail);
+    }
+    return result;
+}
+
+int
+strview::compare (strview s) const
+{
+    size_type n = m_size < s.m_size ? m_size : s.m_size ;
+    int result = n > 0 ? std::memcmp(m_data, s.m_data, n) : 0 ;
+    if (result == 0 && m_size != s.m_size)
+        result = m_size < s.m_size ? -1 : 1 ;
+
+    return result;
+}
+
+strview::size_type
+strview::find (char c, size_type pos) const
+{
+    size_type result = npos;
+    if (pos < m_size)
+    {
+        const void * p = std::memchr(m_data + pos, c, m_size - pos);
+        if (not_nullptr(p))
+            result = size_type(static_cast<const char *>(p) - m_data);
+    }
+    return result;
+}
+
+strview::size_type
+strview::find (strview s, size_type pos) const
+{
+    size_type result = npos;
+    if (s.m_size == 0)
+    {
+        if (pos <= m_size)
+            result = pos;
+    }
+    else
+    {
+        while (pos < m_size && m_size - pos >= s.m_size)
+        {
+            pos = find(s.m_data[0], pos);
+            if (pos == npos || m_size - pos < s.m_size)
+                break;
+
+            if (std::memcmp(m_data + pos, s.m_data, s.m_size) == 0)
+            {
+                result = pos;
+                break;
+            }
+            ++pos;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Finds the first of a set of characters. The search is done by the
+ *  charset, which looks at 16 or 32 bytes at a time if it can. A caller
+ *  that searches for the same set many times, such as a tokenizer, can
+ *  make the charset once and use the overload that takes it.
+ */
+
+strview::size_type
+strview::find_first_of (strview chars, size_type pos) const
+{
+    return find_first_of(charset(chars.m_data, chars.m_size), pos);
+}
+
+strview::size_type
+strview::find_first_not_of (strview chars, size_type pos) const
+{
+    return find_first_not_of(charset(chars.m_data, chars.m_size), pos);
+}
+
+strview::size_type
+strview::find_first_of (const charset & cs, size_type pos) const
+{
+    size_type result = npos;
+    if (pos < m_size)
+    {
+        size_type offset = cs.find_first_of(m_data + pos, m_size - pos);
+        if (offset < m_size - pos)
+            result = pos + offset;
+    }
+    return result;
+}
+
+strview::size_type
+strview::find_first_not_of (const charset & cs, size_type pos) const
+{
+    size_type result = npos;
+    if (pos < m_size)
+    {
+        size_type offset = cs.find_first_not_of(m_data + pos, m_size - pos);
+        if (offset < m_size - pos)
+            result = pos + offset;
+    }
+    return result;
+}
+
+strview::size_type
+strview::find_last_of (strview chars, size_type pos) const
+{
+    size_type result = npos;
+    if (m_size > 0)
+    {
+        size_type i = pos < m_size ? pos + 1 : m_size ;
+        while (i-- > 0)
+        {
+            if (not_nullptr(std::memchr(chars.m_data, m_data[i], chars.m_size)))
+            {
+                result = i;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+strview::size_type
+strview::find_last_not_of (strview chars, size_type pos) const
+{
+    size_type result = npos;
+    if (m_size > 0)
+    {
+        size_type i = pos < m_size ? pos + 1 : m_size ;
+        while (i-- > 0)
+        {
+            if (is_nullptr(std::memchr(chars.m_data, m_data[i], chars.m_size)))
+            {
+                result = i;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+}           // namespace util
+
+/*
+ * strview.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
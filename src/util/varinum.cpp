@@ -0,0 +1,298 @@
+/*
+ *  This file is part of cfg66.
+ *
+ *  cfg66 is free software; you can redistribute it and/or modify it under the
+ *  terms of the GNU General Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or (at your option) any later
+ *  version.
+ *
+ *  cfg66 is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with cfg66; if not, write to the Free Software Foundation, Inc., 59 Temple
+ *  Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          varinum.cpp
+ *
+ *  This module declares functions to decode and encode runs of MIDI
+ *  variable-length quantities.
+ *
+ * \library       cfg66
+ * \author        Chris Ahlstrom
+ * \date          2026-10-18
+ * \updates       2026-10-18
+ * \license       GNU GPLv2 or above
+ *
+ *  A MIDI variable-length quantity (VLQ, or "varinum") holds 7 bits per
+ *  byte, most-significant group first. Bit 7 is set in every byte but the
+ *  last. bytevector::get_varinum() reads one byte at a time; the functions
+ *  here work on a whole run of varinums.
+ *
+ *  The decoder looks at 8 bytes at a time. Loading them as a little-endian
+ *  word, the bytes that end a varinum are the ones whose bit 7 is clear:
+ *
+\verbatim
+        ends = ~word & 0x8080808080808080
+\endverbatim
+ *
+ *  The number of trailing zero bits of "ends", divided by 8, is the number
+ *  of continuation bytes before the first end byte, so the length of a
+ *  varinum is found without testing each byte. If all 8 bytes are end
+ *  bytes, which is common for the small delta-times in a busy track, they
+ *  are 8 one-byte values and are stored directly.
+ *
+ *  With SSE2 (always present on x86-64), the same test is done on 16
+ *  bytes at once with _mm_movemask_epi8(), which gathers the 16 bit-7 flags
+ *  into one integer. Other processors, including ARM, use the 8-byte word
+ *  code, which the compiler handles well without NEON.
+ *
+ *  Malformed input is a varinum longer than c_varinum_max_bytes, or one
+ *  cut off by the end of the data. The decoder stops there and reports the
+ *  offset of its first byte.
+ */
+
+#include "util/varinum.hpp"             /* util::decode_varinums(), etc.    */
+
+#if defined __SSE2__ || defined _M_X64
+#define CFG66_VARINUM_SSE2
+#include <emmintrin.h>                  /* _mm_loadu_si128(), etc.          */
+#endif
+
+namespace util
+{
+
+/**
+ *  Loads 8 bytes as a little-endian word, whatever the host.
+ */
+
+static inline ulonglong
+load_little_word (const byte * p)
+{
+    ulonglong result;
+    std::memcpy(&result, p, sizeof result);
+#if defined CFG66_BIG_ENDIAN_HOST
+    result = byte_swap(result);
+#endif
+    return result;
+}
+
+/**
+ *  Counts the trailing zero bits of a non-zero word.
+ */
+
+static inline int
+trailing_zeros (ulonglong x)
+{
+#if defined PLATFORM_GNU || defined PLATFORM_CLANG
+    return __builtin_ctzll(x);
+#else
+    int result = 0;
+    while ((x & 1) == 0)
+    {
+        x >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+/**
+ *  Decodes a run of varinums.
+ *
+ * \param data
+ *      The bytes to decode.
+ *
+ * \param sz
+ *      The number of bytes.
+ *
+ * \param destination
+ *      Receives the values. It must hold \a count values.
+ *
+ * \param [inout] count
+ *      On input, the most values to decode. On output, the number decoded.
+ *
+ * \param [out] consumed
+ *      The number of bytes decoded. If false is returned, this is also the
+ *      offset of the first byte of the malformed varinum.
+ *
+ * \return
+ *      Returns false if a malformed varinum was found. Running out of data
+ *      between varinums is not an error; running out in the middle of one
+ *      is.
+ */
+
+bool
+decode_varinums
+(
+    const byte * data,
+    size_t sz,
+    ulong * destination,
+    size_t & count,
+    size_t & consumed
+)
+{
+    bool result = true;
+    size_t limit = count;
+    size_t n = 0;
+    size_t pos = 0;
+    if (is_nullptr(data) || is_nullptr(destination))
+        limit = 0;
+
+    while (n < limit && pos < sz)
+    {
+#if defined CFG66_VARINUM_SSE2
+        if (sz - pos >= 16 && limit - n >= 16)
+        {
+            __m128i v = _mm_loadu_si128
+            (
+                reinterpret_cast<const __m128i *>(data + pos)
+            );
+            if (_mm_movemask_epi8(v) == 0)      /* 16 one-byte varinums     */
+            {
+                for (int i = 0; i < 16; ++i)
+                    destination[n + i] = data[pos + i];
+
+                n += 16;
+                pos += 16;
+                continue;
+            }
+        }
+#endif
+        if (sz - pos >= 8)
+        {
+            ulonglong word = load_little_word(data + pos);
+            ulonglong ends = ~word & 0x8080808080808080ULL;
+            if (ends == 0x8080808080808080ULL && limit - n >= 8)
+            {
+                for (int i = 0; i < 8; ++i)     /* 8 one-byte varinums      */
+                    destination[n + i] = data[pos + i];
+
+                n += 8;
+                pos += 8;
+            }
+            else if (ends != 0)
+            {
+                size_t len = size_t(trailing_zeros(ends) / 8) + 1;
+                if (len > c_varinum_max_bytes)
+                {
+                    result = false;
+                    break;
+                }
+                ulong value = 0;
+                for (size_t i = 0; i < len; ++i)
+                    value = (value << 7) | (data[pos + i] & 0x7F);
+
+                destination[n++] = value;
+                pos += len;
+            }
+            else                                /* 8 continuation bytes     */
+            {
+                result = false;
+                break;
+            }
+        }
+        else
+        {
+            ulong value = 0;                    /* the last few bytes       */
+            size_t len = 0;
+            bool ended = false;
+            while (pos + len < sz && len < c_varinum_max_bytes)
+            {
+                byte c = data[pos + len++];
+                value = (value << 7) | (c & 0x7F);
+                if ((c & 0x80) == 0)
+                {
+                    ended = true;
+                    break;
+                }
+            }
+            if (ended)
+            {
+                destination[n++] = value;
+                pos += len;
+            }
+            else
+            {
+                result = false;
+                break;
+            }
+        }
+    }
+    count = n;
+    consumed = pos;
+    return result;
+}
+
+/**
+ *  The number of bytes needed to encode a value as a varinum.
+ */
+
+size_t
+varinum_size (ulong value)
+{
+    size_t result = 1;
+    while ((value >>= 7) != 0)
+        ++result;
+
+    return result;
+}
+
+/**
+ *  Encodes a run of values as varinums, in the same way as
+ *  bytevector::put_varinum().
+ *
+ * \param values
+ *      The values to encode.
+ *
+ * \param count
+ *      The number of values.
+ *
+ * \param destination
+ *      Receives the bytes. It must hold c_varinum_encode_max * count bytes,
+ *      or the sum of varinum_size() of each value.
+ *
+ * \return
+ *      Returns the number of bytes stored.
+ */
+
+size_t
+encode_varinums (const ulong * values, size_t count, byte * destination)
+{
+    size_t result = 0;
+    if (not_nullptr(values) && not_nullptr(destination))
+    {
+        byte * p = destination;
+        for (size_t i = 0; i < count; ++i)
+        {
+            ulong v = values[i];
+            if (v < 0x80)
+            {
+                *p++ = byte(v);                 /* the usual case           */
+            }
+            else
+            {
+                size_t len = varinum_size(v);
+                for (size_t k = len - 1; k > 0; --k)
+                    *p++ = byte(((v >> (7 * k)) & 0x7F) | 0x80);
+
+                *p++ = byte(v & 0x7F);
+            }
+        }
+        result = size_t(p - destination);
+    }
+    return result;
+}
+
+}           // namespace util
+
+/*
+ * varinum.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
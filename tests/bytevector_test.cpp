@@ -24,17 +24,22 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2024-05-17
- * \updates       2024-08-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
 
+#include <cstdio>                       /* std::remove()                    */
 #include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
 #include <iostream>                     /* std::cout, set::cerr             */
 
 #include "cfg/appinfo.hpp"              /* cfg::appinfo functions           */
 #include "cli/parser.hpp"               /* cli::parser, etc.                */
 #include "util/bytevector.hpp"          /* util::bytevector big-endian code */
+#include "util/bytestream.hpp"          /* util::bytestream class           */
+#include "util/byteview.hpp"            /* util::byteview zero-copy reader  */
+#include "util/chunkindex.hpp"          /* util::chunkindex for MIDI files  */
+#include "util/varinum.hpp"             /* util::decode_varinums(), etc.    */
 #include "util/msgfunctions.hpp"        /* util::file_message(), etc.       */
 
 /*
@@ -181,6 +186,376 @@ big_endian_file_io ()
     return result;
 }
 
+/*
+ *  Tests the word-wide readers against values written by the put
+ *  functions, including a run read by get_array() and a read that runs
+ *  off the end.
+ */
+
+static bool
+word_access_io ()
+{
+    util::bytevector bv;
+    bv.put_byte(0x7F);                                  /* misalign it      */
+    for (util::ulong v = 0; v < 16; ++v)
+        bv.put_long(0x01020304 * v);
+
+    bv.put_short(0xBEEF);
+    bv.put_longlong(0x0102030405060708);
+    bv.reset();
+
+    util::ulong values[16];
+    bool result = bv.get_byte() == 0x7F && bv.peek_long() == 0;
+    if (result)
+        result = bv.get_array(values, 16) == 16;
+
+    for (util::ulong v = 0; result && v < 16; ++v)
+        result = values[v] == 0x01020304 * v;
+
+    if (result)
+    {
+        result = bv.peek_short() == 0xBEEF && bv.get_short() == 0xBEEF &&
+            bv.get_longlong() == 0x0102030405060708 && bv.remainder() == 0;
+    }
+    if (result)
+    {
+        result = bv.get_array(values, 1) == 0 && bv.fatal_error();
+        bv.clear_errors();
+    }
+    return result;
+}
+
+/*
+ *  Reads the MIDI file both ways, and checks that a mapped bytevector
+ *  reads the same, and becomes an ordinary one on the first change.
+ */
+
+static bool
+mapped_file_io ()
+{
+    std::string fname{"tests/data/1Bar.midi"};
+    util::bytevector bvread;
+    util::bytevector bvmap;
+    bool result = bvread.read(fname) && bvmap.read_mapped(fname);
+    if (result)
+    {
+        result = bvmap.size() == bvread.size() &&
+            bvmap.peek_string() == bvread.peek_string();
+    }
+    if (result)
+    {
+        util::bytevector copy{bvmap};
+        result = bvmap.get_long() == bvread.get_long() &&
+            bvmap.get_long() == bvread.get_long() &&
+            bvmap.get_short() == bvread.get_short() &&
+            copy.get_long() == 0x4D546864;
+    }
+    if (result)
+    {
+        size_t sz = bvmap.size();
+        util::ulong id = bvmap.peek_long();
+        bvmap.poke_long(0x12345678, 0);         /* copy-on-write happens    */
+        result = ! bvmap.mapped() && bvmap.size() == sz &&
+            bvmap.peek_long() == id && bvmap.peek_byte_at(0) == 0x12;
+    }
+    return result;
+}
+
+/*
+ *  Splits the MIDI file into views of the header and track chunks, and
+ *  reads them without copying.
+ */
+
+static bool
+byteview_io ()
+{
+    std::string fname{"tests/data/1Bar.midi"};
+    util::bytevector bv;
+    bool result = bv.read_mapped(fname);
+    if (result)
+    {
+        util::byteview all{bv};
+        util::byteview header = all.get_view(14);
+        util::byteview track = all.slice(22, 309);
+        result = header.get_long() == 0x4D546864 && header.get_long() == 6 &&
+            header.slice(8, 2).get_short() == 1 && header.position() == 8;
+
+        if (result)
+        {
+            result = all.get_string(4) == "MTrk" && all.get_long() == 309 &&
+                track.size() == 309 && track.data() == bv.data() + 22 &&
+                track.real_position() == 22;
+        }
+        if (result)
+        {
+            util::byteview meta = track.slice(0, 4);
+            result = track.get_varinum() == 0 && track.peek_byte() == 0xFF &&
+                meta.get_longlong() == 0 && meta.overrun();
+        }
+    }
+    return result;
+}
+
+/*
+ *  Writes a file in segments with a small segment size, so that several
+ *  writev() calls are made, then reads it back and checks it.
+ */
+
+static bool
+streaming_write_io ()
+{
+    std::string fname{"tests/data/stream-out.bin"};
+    util::bytewriter writer{1000};
+    util::bytevector bv;
+    bool result = writer.open(fname, 40000);
+    for (util::ulong v = 0; result && v < 10000; ++v)
+    {
+        bv.put_long(v);
+        if (bv.size() >= 700)
+            result = writer.flush(bv);
+    }
+    if (result)
+        result = writer.flush(bv) && bv.size() == 0 && writer.close();
+
+    if (result)
+    {
+        util::bytevector check;
+        result = check.read(fname) && check.size() == 40000;
+        for (util::ulong v = 0; result && v < 10000; ++v)
+            result = check.get_long() == v;
+    }
+    (void) std::remove(fname.c_str());
+    return result;
+}
+
+/*
+ *  Encodes a mix of short and long varinums with the batch encoder and
+ *  with put_varinum(), checks that the bytes match, decodes them, and
+ *  checks that malformed data is reported where it starts.
+ */
+
+static bool
+varinum_batch_io ()
+{
+    std::vector<util::ulong> values;
+    for (util::ulong v = 0; v < 300; ++v)
+        values.push_back(v % 7 == 0 ? v * 1000 : v % 100);
+
+    values.push_back(0x0FFFFFFF);
+    values.push_back(0);
+
+    util::bytevector batch;
+    util::bytevector single;
+    batch.put_varinums(values.data(), values.size());
+    for (auto v : values)
+        single.put_varinum(v);
+
+    bool result = batch.byte_list() == single.byte_list();
+    if (result)
+    {
+        std::vector<util::ulong> decoded(values.size());
+        batch.reset();
+        result = batch.get_varinums(decoded.data(), decoded.size()) ==
+            values.size() && decoded == values && batch.remainder() == 0;
+    }
+    if (result)
+    {
+        const util::byte bad [] =
+        {
+            0x01, 0x81, 0x00, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+            0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x09
+        };
+        util::ulong out[16];
+        size_t count = 16;
+        size_t consumed = 0;
+        bool ok = util::decode_varinums(bad, sizeof bad, out, count, consumed);
+        result = ! ok && count == 9 && consumed == 10 && out[1] == 0x80;
+    }
+    return result;
+}
+
+/*
+ *  Indexes the chunks of the MIDI file, which ends with a Seq66
+ *  proprietary track, plus a file built here with several tracks and a
+ *  truncated last chunk.
+ */
+
+static bool
+chunk_index_io ()
+{
+    std::string fname{"tests/data/1Bar.midi"};
+    util::bytevector bv;
+    util::chunkindex index;
+    bool result = bv.read_mapped(fname) && index.scan(bv);
+    if (result)
+    {
+        util::byteview header = index.view("MThd");
+        util::byteview track = index.view("MTrk");
+        result = index.count() == 3 && header.size() == 6 &&
+            header.get_short() == 1 && track.size() == 309 &&
+            track.real_position() == 22 && index.find("MTrk", 1) == 2 &&
+            index.view("MTrk", 1).size() == 0xC4;
+    }
+    if (result)
+    {
+        util::bytevector multi;
+        for (util::ulong t = 0; t < 4; ++t)
+        {
+            multi.put_long(util::chunkindex::make_tag("MTrk"));
+            multi.put_long(t);
+            for (util::ulong b = 0; b < t; ++b)
+                multi.put_byte(util::byte(t));
+        }
+        multi.put_long(util::chunkindex::make_tag("XTRA"));
+        multi.put_long(100);
+        multi.put_short(0xABCD);
+
+        util::chunkindex mindex;
+        result = ! mindex.scan(multi) && mindex.truncated() &&
+            mindex.count() == 5 && mindex.view("MTrk", 0).empty() &&
+            mindex.view("MTrk", 3).get_triple() == 0x030303 &&
+            mindex.view("XTRA").get_short() == 0xABCD &&
+            util::chunkindex::tag_name(mindex.chunks()[4].chunk_tag) == "XTRA";
+    }
+    return result;
+}
+
+/*
+ *  Builds a series of outputs in pooled buffers, checking that buffers are
+ *  reused and that the pool learns how much room to reserve.
+ */
+
+static size_t
+pad_estimate (size_t estimate)
+{
+    return estimate + estimate / 4;
+}
+
+static bool
+pooled_buffer_io ()
+{
+    bool result = true;
+    util::bytepool::drain();
+    for (int n = 0; result && n < 20; ++n)
+    {
+        util::bytevector bv;
+        bv.acquire();
+        if (n > 0)
+            result = bv.capacity() >= util::bytepool::estimate();
+
+        for (util::ulong v = 0; v < 1000; ++v)
+        {
+            bv.put_short(util::ushort(v));
+            bv.put_triple(v);
+            bv.put_long(v);
+        }
+        if (result)
+        {
+            bv.reset();
+            result = bv.size() == 9000 && bv.get_short() == 0 &&
+                bv.get_triple() == 0 && bv.get_long() == 0 &&
+                bv.get_short() == 1 && bv.get_triple() == 1;
+        }
+        bv.recycle();
+    }
+    if (result)
+    {
+        util::bytepool::set_estimator(pad_estimate);
+        util::bytes b = util::bytepool::acquire();
+        result = util::bytepool::estimate() == 9000 && b.capacity() >= 11250;
+        util::bytepool::set_estimator(nullptr);
+    }
+    return result;
+}
+
+/*
+ *  Reads the MIDI header with a transaction, then fails one on purpose
+ *  and checks that the error is kept, with its offset, and that the
+ *  position is not moved.
+ */
+
+static bool
+transaction_io ()
+{
+    std::string fname{"tests/data/1Bar.midi"};
+    util::bytevector bv;
+    bool result = bv.read(fname);
+    if (result)
+    {
+        util::bytetransaction t{bv};
+        if (t.require(14, "MThd header"))
+        {
+            result = t.get_long() == 0x4D546864 && t.get_long() == 6;
+            t.skip(6);
+        }
+        result = result && t.commit() && bv.position() == 14;
+    }
+    if (result)
+    {
+        util::bytetransaction t{bv};
+        if (t.require(8, "MTrk header"))
+            t.skip(4);
+
+        util::ulong len = t.get_long();
+        (void) t.require(len + 1000, "MTrk data");  /* too much, fails  */
+        (void) t.require(1, "later");               /* ignored          */
+        result = ! t.ok() && t.error_offset() == 22 && ! t.commit() &&
+            bv.position() == 14 && bv.fatal_error() &&
+            t.error_message().find("MTrk data") != std::string::npos;
+
+        bv.clear_errors();
+    }
+    return result;
+}
+
+/*
+ *  Writes a file of longs and varinums, then reads it back through a
+ *  stream with blocks of an odd size, so that values straddle the blocks.
+ */
+
+static bool
+stream_io ()
+{
+    std::string fname{"tests/data/stream-in.bin"};
+    const util::ulong count = 5000;
+    util::bytevector bv;
+    for (util::ulong i = 0; i < count; ++i)
+    {
+        bv.put_long(i * 2654435761UL);
+        bv.put_varinum(i);
+    }
+    bool result = bv.write(fname);
+    if (result)
+    {
+        util::bytestream s;
+        result = s.open(fname, 1001, 16);
+        for (util::ulong i = 0; result && i < count; ++i)
+        {
+            util::ulong expected = i * 2654435761UL;
+            util::byteview v = s.peek_view(4);
+            result = s.peek_long() == expected && v.get_long() == expected &&
+                s.get_long() == expected && s.get_varinum() == i;
+        }
+        if (result)
+            result = s.done() && ! s.fatal_error() &&
+                s.position() == bv.size();
+
+        if (result)
+        {
+            (void) s.get_byte();                    /* past the end         */
+            result = s.fatal_error() && ! s.peek_view(20).data();
+        }
+        if (result)
+        {
+            result = s.open(fname, 4096, 16) && s.skip(bv.size() - 5) &&
+                s.get_string(5) == bv.peek_string(bv.size() - 5, 5) &&
+                ! s.skip(1);
+        }
+    }
+    (void) std::remove(fname.c_str());
+    return result;
+}
+
 /*
  *  main() routine. Rather than call cfg::set_client_name(),
  *  cfg::set_app_version(), etc., we use a structure to set the application
@@ -224,6 +599,33 @@ main (int argc, char * argv [])
             success = basic_string_io();
             if (success)
                 success = big_endian_file_io();
+
+            if (success)
+                success = word_access_io();
+
+            if (success)
+                success = mapped_file_io();
+
+            if (success)
+                success = byteview_io();
+
+            if (success)
+                success = streaming_write_io();
+
+            if (success)
+                success = varinum_batch_io();
+
+            if (success)
+                success = chunk_index_io();
+
+            if (success)
+                success = pooled_buffer_io();
+
+            if (success)
+                success = transaction_io();
+
+            if (success)
+                success = stream_io();
         }
         if (success)
             std::cout << "util::bytevector C++ test succeeded" << std::endl;
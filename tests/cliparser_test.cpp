@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-08-05
+ * \updates       2026-10-18
  * \license       See above.
  *
  */
@@ -33,6 +33,8 @@
 #include <iostream>                     /* std::cout                        */
 
 #include "cfg/appinfo.hpp"              /* cfg::appinfo                     */
+#include "cfg/inimanager.hpp"           /* cfg::inimanager class            */
+#include "cli/multiparser.hpp"          /* cli::multiparser class           */
 #include "cli/parser.hpp"               /* cli::parser, etc.                */
 #include "util/filefunctions.hpp"       /* util::file_write_string()        */
 #include "test_spec.hpp"                /* s_test_options container         */
@@ -57,6 +59,240 @@ static const std::string s_desc_intro
     "summary of the purpose of an application.\n"
 };
 
+/**
+ *  Parses the same command line with and without the fast-lookup mode
+ *  and makes sure the results are identical.
+ */
+
+static bool
+fast_lookup_test ()
+{
+    char arg0[] = "cliparser_test";
+    char arg1[] = "-ae";
+    char arg2[] = "--username";
+    char arg3[] = "Fast Eddie";
+    char arg4[] = "--loop-count=12";
+    char arg5[] = "--no-canned-code";
+    char arg6[] = "-f";
+    char arg7[] = "--flux:2.5";
+    char * argv[] = { arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7 };
+    int argc = int(sizeof argv / sizeof argv[0]);
+    cli::parser slow{s_test_options};
+    cli::parser fast{s_test_options};
+    fast.fast_lookup(true);
+    bool result = slow.parse(argc, argv) && fast.parse(argc, argv);
+    if (result)
+    {
+        std::string slowtext = slow.debug_text(cfg::options::stock);
+        std::string fasttext = fast.debug_text(cfg::options::stock);
+        result = slowtext == fasttext;
+        if (result)
+        {
+            result = fast.value("username") == "Fast Eddie" &&
+                fast.value("loop-count") == "12" &&
+                fast.value("alertable") == "true" &&
+                fast.value("ethernet") == "true" &&
+                fast.value("canned-code") == "false" &&
+                fast.value("fast-code") == "true" &&
+                ! fast.has_error();
+        }
+    }
+    if (result)
+    {
+        char bad1[] = "--no-such-option";
+        char * badv[] = { arg0, bad1 };
+        result = ! fast.parse(2, badv) && fast.has_error();
+    }
+    if (result)
+    {
+        char bad2[] = "-aZ";                    /* no option has code 'Z'   */
+        char * badv[] = { arg0, bad2 };
+        cli::parser clustered{s_test_options};
+        clustered.fast_lookup(true);
+        result = ! clustered.parse(2, badv) && clustered.has_error() &&
+            clustered.error_msg().find('Z') != std::string::npos;
+    }
+    if (result)
+    {
+        /*
+         * Replace one option with another, keeping the count the same. The
+         * lookup tables built by the first parse must not be reused.
+         */
+
+        cli::parser swapped{s_test_options};
+        swapped.fast_lookup(true);
+        result = swapped.parse(argc, argv);
+        if (result)
+        {
+            cfg::options::option zoom
+            {
+                "zoom", swapped.option_set().option_pairs().at("flux")
+            };
+            std::size_t count = swapped.option_set().size();
+            (void) swapped.option_set().option_pairs().erase("flux");
+            result = swapped.add(zoom) &&
+                swapped.option_set().size() == count;
+        }
+        if (result)
+        {
+            char zoom1[] = "--zoom";
+            char zoom2[] = "1.5";
+            char * zoomv[] = { arg0, zoom1, zoom2 };
+            result = swapped.parse(3, zoomv) &&
+                swapped.value("zoom") == "1.5";
+        }
+    }
+    if (result)
+        std::cout << "Fast-lookup parse matches normal parse." << std::endl;
+    else
+        std::cout << "Fast-lookup parse failed." << std::endl;
+
+    return result;
+}
+
+/**
+ *  Reads options from tests/data/cliparser.args, which ends with a bad
+ *  option, in both parsing modes. Run from the top of the project. Also
+ *  makes sure that a value starting with "@" is not taken to be an args
+ *  file.
+ */
+
+static bool
+args_file_test ()
+{
+    bool result = true;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        char arg0[] = "cliparser_test";
+        char arg1[] = "@tests/data/cliparser.args";
+        char * argv[] = { arg0, arg1 };
+        cli::parser clip{s_test_options};
+        clip.fast_lookup(mode == 1);
+        result = ! clip.parse(2, argv);         /* the last line is bad     */
+        if (result)
+        {
+            std::string::size_type pos =
+                clip.error_msg().find("cliparser.args:8:");
+
+            result = pos != std::string::npos &&
+                clip.value("username") == "Args File" &&
+                clip.value("loop-count") == "42" &&
+                clip.value("ethernet") == "true" &&
+                clip.value("flux") == "3.5";
+        }
+        if (result)
+        {
+            char arg2[] = "--username";
+            char arg3[] = "@bob";
+            char * valuev[] = { arg0, arg2, arg3 };
+            cli::parser valuep{s_test_options};
+            valuep.fast_lookup(mode == 1);
+            result = valuep.parse(3, valuev) &&
+                valuep.value("username") == "@bob";
+        }
+        if (! result)
+        {
+            std::cout << "Args-file error: " << clip.error_msg() << std::endl;
+            break;
+        }
+    }
+    if (result)
+        std::cout << "Args-file parse succeeded." << std::endl;
+    else
+        std::cout << "Args-file parse failed." << std::endl;
+
+    return result;
+}
+
+/**
+ *  A section for routed_lookup_test(), added to the inimanager only after
+ *  its option has been mapped for the command line.
+ */
+
+static cfg::inisection::specification s_zoom_section
+{
+    "[zoom]",
+    {
+"Provides one option, to test the routes of cli::multiparser.\n"
+    },
+    {
+        {
+            "zoom-level",
+            {
+                'z', cfg::options::kind::integer, cfg::options::enabled,
+                "1", "1-1-16", false, false,
+                "Sets the zoom level.", false
+            }
+        }
+    }
+};
+
+static cfg::inisections::specification s_zoom_data
+{
+    "zoom",
+    "tests/data",
+    "tests/data",
+    "A 'zoom' file has only the zoom level.",
+    {
+        std::ref(s_zoom_section)
+    }
+};
+
+/**
+ *  Parses options in the stock section and in a section that is not active
+ *  yet, through the routes of cli::multiparser. An option of an inactive
+ *  section is skipped, with its value, and becomes reachable once the
+ *  section is added.
+ */
+
+static bool
+routed_lookup_test ()
+{
+    char arg0[] = "cliparser_test";
+    char arg1[] = "--zoom-level";
+    char arg2[] = "4";
+    char arg3[] = "-a";
+    char arg4[] = "--loop-count=13";
+    char * argv[] = { arg0, arg1, arg2, arg3, arg4 };
+    int argc = int(sizeof argv / sizeof argv[0]);
+    cfg::inimanager mgr{s_test_options};
+    cli::multiparser & clip = mgr.multi_parser();
+    bool result = clip.cli_mappings_add
+    (
+        s_zoom_section.sec_optionlist, "zoom", "[zoom]"
+    );
+    if (result)
+    {
+        result = clip.parse(argc, argv) && ! clip.has_error() &&
+            mgr.boolean_value("alertable") &&
+            mgr.integer_value("loop-count") == 13;
+    }
+    if (result)
+        result = mgr.add_inisections(s_zoom_data);
+
+    if (result)
+    {
+        char * zoomv[] = { arg0, arg1, arg2 };
+        result = clip.parse(3, zoomv) &&
+            mgr.integer_value("zoom-level", "zoom", "[zoom]") == 4;
+
+        if (result)
+        {
+            char arg5[] = "-z";
+            char arg6[] = "6";
+            char * codev[] = { arg0, arg5, arg6 };
+            result = clip.parse(3, codev) &&
+                mgr.integer_value("zoom-level", "zoom", "[zoom]") == 6;
+        }
+    }
+    if (result)
+        std::cout << "Routed lookup succeeded." << std::endl;
+    else
+        std::cout << "Routed lookup failed: " << clip.error_msg() << std::endl;
+
+    return result;
+}
+
 /*
  * main() routine
  */
@@ -218,6 +454,14 @@ main (int argc, char * argv [])
                     std::string dbgtxt = clip.debug_text(cfg::options::stock);
                     std::cout << dbgtxt << std::endl;
                 }
+                if (success)
+                    success = fast_lookup_test();
+
+                if (success)
+                    success = args_file_test();
+
+                if (success)
+                    success = routed_lookup_test();
             }
         }
         if (success)
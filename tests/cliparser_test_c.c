@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2022-06-21
- * \updates       2024-07-15
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  To do: add a help-line for each option.
@@ -77,6 +77,78 @@ static const char * s_help_intro =
 "parser of the cfg66 library.  The options available are as follows:\n\n"
     ;
 
+/**
+ *  Exercises the handle-based functions. Two parsers are created from the
+ *  same option specifications, and each gets its own command line. Neither
+ *  parser should see the values of the other.
+ */
+
+static bool
+handle_test (void)
+{
+    static char * s_argv_1 [] =
+    {
+        "cliparser_test_c", "--alertable", "--username", "Handle One"
+    };
+    static char * s_argv_2 [] =
+    {
+        "cliparser_test_c", "--no-canned-code", "--loop-count", "12"
+    };
+    bool result = false;
+    cfg66_parser * p1 = cfg66_parser_create
+    (
+        &s_test_options[0], (int) s_test_options_count
+    );
+    cfg66_parser * p2 = cfg66_parser_create
+    (
+        &s_test_options[0], (int) s_test_options_count
+    );
+    if (not_nullptr_2(p1, p2))
+    {
+        result = cfg66_parser_parse(p1, 4, s_argv_1);
+        if (result)
+            result = cfg66_parser_parse(p2, 4, s_argv_2);
+
+        if (result)
+        {
+            const char * v = nullptr;
+            size_t len = 0;
+            result = cfg66_parser_value(p1, "username", &v, &len);
+            if (result)
+                result = len == 10 && strncmp(v, "Handle One", len) == 0;
+
+            if (result)
+                result = cfg66_parser_value(p2, "username", &v, &len);
+
+            if (result)
+                result = len == 0;
+
+            if (result)
+                result = cfg66_parser_value(p2, "loop-count", &v, &len);
+
+            if (result)
+                result = len == 2 && strncmp(v, "12", len) == 0;
+
+            if (result)
+                result = cfg66_parser_value(p1, "c", &v, nullptr);
+
+            if (result)
+                result = strcmp(v, "true") == 0;
+
+            if (result)
+                result = ! cfg66_parser_value(p1, "dummy", &v, &len);
+        }
+        if (! result)
+        {
+            printf("Handle 1: %s\n", cfg66_parser_error_msg(p1));
+            printf("Handle 2: %s\n", cfg66_parser_error_msg(p2));
+        }
+    }
+    cfg66_parser_destroy(p1);
+    cfg66_parser_destroy(p2);
+    return result;
+}
+
 /*
  * main() routine
  */
@@ -145,6 +217,8 @@ main (int argc, char * argv [])
                     if (success)
                         success = strcmp(vb, "28") == 0;
                 }
+                if (success)
+                    success = handle_test();
             }
         }
     }
@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2023-07-28
- * \updates       2025-01-27
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  This program is an extension of sorts for the options_test program. Here
@@ -37,12 +37,18 @@
  *
  */
 
+#include <chrono>                       /* std::chrono::milliseconds        */
 #include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
 #include <iostream>                     /* std::cout                        */
+#include <utility>                      /* std::move()                      */
 
+#include "cfg/deltahistory.hpp"         /* cfg::delta_history class         */
 #include "cfg/history.hpp"              /* cfg::history template class      */
+#include "cfg/journal.hpp"              /* cfg::journal_history template    */
+#include "cfg/snapshot.hpp"             /* cfg::options_snapshot class      */
 #include "cfg/options.hpp"              /* cfg::options class               */
 #include "cli/parser.hpp"               /* cli::parser class                */
+#include "util/filefunctions.hpp"       /* util::file_delete(), etc.        */
 
 /**
  *  Test options.
@@ -96,6 +102,430 @@ static const std::string s_help_intro
     "the cfg66 library.  The options available are as follows:\n\n"
 };
 
+/**
+ *  Follows the same steps as the history<options> test in main(), but
+ *  with a delta_history that stores a checkpoint every second step. Each
+ *  undo and redo is checked against the values expected at that step.
+ */
+
+static bool
+delta_history_test (cfg::options & opts, bool show_history_list)
+{
+    int loops = opts.integer_value("loop-count");
+    cfg::delta_history dh{4, opts, 2};
+    bool success = dh.active() && dh.checkpoint_count() == 1;
+    if (success)
+        success = opts.change_value("alertable", "true");
+
+    if (success)
+    {
+        (void) dh.add(opts);
+        success = opts.change_value("loop-count", "99");
+    }
+    if (success)
+    {
+        (void) dh.add(opts);
+        success = dh.change_count() == 2 && dh.checkpoint_count() == 2;
+    }
+    if (success)
+    {
+        opts = dh.undo();
+        success = opts.integer_value("loop-count") == loops;
+        if (success)
+            success = opts.boolean_value("alertable");
+    }
+    if (success)
+    {
+        opts = dh.redo();
+        success = opts.integer_value("loop-count") == 99;
+    }
+    if (success)
+    {
+        success = opts.change_value("flux", "3.14159");
+        if (success)
+            (void) dh.add(opts);
+    }
+    if (success)
+    {
+        success = opts.change_value("flux", "2.7182818");
+        if (success)
+            success = ! dh.add(opts);           /* the first step popped    */
+    }
+    if (success)
+    {
+        success = dh.size() == 4 && dh.present() == 3;
+        if (success)
+        {
+            const cfg::options & first = dh.get(0);
+            success = first.boolean_value("alertable") &&
+                first.integer_value("loop-count") == loops;
+        }
+    }
+    if (show_history_list)
+        std::cout << options_history(dh) << std::endl;
+
+    while (success && dh.undoable())
+        opts = dh.undo();
+
+    if (success)
+    {
+        success = dh.present() == 0 &&
+            opts.boolean_value("alertable") &&
+            opts.integer_value("loop-count") == loops;
+    }
+    if (success)
+    {
+        success = opts.change_value("loop-count", "42");
+        if (success)
+            (void) dh.add(opts);                /* discards the redo steps  */
+
+        success = dh.size() == 2 && ! dh.redoable();
+    }
+    if (success)
+    {
+        opts = dh.undo();
+        success = opts.integer_value("loop-count") == loops;
+    }
+    if (success)
+    {
+        /*
+         * The steps are now a checkpoint and one change. With an interval
+         * of 2, the next step must be a checkpoint, however many steps were
+         * discarded or popped to get here.
+         */
+
+        opts = dh.redo();
+        success = opts.change_value("loop-count", "43");
+        if (success)
+        {
+            (void) dh.add(opts);
+            success = dh.size() == 3 && dh.checkpoint_count() == 2 &&
+                dh.delta(2).checkpoint();
+        }
+    }
+    if (success)
+    {
+        success = dh.reset() && ! dh.active() &&
+            dh.get_present().option_pairs().empty();
+    }
+    if (success)
+        std::cout << "Delta history test succeeded" << std::endl;
+    else
+        std::cerr << "Delta history test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  A state that counts its deep copies, for checking that undo and redo
+ *  in a ring-buffer history copy nothing.
+ */
+
+class counted_state
+{
+public:
+
+    static int sm_copies;
+    std::vector<int> m_data;
+
+    counted_state () : m_data ()
+    {
+        // no other code
+    }
+
+    counted_state (size_t count, int value) : m_data (count, value)
+    {
+        // no other code
+    }
+
+    counted_state (const counted_state & rhs) : m_data (rhs.m_data)
+    {
+        ++sm_copies;
+    }
+
+    counted_state (counted_state &&) = default;
+
+    counted_state & operator = (const counted_state & rhs)
+    {
+        m_data = rhs.m_data;
+        ++sm_copies;
+        return *this;
+    }
+
+    counted_state & operator = (counted_state &&) = default;
+};
+
+int counted_state::sm_copies = 0;
+
+/**
+ *  Exercises history<> with the history_ring storage policy, using the
+ *  move and emplace overloads of add().
+ */
+
+static bool
+ring_history_test ()
+{
+    cfg::history<counted_state, cfg::history_ring> hr{3};
+    counted_state first{4, 0};
+    bool success = hr.add(std::move(first));        /* step 0, no copy      */
+    if (success)
+        success = hr.emplace(4, 1);                 /* step 1, built here   */
+
+    if (success)
+        success = hr.emplace(4, 2);                 /* step 2, list is full */
+
+    if (success)
+        success = ! hr.emplace(4, 3);               /* step 3 pops step 0   */
+
+    if (success)
+        success = hr.size() == 3 && hr.present() == 2;
+
+    if (success)
+    {
+        const counted_state & s1 = hr.undo();
+        const counted_state & s0 = hr.undo();
+        success = s1.m_data[0] == 2 && s0.m_data[0] == 1 && ! hr.undoable();
+    }
+    if (success)
+    {
+        const counted_state & s = hr.redo();
+        success = s.m_data[0] == 2 && counted_state::sm_copies == 0;
+    }
+    if (success)
+    {
+        success = hr.emplace(4, 9);                 /* drops the redo step  */
+        if (success)
+        {
+            success = hr.size() == 3 && ! hr.redoable() &&
+                hr.get_present().m_data[0] == 9 &&
+                hr.get(0).m_data[0] == 1;
+        }
+    }
+    if (success)
+        success = counted_state::sm_copies == 0;
+
+    if (success)
+        std::cout << "Ring history test succeeded" << std::endl;
+    else
+        std::cerr << "Ring history test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Checks that keyed adds within the coalescing window, and adds within a
+ *  group, are merged into one memento.
+ */
+
+static bool
+coalesce_history_test ()
+{
+    cfg::history<int> hc{8, 0};
+    hc.coalesce_window(std::chrono::milliseconds(10000));
+    (void) hc.add(1, "gain");
+    (void) hc.add(2, "gain");
+    (void) hc.add(3, "gain");                       /* merged with 1 and 2  */
+    bool success = hc.size() == 2 && hc.get_present() == 3;
+    if (success)
+    {
+        (void) hc.add(4, "pan");
+        (void) hc.add(5, "gain");                   /* "pan" came between   */
+        success = hc.size() == 4;
+    }
+    if (success)
+    {
+        hc.begin_group();
+        (void) hc.add(6);
+        (void) hc.add(7, "pan");
+        (void) hc.add(8);
+        hc.end_group();
+        success = hc.size() == 5 && hc.get_present() == 8;
+    }
+    if (success)
+    {
+        (void) hc.add(9);                           /* no key, no merge     */
+        success = hc.size() == 6;
+    }
+    if (success)
+    {
+        success = hc.undo() == 8;
+        if (success)
+        {
+            (void) hc.add(10, "gain");              /* drops 9, no merge    */
+            (void) hc.add(11, "gain");
+            success = hc.size() == 6 && hc.get_present() == 11 &&
+                hc.get(4) == 8;
+        }
+    }
+    if (success)
+        std::cout << "Coalescing history test succeeded" << std::endl;
+    else
+        std::cerr << "Coalescing history test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Uses options_snapshot as the TYPE of a history. With 40 options there
+ *  are 3 chunks, and each step should copy only the chunk it changes.
+ */
+
+static bool
+snapshot_history_test ()
+{
+    cfg::options opts{false};
+    for (int i = 0; i < 40; ++i)
+    {
+        std::string name = "option-" + std::to_string(100 + i);
+        cfg::options::spec sp{};
+        sp.option_kind = cfg::options::kind::integer;
+        sp.option_default = sp.option_value = std::to_string(i);
+        (void) opts.add(cfg::options::option{name, sp});
+    }
+
+    cfg::options_snapshot s0{opts};
+    cfg::history<cfg::options_snapshot> hs{8, s0};
+    cfg::options_snapshot s1 = s0.set_value("option-105", "55");
+    cfg::options_snapshot s2 = s1.set_value("option-139", "99");
+    (void) hs.add(s1);
+    (void) hs.add(std::move(s2));
+    bool success = s0.chunk_count() == 3 && hs.size() == 3;
+    if (success)
+    {
+        const cfg::options_snapshot & p2 = hs.get_present();
+        const cfg::options_snapshot & p1 = hs.get(1);
+        success =
+            ! p1.shares_chunk(s0, 0) && p1.shares_chunk(s0, 1) &&
+            p1.shares_chunk(s0, 2) && p2.shares_chunk(p1, 0) &&
+            ! p2.shares_chunk(p1, 2) &&
+            p2.value("option-105") == "55" && p2.value("option-139") == "99";
+    }
+    if (success)
+    {
+        success = hs.undo().value("option-139") == "39";
+    }
+    if (success)
+    {
+        const cfg::options_snapshot & p0 = hs.undo();
+        success = p0.same(s0) && p0.value("option-105") == "5" &&
+            s0.set_value("option-105", "5").same(s0);
+    }
+    if (success)
+    {
+        cfg::options o = hs.redo().to_options();
+        success = o.size() == 40 && o.value("option-105") == "55" &&
+            o.value("option-139") == "39";
+    }
+    if (success)
+        std::cout << "Snapshot history test succeeded" << std::endl;
+    else
+        std::cerr << "Snapshot history test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Exercises journal_history<options> with only two states in memory.
+ *  Undoing to the first state pages the older states in from the journal.
+ *  Then the history is "restarted" from the journal, including a torn
+ *  record as left by a crash in the middle of a write, and a state more
+ *  than a window away is paged in by itself.
+ */
+
+static const std::string s_journal_file{"tests/data/history-out.jnl"};
+
+static bool
+journal_history_test (cfg::options & opts)
+{
+    bool success;
+    {
+        cfg::journal_history<cfg::options> jh{2};
+        success = jh.open(s_journal_file, false);
+        if (success)
+        {
+            const char * values [] = { "10", "20", "30", "40" };
+            for (const char * v : values)
+            {
+                success = opts.change_value("loop-count", v);
+                if (success)
+                    success = jh.add(opts);
+
+                if (! success)
+                    break;
+            }
+        }
+        if (success)
+            success = jh.size() == 4 && jh.window_size() == 2;
+
+        if (success)
+        {
+            (void) jh.undo();
+            (void) jh.undo();                   /* pages in state 1         */
+            const cfg::options & o = jh.undo(); /* pages in state 0         */
+            success = jh.present() == 0 && jh.window_size() == 2 &&
+                o.integer_value("loop-count") == 10;
+        }
+        if (success)
+        {
+            const cfg::options & o = jh.get(3);
+            success = o.integer_value("loop-count") == 40 &&
+                o.modified();
+        }
+        if (success)
+        {
+            const cfg::options & o = jh.redo();
+            success = jh.present() == 1 && o.integer_value("loop-count") == 20;
+        }
+    }
+    if (success)
+    {
+        std::FILE * fp = util::file_open(s_journal_file, "ab");
+        success = not_nullptr(fp);
+        if (success)
+        {
+            (void) std::fputs("\x20\x00", fp);     /* a torn record        */
+            (void) std::fclose(fp);
+        }
+    }
+    if (success)
+    {
+        cfg::journal_history<cfg::options> jh{2};
+        success = jh.open(s_journal_file);      /* restore after a "crash"  */
+        if (success)
+        {
+            success = jh.size() == 4 && jh.present() == 3 &&
+                jh.get_present().integer_value("loop-count") == 40;
+        }
+        if (success)
+        {
+            const cfg::options & o = jh.get(0);  /* too far, so just state 0 */
+            success = o.integer_value("loop-count") == 10 &&
+                jh.window_size() == 1;
+        }
+        if (success)
+        {
+            const cfg::options & o = jh.undo();
+            success = o.integer_value("loop-count") == 30 &&
+                o.description("loop-count") ==
+                    opts.description("loop-count");
+        }
+        if (success)
+        {
+            success = jh.add(opts);             /* drops state 3            */
+            if (success)
+                success = jh.size() == 4 && ! jh.redoable();
+        }
+        jh.close();
+    }
+    (void) util::file_delete(s_journal_file);
+    if (success)
+        std::cout << "Journal history test succeeded" << std::endl;
+    else
+        std::cerr << "Journal history test failed" << std::endl;
+
+    return success;
+}
+
 /*
  * main() routine
  */
@@ -258,6 +688,27 @@ main (int argc, char * argv [])
                     else
                         std::cerr << "Value-changes failed!" << std::endl;
 
+                    if (success)
+                    {
+                        cfg::options dopts{s_test_options};
+                        success = delta_history_test(dopts, show_history_list);
+                    }
+
+                    if (success)
+                        success = ring_history_test();
+
+                    if (success)
+                        success = coalesce_history_test();
+
+                    if (success)
+                        success = snapshot_history_test();
+
+                    if (success)
+                    {
+                        cfg::options jopts{s_test_options};
+                        success = journal_history_test(jopts);
+                    }
+
                     // TODO Test range validation.
                 }
             }
@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2023-07-25
- * \updates       2024-07-31
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  Rationale:
@@ -62,13 +62,18 @@
  *          is done in the options_test program.
  */
 
+#include <chrono>                       /* std::chrono::milliseconds        */
 #include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
 #include <iostream>                     /* std::cout                        */
+#include <thread>                       /* std::this_thread::sleep_for()    */
 
 #include "cfg/appinfo.hpp"              /* cfg::appinfo functions           */
 #include "cfg/inifile.hpp"              /* cfg::inifile class, etc.         */
 #include "cfg/inisections.hpp"          /* cfg::inisections class, etc.     */
 #include "cfg/options.hpp"              /* cfg::options class               */
+#include "cfg/palette.hpp"              /* cfg::dense_palette template      */
+#include "cfg/recent.hpp"               /* cfg::recent class                */
+#include "cfg/snapshot.hpp"             /* cfg::inisections_snapshot class  */
 #include "cli/parser.hpp"               /* cli::parser class                */
 
 /*
@@ -385,6 +390,234 @@ static const std::string s_help_intro
     "options.\n\n"
 };
 
+/**
+ *  Checks that the file just written has a fingerprint that matches the file
+ *  on disk, that reading the file back gives sections with the same
+ *  fingerprint, and that changing an option changes the fingerprint of its
+ *  set.
+ */
+
+static bool
+fingerprint_test
+(
+    const cfg::inifile & written,
+    const cfg::inisections & sections
+)
+{
+    bool success = written.file_fingerprint() != 0 && ! written.file_changed();
+    if (success)
+    {
+        cfg::inisections reread(exp_file_data, "fooinout");
+        cfg::inifile f_reread(reread);
+        success = f_reread.parse() &&
+            f_reread.file_fingerprint() == written.file_fingerprint() &&
+            reread.fingerprint() == sections.fingerprint();
+    }
+    if (success)
+    {
+        for (const auto & sec : sections.section_list())
+        {
+            cfg::options opts = sec.option_set();
+            for (const auto & op : opts.option_pairs())
+            {
+                if (opts.option_is_boolean(op.second))
+                {
+                    std::string name = op.first;
+                    std::string value = op.second.option_value;
+                    std::string flipped = value == "true" ? "false" : "true" ;
+                    std::uint64_t before = opts.fingerprint();
+                    (void) opts.set_value(name, flipped);
+                    success = opts.fingerprint() != before;
+                    (void) opts.set_value(name, value);
+                    if (success)
+                        success = opts.fingerprint() == before;
+
+                    break;
+                }
+            }
+        }
+    }
+    if (! success)
+        std::cerr << "inifile fingerprint test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Takes a snapshot of the sections read from "fooin", changes an option
+ *  in the first section that has options, and checks that the original
+ *  snapshot is untouched and that the other sections are shared.
+ */
+
+static bool
+snapshot_test (const cfg::inisections & sections)
+{
+    cfg::inisections_snapshot snap{sections};
+    bool success = snap.size() > 0 &&
+        snap.size() == sections.section_list().size();
+
+    if (success)
+    {
+        size_t changed = snap.size();
+        std::string sname, oname, original;
+        for (size_t i = 0; i < snap.size(); ++i)
+        {
+            const cfg::inisections_snapshot::section & s = snap.sections()[i];
+            const cfg::options & opts = sections.section_list()[i].option_set();
+            if (! opts.option_pairs().empty())
+            {
+                changed = i;
+                sname = s.section_name;
+                oname = opts.option_pairs().begin()->first;
+                original = s.section_options.value(oname);
+                break;
+            }
+        }
+        success = changed < snap.size();
+        if (success)
+        {
+            cfg::inisections_snapshot snap2 =
+                snap.set_value(sname, oname, "snapshot-value");
+
+            success =
+                snap2.value(sname, oname) == "snapshot-value" &&
+                snap.value(sname, oname) == original;
+
+            for (size_t i = 0; success && i < snap.size(); ++i)
+            {
+                bool shared = snap2.sections()[i].section_options.same
+                (
+                    snap.sections()[i].section_options
+                );
+                success = shared == (i != changed);
+            }
+        }
+    }
+    if (! success)
+        std::cerr << "inisections snapshot test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Adds a missing file and an existing one to a recent-files list with
+ *  deferred validation, validates the list in the background, and checks
+ *  that only the missing file is pruned. Run from the top of the project.
+ *  The last validation is left running, for the destructor to join.
+ */
+
+static bool
+recent_test ()
+{
+    static const std::string s_missing{"/no/such/directory/missing.midi"};
+    static const std::string s_present{"tests/data/cliparser.args"};
+    cfg::recent rf;
+    rf.deferred_validation(true);
+
+    bool success = rf.add(s_missing) && rf.add(s_present) &&
+        rf.count() == 2 && rf.validation_pending();
+
+    if (success)
+        success = rf.validate() && ! rf.validation_pending();
+
+    if (success)
+    {
+        while (rf.validating())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        success = rf.prune() == 1 && rf.count() == 1 &&
+            ! rf.contains(s_missing) && rf.contains(s_present);
+    }
+    if (success)
+        success = rf.add(s_missing) && rf.validate();
+
+    if (! success)
+        std::cerr << "recent-files validation test failed" << std::endl;
+
+    return success;
+}
+
+/**
+ *  Fills a dense_palette of plain RGB values, and checks the lookups, the
+ *  fallback to the "none" slot, and the inverse colors.
+ */
+
+static bool
+palette_test ()
+{
+    using cfg::InvertibleColor;
+    using cfg::PaletteColor;
+    cfg::dense_palette<unsigned> pal;
+    bool success = pal.count() == 0 &&
+        pal.get_color(PaletteColor::red) == 0 &&
+        pal.get_color_name(PaletteColor::none) == "None";
+
+    if (success)
+    {
+        success =
+            pal.add(PaletteColor::none, 0x101010, "None") &&
+            pal.add(PaletteColor::red, 0xFF0000, "Red") &&
+            pal.add(PaletteColor::dk_cyan, 0x008080, "Dark Cyan") &&
+            pal.add(InvertibleColor::label, 0x000000, 0xFFFFFF, "Label") &&
+            pal.add(InvertibleColor::grey, 0x808080, "Grey") &&
+            ! pal.add(PaletteColor::max, 0x123456, "Bogus") &&
+            pal.count() == 5;
+    }
+    if (success)
+    {
+        success =
+            pal.get_color(PaletteColor::red) == 0xFF0000 &&
+            pal.get_color(PaletteColor::dk_cyan) == 0x008080 &&
+            pal.get_color(PaletteColor::none) == 0x101010 &&
+            pal.get_color(PaletteColor::max) == 0x101010 &&
+            pal.get_color_name(PaletteColor::red) == "Red" &&
+            pal.get_color_name_ex(PaletteColor::red) == "1 Red" &&
+            pal.get_color_name(PaletteColor::max) == "None";
+    }
+    if (success)
+    {
+        success = ! pal.inverse() &&
+            pal.get_color(InvertibleColor::label) == 0x000000 &&
+            pal.get_inverse_color(InvertibleColor::label) == 0xFFFFFF &&
+            pal.get_inverse_color(InvertibleColor::grey) == 0x808080 &&
+            pal.get_color_name(InvertibleColor::label) == "Label";
+
+        pal.inverse(true);
+        if (success)
+        {
+            success = pal.inverse() &&
+                pal.get_color(InvertibleColor::label) == 0xFFFFFF &&
+                pal.get_normal_color(InvertibleColor::label) == 0x000000 &&
+                pal.get_color(InvertibleColor::max) ==
+                    pal.get_color(InvertibleColor::black);
+        }
+    }
+    if (success)
+    {
+        static const PaletteColor s_indices [] =
+        {
+            PaletteColor::dk_cyan, PaletteColor::none, PaletteColor::red
+        };
+        static const InvertibleColor s_inv_indices [] =
+        {
+            InvertibleColor::grey, InvertibleColor::label
+        };
+        unsigned colors[3];
+        unsigned inv_colors[2];
+        success =
+            pal.get_colors(s_indices, 3, colors) == 3 &&
+            colors[0] == 0x008080 && colors[1] == 0x101010 &&
+            colors[2] == 0xFF0000 &&
+            pal.get_colors(s_inv_indices, 2, inv_colors) == 2 &&
+            inv_colors[0] == 0x808080 && inv_colors[1] == 0xFFFFFF &&
+            pal.get_colors(s_indices, 3, nullptr) == 0;
+    }
+    if (! success)
+        std::cerr << "dense palette test failed" << std::endl;
+
+    return success;
+}
+
 /*
  * main() routine
  */
@@ -509,6 +742,17 @@ main (int argc, char * argv [])
 
                         cfg::inifile f_inout(sections, "fooinout");
                         success = f_inout.write();
+                        if (success)
+                            success = fingerprint_test(f_inout, sections);
+
+                        if (success)
+                            success = snapshot_test(sections);
+
+                        if (success)
+                            success = recent_test();
+
+                        if (success)
+                            success = palette_test();
                     }
                 }
             }
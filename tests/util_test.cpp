@@ -24,7 +24,7 @@
  * \library       cfg66
  * \author        Chris Ahlstrom
  * \date          2025-02-07
- * \updates       2025-02-22
+ * \updates       2026-10-18
  * \license       See above.
  *
  *  We generally test only newly-added functions here; others were
@@ -35,17 +35,423 @@
  *      $ ./build/tests/util_test
  */
 
-#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <cfloat>                       /* DBL_MAX                          */
+#include <climits>                      /* INT_MAX, LONG_MIN, ULONG_MAX     */
+#include <clocale>                      /* std::setlocale()                 */
+#include <cstdlib>                      /* EXIT_SUCCESS, std::malloc()      */
 #include <iostream>                     /* std::cout, set::cerr             */
+#include <new>                          /* std::bad_alloc                   */
+#include <thread>                       /* std::thread                      */
 
+#include "util/bytevector.hpp"          /* util::bytevector class           */
+#include "util/charconv.hpp"            /* util::from_chars(), to_chars()   */
+#include "util/charscan.hpp"            /* util::charset, charscan_method() */
 #include "util/filefunctions.hpp"       /* util::file_read_lines()          */
+#include "util/hash64.hpp"              /* util::hash64, hash_file(), etc.  */
 #include "util/msgfunctions.hpp"        /* util::string_format(), V()       */
+#include "util/named_bools.hpp"         /* util::atomic_named_bools         */
 #include "util/strfunctions.hpp"        /* util::string_format(), V()       */
 
 /*
  * Application information.
  */
 
+/*
+ *  Registers flags in two words of an atomic_named_bools, has two threads
+ *  set and clear different flags, and checks the results by handle, by
+ *  name, by mask, and by snapshot.
+ */
+
+static bool
+atomic_named_bools_test ()
+{
+    using flags = util::atomic_named_bools;
+    flags f;
+    std::vector<flags::handle> handles;
+    for (int i = 0; i < 100; ++i)
+        handles.push_back(f.add("flag-" + std::to_string(i), i % 2 == 0));
+
+    bool result = f.count() == 100 && f.add("flag-7") == handles[7];
+    if (result)
+        result = f.get(handles[98]) && ! f.get("flag-99");
+
+    if (result)
+    {
+        auto worker = [&f, &handles] (int first)
+        {
+            for (int pass = 0; pass < 1000; ++pass)
+            {
+                for (int i = first; i < 100; i += 2)
+                    (void) f.set(handles[i], pass % 2 == 0);
+            }
+        };
+        std::thread t0(worker, 0);              /* even flags end up false  */
+        std::thread t1(worker, 1);              /* odd flags end up false   */
+        t0.join();
+        t1.join();
+
+        flags::bits all = f.snapshot();
+        result = all == flags::bits();
+    }
+    if (result)
+    {
+        flags::bits m = f.mask({handles[3], handles[64], handles[99]});
+        f.set(m);
+        result = f.all(m) && f.get("flag-64") && ! f.get(handles[4]);
+        if (result)
+        {
+            (void) f.set(handles[64], false);
+            result = ! f.all(m) && f.any(m);
+        }
+        if (result)
+        {
+            result = f.snapshot().get(handles[99]) &&
+                f.name(handles[3]) == "flag-3";
+        }
+    }
+    if (! result)
+        std::cerr << "atomic_named_bools test failed" << std::endl;
+
+    return result;
+}
+
+/*
+ *  Counts the heap allocations made by the whole program, so that the
+ *  strview test can check that a section of code makes none.
+ */
+
+static long s_allocations = 0;
+
+void *
+operator new (std::size_t sz)
+{
+    ++s_allocations;
+    void * result = std::malloc(sz > 0 ? sz : 1);
+    if (result == nullptr)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+void
+operator delete (void * p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete (void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/*
+ *  Checks the strview overloads against the std::string functions, then
+ *  parses some config-style lines many times and checks that no heap
+ *  allocations were made.
+ */
+
+static bool
+strview_test ()
+{
+    const std::string lines[] =
+    {
+        "   [midi-control-out]   ",
+        "  name = \"Seq # 66\"   # the name",
+        "  0x1F  -12 42xyz  3/4  2.5 ",
+        "  # only a comment",
+        "  [ 0  1 2 ] "
+    };
+    bool result = true;
+    for (const auto & line : lines)
+    {
+        util::strview v{line};
+        result = util::trim(v) == util::trim(line) &&
+            util::strip_comments(v) == util::strip_comments(line);
+
+        if (! result)
+            break;
+    }
+    util::strviews tokens;
+    if (result)
+    {
+        util::strview v = util::strip_comments(util::strview(lines[2]));
+        result = util::tokenize(tokens, v) == 5 &&
+            util::string_to_int(tokens[0]) == 31 &&
+            util::string_to_long(tokens[1]) == -12 &&
+            util::string_to_int(tokens[2]) == 42 &&
+            util::string_to_double(tokens[3]) == 0.75 &&
+            util::string_to_double(tokens[4]) == 2.5 &&
+            util::string_to_int("abc", 7) == 7;
+    }
+    if (result)
+    {
+        result = util::tokenize_quoted(tokens, lines[1]) == 6 &&
+            tokens[2] == "Seq # 66" && tokens[3] == "#" &&
+            util::strip_quotes(util::strview("'x y'")) == "x y";
+    }
+    if (result)
+    {
+        util::strview v = util::trim(util::strview(lines[4]));
+        result = util::tokenize_stanzas(tokens, v) == 5 &&
+            tokens[0] == "[" && tokens[3] == "2" && tokens[4] == "]";
+    }
+    if (result)
+    {
+        /*
+         * Plain string literals must still resolve to one overload.
+         */
+
+        int v1 = 0, v2 = 0;
+        std::string trimmed = util::trim("  z ");
+        result = trimmed == "z" &&
+            util::trim("xzx", "x") == "z" &&
+            util::strip_comments("a # b") == "a" &&
+            util::strip_quotes("\"q\"") == "q" &&
+            util::is_empty_string("\"\"") &&
+            util::strcompare("x", "x") && ! util::strcompare("x", "y") &&
+            util::strncompare("name", "name = x", 4) &&
+            util::strcasecompare("Abc", "aBC") &&
+            util::string_to_bool("yes") &&
+            util::string_to_int_pair("3 4", v1, v2) && v1 == 3 && v2 == 4 &&
+            util::string_to_double("2.5") == 2.5 &&
+            util::string_to_float("0.5") == 0.5f &&
+            util::string_to_long("-12") == -12 &&
+            util::string_to_unsigned("12") == 12 &&
+            util::string_to_int("42") == 42 &&
+            util::string_not_void("x") && util::string_is_void("") &&
+            util::strings_match("abc", "ab");
+    }
+    if (result)
+    {
+        long before = s_allocations;
+        long sum = 0;
+        for (int pass = 0; pass < 1000; ++pass)
+        {
+            for (const auto & line : lines)
+            {
+                util::strview v = util::strip_comments(util::strview(line));
+                if (util::strncompare(v, "name"))
+                    (void) util::tokenize_quoted(tokens, v);
+                else
+                    (void) util::tokenize(tokens, v);
+
+                for (const auto & t : tokens)
+                    sum += util::string_to_int(t);
+            }
+        }
+        result = s_allocations == before && sum != 0;
+    }
+    if (! result)
+        std::cerr << "strview test failed" << std::endl;
+
+    return result;
+}
+
+/*
+ *  Checks the delimiter scanner against std::string::find_first_of() and
+ *  find_first_not_of(), at every starting position of lines long enough to
+ *  use the vector code, and with a set too large for it.
+ */
+
+static bool
+charset_test ()
+{
+    const std::string sets[] =
+    {
+        util::CFG66_TRIM_CHARS, "=", "[]", "\"'", " =\t",
+        "abcdefghijklmnopqrstuvwxyz"            /* more than simd_max       */
+    };
+    std::string line;
+    for (int i = 0; i < 150; ++i)
+        line += "key = [ 0x1F \"value\" ]\tmore-text; "[i % 33];
+
+    bool result = true;
+    for (const auto & set : sets)
+    {
+        util::strview v{line};
+        for (size_t pos = 0; pos <= line.size() + 1; ++pos)
+        {
+            result = v.find_first_of(set, pos) == line.find_first_of(set, pos)
+                && v.find_first_not_of(set, pos) ==
+                    line.find_first_not_of(set, pos);
+
+            if (! result)
+                break;
+        }
+        if (! result)
+            break;
+    }
+    std::cout << "Delimiter scan: " << util::charscan_method() << std::endl;
+    if (! result)
+        std::cerr << "charset test failed" << std::endl;
+
+    return result;
+}
+
+/*
+ *  Checks the error positions of from_chars(), that to_chars() output reads
+ *  back as the same value, and that neither depends on the locale nor
+ *  allocates. The locale part is skipped if no locale with a decimal comma
+ *  is installed.
+ */
+
+static bool
+charconv_test ()
+{
+    long lv = 0;
+    double dv = 0.0;
+    util::convert_result cr = util::from_chars("12 apples", lv);
+    bool result = cr.ok() && cr.position == 2 && lv == 12;
+    if (result)
+    {
+        cr = util::from_chars("-x", lv);
+        result = cr.error == util::convert_error::invalid && cr.position == 1;
+    }
+    if (result)
+    {
+        cr = util::from_chars("0x1F,", lv, 0);
+        result = cr.ok() && cr.position == 4 && lv == 31;
+    }
+    if (result)
+    {
+        cr = util::from_chars("-99999999999999999999", lv);
+        result = cr.error == util::convert_error::out_of_range &&
+            cr.position == 21 && lv == LONG_MIN;
+    }
+    if (result)
+    {
+        cr = util::from_chars("1e999", dv);
+        result = cr.error == util::convert_error::out_of_range &&
+            cr.position == 5 && dv > DBL_MAX;
+    }
+    if (result)
+    {
+        cr = util::from_chars("2.5e", dv);
+        result = cr.ok() && cr.position == 3 && dv == 2.5;
+    }
+    if (result)
+    {
+        result = util::string_to_int("  3000000000") == INT_MAX &&
+            util::string_to_unsigned_long("-1") == ULONG_MAX &&
+            util::float_to_string(0.1f) == "0.1" &&
+            util::double_to_string(1.0 / 3.0) == "0.3333333333333333" &&
+            util::double_to_string(0.25, 1) == "0.2";
+    }
+
+    const double doubles[] =
+    {
+        0.1, 1.0 / 3.0, -2.5e-300, 4.9406564584124654e-324, DBL_MAX,
+        123456789012345678.0, 0.30000000000000004
+    };
+    const float floats[] = { 0.1f, 1.0f / 3.0f, 3.4e38f, 1e-45f, -96.5f };
+    const char * const locales[] =
+    {
+        "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "C"
+    };
+    for (const char * loc : locales)
+    {
+        if (! result)
+            break;
+
+        if (std::setlocale(LC_NUMERIC, loc) == nullptr)
+            continue;
+
+        long before = s_allocations;
+        char temp[util::number_chars_max];
+        for (double d : doubles)
+        {
+            double back = 0.0;
+            cr = util::to_chars(temp, sizeof temp, d);
+            result = util::from_chars(util::strview(temp, cr.position), back)
+                .ok() && back == d;
+
+            if (! result)
+                break;
+        }
+        for (float f : floats)
+        {
+            float back = 0.0f;
+            cr = util::to_chars(temp, sizeof temp, f);
+            if (result)
+            {
+                result = util::from_chars(util::strview(temp, cr.position),
+                    back).ok() && back == f;
+            }
+        }
+        if (result)
+            result = s_allocations == before;
+
+        if (result)
+        {
+            result = util::double_to_string(0.5) == "0.5" &&
+                util::string_to_double("0.5") == 0.5;
+        }
+        std::cout << "Numbers in locale " << loc << ": "
+            << (result ? "ok" : "failed") << std::endl;
+    }
+    (void) std::setlocale(LC_NUMERIC, "C");
+    if (! result)
+        std::cerr << "charconv test failed" << std::endl;
+
+    return result;
+}
+
+/*
+ *  Checks the hash against published XXH64 digests, that hashing in pieces
+ *  gives the digest of the whole, and that hash_file() and
+ *  bytevector::fingerprint() agree with hash_bytes() on the same data.
+ */
+
+static bool
+hash64_test ()
+{
+    bool result =
+        util::hash_string("") == 0xef46db3751d8e999ULL &&
+        util::hash_string("abc") == 0x44bc2cf5ad770999ULL &&
+        util::hash_to_string(util::hash_string("a")) == "d24ec4f1a98c6e5b";
+
+    if (result)
+    {
+        std::string data;
+        for (int i = 0; i < 1000; ++i)
+            data += char(i * 7 + i / 13);
+
+        for (std::size_t piece = 1; piece <= 40; ++piece)
+        {
+            util::hash64 h(99);
+            for (std::size_t i = 0; i < data.size(); i += piece)
+                h.update(util::strview(data).substr(i, piece));
+
+            result = h.digest() == util::hash_string(data, 99);
+            if (! result)
+                break;
+        }
+    }
+    if (result)
+    {
+        util::hash64 a;
+        util::hash64 b;
+        a.update_field("ab");
+        a.update_field("c");
+        b.update_field("a");
+        b.update_field("bc");
+        result = a.digest() != b.digest();
+    }
+    if (result)
+    {
+        std::string file{"tests/data/lines.txt"};
+        util::bytevector bv;
+        std::uint64_t h = 0;
+        result = bv.read(file) && util::hash_file(file, h) &&
+            h == bv.fingerprint() && h == util::hash_bytes(bv.data(), bv.size());
+    }
+    if (! result)
+        std::cerr << "hash64 test failed" << std::endl;
+
+    return result;
+}
+
 /*
  *  main() routine.
  *
@@ -100,6 +506,21 @@ main (int /*argc*/, char * /*argv*/ [])
                 ;
         }
     }
+    if (success)
+        success = atomic_named_bools_test();
+
+    if (success)
+        success = strview_test();
+
+    if (success)
+        success = charset_test();
+
+    if (success)
+        success = charconv_test();
+
+    if (success)
+        success = hash64_test();
+
     if (success)
     {
         std::cout << "util C++ test succeeded" << std::endl;